@@ -0,0 +1,71 @@
+/*
+	DFTAlignedArray
+
+	A fixed size array of a plain data type whose first element is on a DFT_ALIGNMENT byte boundary, i.e. a cache line,
+	so that SIMD code can use aligned loads and a row never straddles more cache lines than it needs.
+	Allocated arrays are zero filled. Copying copies the elements. Memory comes from DFTPool.
+*/
+#pragma once
+#ifndef DFTAligned_H
+#define DFTAligned_H
+
+#include <cstring>
+#include "DFTPool.h"
+
+namespace DFT{
+	template<class T> class DFTAlignedArray{
+		T *Data;
+		size_t Size;
+
+		static T *Allocate(size_t n){
+			if (!n){
+				return NULL;
+			}
+			void *memory = DFTPool::Get().Allocate(n*sizeof(T));
+			memset(memory, 0, n*sizeof(T));
+			return static_cast<T*>(memory);
+		}
+		static void Free(T *data, size_t n){
+			DFTPool::Get().Release(data, n*sizeof(T));
+		}
+
+	public:
+		DFTAlignedArray(): Data(NULL), Size(0){}
+		explicit DFTAlignedArray(size_t n): Data(Allocate(n)), Size(n){}
+		DFTAlignedArray(const DFTAlignedArray &obj): Data(Allocate(obj.Size)), Size(obj.Size){
+			if (Size){
+				memcpy(Data, obj.Data, Size*sizeof(T));
+			}
+		}
+		DFTAlignedArray &operator=(const DFTAlignedArray &op){
+			if (this != &op){
+				DFTAlignedArray copy(op);
+				Swap(copy);
+			}
+			return *this;
+		}
+		~DFTAlignedArray(){ Free(Data, Size); }
+
+		//Replace the content with n zeros
+		void Assign(size_t n){
+			DFTAlignedArray fresh(n);
+			Swap(fresh);
+		}
+		void Swap(DFTAlignedArray &op){
+			T *data = Data;
+			Data = op.Data;
+			op.Data = data;
+			size_t size = Size;
+			Size = op.Size;
+			op.Size = size;
+		}
+
+		T *Get(){ return Data; }
+		const T *Get() const{ return Data; }
+		T &operator[](size_t i){ return Data[i]; }
+		const T &operator[](size_t i) const{ return Data[i]; }
+		size_t GetSize() const{ return Size; }
+	};
+}
+
+#endif /*DFTAligned_H*/
@@ -0,0 +1,377 @@
+//DFTCQT.cpp
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <algorithm>
+#include "DFTCQT.h"
+#include "DFTPool.h"
+
+using namespace std;
+namespace DFT{
+	namespace{
+		const double MAX_FREQUENCY = 0.45;			//Highest bin as a fraction of the sample rate, below the decimation filter cut off
+		const unsigned int LOWPASS_DELAY = 55;		//Half the length of the decimation filter
+		const unsigned int DEFAULT_HOP = 512;		//Smallest hop picked by default
+		const unsigned int STREAM_BLOCKS = 8192U;	//Blocks read from a wave file at a time
+
+		//Cache key
+		struct CQTKey_T{
+			double SampleRate;
+			unsigned int BinsPerOctave;
+			double Minimum;
+			double Maximum;
+			bool operator<(const CQTKey_T &op) const{
+				if (SampleRate != op.SampleRate) return SampleRate < op.SampleRate;
+				if (BinsPerOctave != op.BinsPerOctave) return BinsPerOctave < op.BinsPerOctave;
+				if (Minimum != op.Minimum) return Minimum < op.Minimum;
+				return Maximum < op.Maximum;
+			}
+		};
+		//Owns every kernel handed out by DFTCQTKernel::Get()
+		struct CQTCache_T{
+			map<CQTKey_T, DFTCQTKernel*> Kernels;
+			mutex Lock;				//Guards the map, for transforms running on several threads
+			~CQTCache_T(){
+				map<CQTKey_T, DFTCQTKernel*>::iterator it;
+				for (it = Kernels.begin(); it != Kernels.end(); it++){
+					delete it->second;
+				}
+			}
+		};
+		CQTCache_T &CQTCache(){
+			static CQTCache_T cache;
+			return cache;
+		}
+		//Construct the cache while there is a single thread
+		CQTCache_T &Constructed = CQTCache();
+	}
+
+	/************** DFTCQTKernel ****************/
+	//Get()
+	const DFTCQTKernel &DFTCQTKernel::Get(double sampleRate, unsigned int binsPerOctave, double minimum, double maximum){
+		CQTKey_T key = {sampleRate, binsPerOctave, minimum, maximum};
+		CQTCache_T &cache = CQTCache();
+		lock_guard<mutex> lock(cache.Lock);
+		map<CQTKey_T, DFTCQTKernel*>::iterator it = cache.Kernels.find(key);
+		if (it != cache.Kernels.end()){
+			return *it->second;
+		}
+		DFTCQTKernel *kernel = new DFTCQTKernel(sampleRate, binsPerOctave, minimum, maximum);
+		cache.Kernels[key] = kernel;
+		return *kernel;
+	}
+
+	//Constructor
+	DFTCQTKernel::DFTCQTKernel(double sampleRate, unsigned int binsPerOctave, double minimum, double maximum, double threshold)
+		: SampleRate(sampleRate), BinsPerOctave(binsPerOctave), MinFrequency(minimum), Bins(0), Octaves(0), Plan(NULL){
+		if (sampleRate <= 0 || !binsPerOctave || minimum <= 0){
+			throw Exception(EXCEPTION_DATA_INVALID, "Sample rate, bins per octave and minimum frequency must be positive!");
+		}
+		if (!maximum){
+			maximum = MAX_FREQUENCY*sampleRate;
+		}
+		if (maximum < minimum || maximum > MAX_FREQUENCY*sampleRate){
+			throw Exception(EXCEPTION_DATA_INVALID, "Maximum frequency must be between the minimum and 0.45 times the sample rate!");
+		}
+		unsigned int B = binsPerOctave;
+		Bins = unsigned(floor(B*log(maximum/minimum)/log(2.0) + 1e-9)) + 1;
+		Octaves = (Bins + B - 1)/B;
+
+		//Top octave. Its lowest bin has the longest window.
+		double Q = 1/(pow(2.0, 1.0/B) - 1);
+		vector<double> frequency(B);
+		for (unsigned int j = 0; j < B; j++){
+			frequency[j] = minimum*pow(2.0, (double(Bins) - B + j)/B);
+		}
+		unsigned int longest = unsigned(ceil(Q*sampleRate/frequency[0]));
+		unsigned int n = 2;
+		while (n < longest){
+			n <<= 1;
+		}
+		Plan = &DFTPlan::Get(n);
+
+		Start.resize(B);
+		Offset.resize(B + 1);
+		Offset[0] = 0;
+		vector<complex<double> > atom(n);
+		vector<double> window;
+		for (unsigned int j = 0; j < B; j++){
+			//Windowed exponential centred in the frame, with zero phase at the centre
+			unsigned int length = max(1U, unsigned(ceil(Q*sampleRate/frequency[j])));
+			MakeWindow(WindowHann, length, window, false);
+			double sum = 0;
+			for (unsigned int i = 0; i < length; i++){
+				sum += window[i];
+			}
+			fill(atom.begin(), atom.end(), complex<double>(0, 0));
+			unsigned int offset = n/2 - length/2;
+			for (unsigned int i = 0; i < length; i++){
+				double phase = 2*PI*frequency[j]*(double(offset + i) - n/2)/sampleRate;
+				atom[offset + i] = polar(2*window[i]/sum, phase);
+			}
+			Plan->Forward(&atom[0]);
+
+			//Row of the kernel: conj(A[m])/n over the non negative frequencies, kept from the first to the last above threshold
+			unsigned int half = n/2;
+			double peak = 0;
+			for (unsigned int m = 0; m <= half; m++){
+				peak = max(peak, abs(atom[m]));
+			}
+			unsigned int first = 0, last = half;
+			while (first < half && abs(atom[first]) < threshold*peak){
+				first++;
+			}
+			while (last > first && abs(atom[last]) < threshold*peak){
+				last--;
+			}
+			Start[j] = first;
+			for (unsigned int m = first; m <= last; m++){
+				Weights.push_back(conj(atom[m])/double(n));
+			}
+			Offset[j+1] = unsigned(Weights.size());
+		}
+
+		//Half band low pass: Blackman windowed sinc with its cut off at a quarter of the sample rate
+		unsigned int taps = 2*LOWPASS_DELAY + 1;
+		MakeWindow(WindowBlackman, taps, window, false);
+		Lowpass.resize(taps);
+		double sum = 0;
+		for (unsigned int i = 0; i < taps; i++){
+			double x = 0.5*(double(i) - LOWPASS_DELAY);
+			Lowpass[i] = window[i]*(x ? sin(PI*x)/(PI*x) : 1.0);
+			sum += Lowpass[i];
+		}
+		for (unsigned int i = 0; i < taps; i++){
+			Lowpass[i] /= sum;
+		}
+	}
+
+	//Apply()
+	void DFTCQTKernel::Apply(const complex<double> *spectrum, complex<double> *out) const{
+		for (unsigned int j = 0; j < BinsPerOctave; j++){
+			const complex<double> *x = spectrum + Start[j], *w = &Weights[0] + Offset[j];
+			unsigned int length = Offset[j+1] - Offset[j];
+			double re = 0, im = 0;
+			for (unsigned int i = 0; i < length; i++){
+				re += x[i].real()*w[i].real() - x[i].imag()*w[i].imag();
+				im += x[i].real()*w[i].imag() + x[i].imag()*w[i].real();
+			}
+			out[j] = complex<double>(re, im);
+		}
+	}
+
+	//GetFrequency()
+	double DFTCQTKernel::GetFrequency(unsigned int bin) const{
+		return MinFrequency*pow(2.0, double(bin)/BinsPerOctave);
+	}
+
+	/************** DFTCQT ****************/
+	//Constructor
+	DFTCQT::DFTCQT(double sampleRate, unsigned int binsPerOctave, double minimum, double maximum, unsigned int hop)
+		: Kernel(NULL), Hop(hop), Channels(0), Received(0), Frames(0), Flushed(false){
+		Kernel = &DFTCQTKernel::Get(sampleRate, binsPerOctave, minimum, maximum);
+		unsigned int unit = 1U << (Kernel->NumOctaves() - 1);
+		if (!Hop){
+			Hop = (DEFAULT_HOP + unit - 1)/unit*unit;
+		}
+		if (Hop % unit){
+			throw Exception(EXCEPTION_DATA_INVALID, "Hop must be a multiple of 2^(octaves-1)!");
+		}
+		Frame.resize(Kernel->GetFFTSize());
+		Spectrum.resize(Kernel->GetPlan().GetRealSize());
+		Row.resize(binsPerOctave);
+	}
+
+	//Reset()
+	void DFTCQT::Reset(unsigned int channels){
+		if (!channels){
+			throw Exception(EXCEPTION_DATA_INVALID, "Channels cannot be zero!");
+		}
+		Channels = channels;
+		Signal.assign(channels, vector<Octave_T>(Kernel->NumOctaves()));
+		Received = 0;
+		Frames = 0;
+		Flushed = false;
+	}
+
+	//Decimate()
+	void DFTCQT::Decimate(Octave_T &in, Octave_T &out){
+		const vector<double> &h = Kernel->GetLowpass();
+		long long delay = LOWPASS_DELAY;
+		long long end = in.Base + (long long) in.Samples.size();
+		while (2*in.Next + delay < end){
+			long long centre = 2*in.Next;
+			double sum = 0;
+			for (long long i = max(-delay, -centre); i <= delay; i++){
+				sum += h[unsigned(i + delay)]*in.Samples[unsigned(centre + i - in.Base)];
+			}
+			out.Samples.push_back(sum);
+			in.Next++;
+		}
+	}
+
+	//IsReady()
+	bool DFTCQT::IsReady(unsigned long long frame) const{
+		long long half = Kernel->GetFFTSize()/2;
+		for (unsigned int o = 0; o < Kernel->NumOctaves(); o++){
+			const Octave_T &octave = Signal[0][o];
+			long long centre = (long long) frame*(Hop >> o);
+			if (octave.Base + (long long) octave.Samples.size() < centre + half){
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//Compute()
+	void DFTCQT::Compute(unsigned int channel, unsigned long long frame, complex<double> *out){
+		unsigned int n = Kernel->GetFFTSize(), B = Kernel->GetBinsPerOctave(), bins = Kernel->NumBins();
+		for (unsigned int o = 0; o < Kernel->NumOctaves(); o++){
+			const Octave_T &octave = Signal[channel][o];
+			long long begin = (long long) frame*(Hop >> o) - n/2;
+			for (unsigned int i = 0; i < n; i++){
+				long long index = begin + i;
+				Frame[i] = (index < 0) ? 0 : octave.Samples[unsigned(index - octave.Base)];
+			}
+			Kernel->GetPlan().ForwardReal(&Frame[0], &Spectrum[0]);
+			Kernel->Apply(&Spectrum[0], &Row[0]);
+			//Bins of the octave. The lowest octave may be incomplete.
+			for (unsigned int j = 0; j < B; j++){
+				long long k = (long long) bins - B + j - (long long) o*B;
+				if (k >= 0){
+					out[k] = Row[j];
+				}
+			}
+		}
+	}
+
+	//Trim()
+	void DFTCQT::Trim(){
+		long long half = Kernel->GetFFTSize()/2, delay = LOWPASS_DELAY;
+		unsigned int octaves = Kernel->NumOctaves();
+		for (unsigned int c = 0; c < Channels; c++){
+			for (unsigned int o = 0; o < octaves; o++){
+				Octave_T &octave = Signal[c][o];
+				//Start of the next frame, and of the next decimation
+				long long keep = (long long) Frames*(Hop >> o) - half;
+				if (o + 1 < octaves){
+					keep = min(keep, 2*octave.Next - delay);
+				}
+				if (keep > octave.Base){
+					unsigned int drop = unsigned(min(keep - octave.Base, (long long) octave.Samples.size()));
+					octave.Samples.erase(octave.Samples.begin(), octave.Samples.begin() + drop);
+					octave.Base += drop;
+				}
+			}
+		}
+	}
+
+	//Append()
+	void DFTCQT::Append(const double *data, unsigned int blocks, vector<complex<double> > &out){
+		unsigned int octaves = Kernel->NumOctaves(), bins = Kernel->NumBins();
+		for (unsigned int c = 0; c < Channels; c++){
+			vector<double> &top = Signal[c][0].Samples;
+			size_t filled = top.size();
+			top.resize(filled + blocks);
+			for (unsigned int i = 0; i < blocks; i++){
+				top[filled + i] = data[i*Channels + c];
+			}
+			for (unsigned int o = 0; o + 1 < octaves; o++){
+				Decimate(Signal[c][o], Signal[c][o+1]);
+			}
+		}
+		while (IsReady(Frames)){
+			size_t base = out.size();
+			out.resize(base + Channels*bins);
+			for (unsigned int c = 0; c < Channels; c++){
+				Compute(c, Frames, &out[base + c*bins]);
+			}
+			Frames++;
+		}
+		Trim();
+	}
+
+	//Push()
+	unsigned int DFTCQT::Push(const double *data, unsigned int blocks, vector<complex<double> > &out){
+		if (!Channels){
+			throw Exception(EXCEPTION_INITIALISATION, "Transform has not been reset for a signal.");
+		}
+		if (Flushed){
+			throw Exception(EXCEPTION_INITIALISATION, "Signal has ended; reset the transform for another.");
+		}
+		out.clear();
+		Received += blocks;
+		Append(data, blocks, out);
+		return unsigned(out.size()/(Channels*NumBins()));
+	}
+
+	//Flush()
+	unsigned int DFTCQT::Flush(vector<complex<double> > &out){
+		out.clear();
+		if (!Channels || Flushed){
+			return 0;
+		}
+		Flushed = true;
+		//Frames centred on the samples received. The zeros padded are not received samples.
+		unsigned long long total = Received ? (Received - 1)/Hop + 1 : 0;
+		vector<double> zeros(Hop*Channels, 0.0);
+		while (Frames < total){
+			Append(&zeros[0], Hop, out);
+		}
+		unsigned int frameSize = Channels*NumBins();
+		unsigned long long produced = out.size()/frameSize;
+		if (Frames > total){
+			out.resize(size_t(produced - (Frames - total))*frameSize);
+			Frames = total;
+		}
+		return unsigned(out.size()/frameSize);
+	}
+
+	//Transform()
+	void DFTCQT::Transform(Wave::WaveFile &wave, DFTData &out){
+		unsigned int channels = wave.NumChannels(), blocks = wave.NumBlocks(), bins = NumBins();
+		if (wave.SampleRate() != Kernel->GetSampleRate()){
+			throw Exception(EXCEPTION_DATA_INVALID, "Sample rate of the file does not match the transform.");
+		}
+		//Not even a frame, which the output could not hold as no dimensions
+		if (!blocks){
+			throw Exception(EXCEPTION_DATA_INVALID, "Wave file has no samples to transform.");
+		}
+		Reset(channels);
+		unsigned int frames = (blocks - 1)/Hop + 1;
+		//We might have to change the dimensions and intervaln of the output - be sure to catch exceptions
+		if (frames*channels != out.DFTDimension()){
+			out.DFTSetDimension(frames*channels);
+		}
+		if (bins != out.DFTNumInterval()){
+			out.DFTSetNumInterval(bins);
+		}
+		out.DFTSetInterval(1.0/Kernel->GetBinsPerOctave());
+
+		//Full scale to [-1, 1]
+		double scale = ldexp(1.0, 1 - int(wave.SampleSize()));
+		vector<double, DFTPoolAllocator<double> > chunk(STREAM_BLOCKS*channels);
+		vector<complex<double> > coefficients;
+		unsigned int read, done = 0;
+		bool end = false;
+		wave.DataRewind();
+		while (!end){
+			unsigned int n;
+			if ((read = wave.DataNextBlocks(&chunk[0], STREAM_BLOCKS)) != 0){
+				for (unsigned int i = 0; i < read*channels; i++){
+					chunk[i] *= scale;
+				}
+				n = Push(&chunk[0], read, coefficients);
+			}
+			else{
+				n = Flush(coefficients);
+				end = true;
+			}
+			for (unsigned int f = 0; f < n; f++, done++){
+				for (unsigned int c = 0; c < channels; c++){
+					out.DFTSetRange(done*channels + c, 0, bins, &coefficients[(f*channels + c)*bins]);
+				}
+			}
+		}
+	}
+}
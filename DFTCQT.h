@@ -0,0 +1,142 @@
+/*
+	Constant-Q Transform
+
+	cf Brown & Puckette, "An efficient algorithm for the calculation of a constant Q transform", JASA 92(5), 1992;
+	   Schorkhuber & Klapuri, "Constant-Q transform toolbox for music processing", SMC 2010
+
+	Bins are spaced BinsPerOctave to the octave from MinFrequency: f[k] = MinFrequency*2^(k/BinsPerOctave), up to
+	MaxFrequency. Every bin has the same quality factor Q = 1/(2^(1/BinsPerOctave) - 1), i.e. a Hann window of
+	Q*SampleRate/f[k] samples, so low bins get long windows and high bins short ones.
+
+	DFTCQTKernel
+	The spectral kernel of the top octave. The coefficient of a bin is the inner product of the frame with a windowed
+	complex exponential, or by Parseval the inner product of their spectra. The spectrum of the exponential is
+	concentrated around its frequency, so each row of the kernel is stored as the first bin above a threshold and the
+	weights up to the last one, and a frame costs one real FFT and a sparse product.
+	Only one octave needs a kernel: the signal of every lower octave is low pass filtered and decimated by two from the
+	octave above, after which its bins have the same frequencies relative to the sample rate as the top octave.
+	The transform length is the next power of two above the longest window of the top octave, and the same for all
+	octaves. Kernels are cached by sample rate, bins per octave and range. Use DFTCQTKernel::Get().
+
+	DFTCQT
+	Streams blocks of interleaved samples through the octaves. Frame t is centred on sample t*Hop, so the hop must be a
+	multiple of 2^(octaves-1) for every octave to be sampled at the same times; samples before the start are zeros.
+	Frames come out once the lowest octave has the samples it needs, i.e. with some latency; Flush() pads the end of
+	the signal with zeros to produce the frames centred on its last samples.
+	Coefficients are scaled so that a full scale sinusoid at the frequency of a bin has a magnitude of one.
+
+	Transform() runs a WaveFile through it and stores the result like a DFTFrequency object: bins as intervals and
+	frame*channels + channel as dimensions. As bins are not evenly spaced in Hz, DFTInterval() is set to the spacing in
+	octaves, 1/BinsPerOctave. Use GetFrequency() for the frequency of an interval.
+*/
+#pragma once
+#ifndef DFTCQT_H
+#define DFTCQT_H
+
+#include <vector>
+#include <complex>
+#include "DFTData.h"
+#include "DFTPlan.h"
+#include "DFTUtility.h"
+#include "WaveFile.h"
+
+namespace DFT{
+	/************** DFTCQTKernel ****************/
+	class DFTCQTKernel{
+		double SampleRate;							//Sample rate of the top octave
+		unsigned int BinsPerOctave;					//Bins per octave
+		double MinFrequency;						//Frequency of the first bin
+		unsigned int Bins;							//Number of bins over all octaves
+		unsigned int Octaves;						//Number of octaves, the lowest possibly incomplete
+		const DFTPlan *Plan;						//Transform of a frame
+		std::vector<unsigned int> Start;			//First FFT bin of each row of the kernel
+		std::vector<unsigned int> Offset;			//Offset of the weights of each row, BinsPerOctave+1 entries
+		std::vector<std::complex<double> > Weights;	//Conjugate spectra of the windowed exponentials, one row after the other
+		std::vector<double> Lowpass;				//Half band filter used to go down an octave, odd length
+
+		DFTCQTKernel(const DFTCQTKernel &);
+		DFTCQTKernel &operator=(const DFTCQTKernel &);
+
+	public:
+		//maximum defaults to 0.45*sampleRate, which is also the most the decimation filter allows.
+		//Rows are kept down to threshold times their peak.
+		DFTCQTKernel(double sampleRate, unsigned int binsPerOctave, double minimum, double maximum=0, double threshold=0.001);
+
+		//Coefficients of the BinsPerOctave bins of an octave from the half spectrum of a frame (GetFFTSize()/2+1 bins),
+		//lowest bin first
+		void Apply(const std::complex<double> *spectrum, std::complex<double> *out) const;
+
+		//Getters
+		double GetSampleRate() const{ return SampleRate; }
+		unsigned int GetBinsPerOctave() const{ return BinsPerOctave; }
+		unsigned int NumBins() const{ return Bins; }
+		unsigned int NumOctaves() const{ return Octaves; }
+		unsigned int GetFFTSize() const{ return Plan->GetSize(); }
+		const DFTPlan &GetPlan() const{ return *Plan; }
+		const std::vector<double> &GetLowpass() const{ return Lowpass; }
+		double GetFrequency(unsigned int bin) const;		//Frequency of a bin in Hz
+		unsigned int NumWeights() const{ return unsigned(Weights.size()); }		//Non zero entries of the kernel
+
+		//Get a cached kernel. Thread safe.
+		static const DFTCQTKernel &Get(double sampleRate, unsigned int binsPerOctave, double minimum, double maximum=0);
+	};
+
+	/************** DFTCQT ****************/
+	class DFTCQT{
+		//Signal of an octave of a channel
+		struct Octave_T{
+			std::vector<double> Samples;		//Samples from Base on at the rate of the octave
+			long long Base;						//Index of Samples[0]
+			long long Next;						//Next sample of the octave below to be produced
+			Octave_T(): Base(0), Next(0){}
+		};
+
+		const DFTCQTKernel *Kernel;				//Cached kernel
+		unsigned int Hop;						//Samples between frames at the top octave
+		unsigned int Channels;					//Number of channels
+		std::vector<std::vector<Octave_T> > Signal;	//Per channel, per octave
+		unsigned long long Received;			//Samples per channel pushed
+		unsigned long long Frames;				//Frames produced
+		bool Flushed;							//Whether Flush() has ended the signal
+
+		//Scratch space
+		std::vector<double> Frame;
+		std::vector<std::complex<double> > Spectrum;
+		std::vector<std::complex<double> > Row;
+
+	protected:
+		void Decimate(Octave_T &in, Octave_T &out);		//Produce what samples of the octave below the samples of an octave allow
+		bool IsReady(unsigned long long frame) const;	//Whether every octave has the samples of a frame
+		void Compute(unsigned int channel, unsigned long long frame, std::complex<double> *out);	//All bins of a frame
+		void Trim();									//Drop the samples no longer needed
+		void Append(const double *data, unsigned int blocks, std::vector<std::complex<double> > &out);	//Push() without clearing out
+
+	public:
+		//hop is in samples and must be a multiple of 2^(octaves-1). Zero picks the first such multiple from 512 up.
+		DFTCQT(double sampleRate, unsigned int binsPerOctave=12, double minimum=55, double maximum=0, unsigned int hop=0);
+
+		//Get ready for a signal with the number of channels
+		void Reset(unsigned int channels);
+
+		//Add blocks of samples, interleaved by channel. The frames completed replace the content of out: frame after frame,
+		//each Channels*NumBins() coefficients, channel major. Returns the number of frames.
+		unsigned int Push(const double *data, unsigned int blocks, std::vector<std::complex<double> > &out);
+		//End of the signal. The remaining frames, up to the one centred on the last sample, replace the content of out.
+		//Flushing again produces nothing, and Push() throws EXCEPTION_INITIALISATION, until Reset().
+		unsigned int Flush(std::vector<std::complex<double> > &out);
+
+		//Stream the data chunk of the wave file, scaled to [-1, 1], into out, resized where it supports it.
+		//Throws EXCEPTION_DATA_INVALID for a file without samples.
+		void Transform(Wave::WaveFile &wave, DFTData &out);
+
+		//Getters
+		const DFTCQTKernel &GetKernel() const{ return *Kernel; }
+		unsigned int NumBins() const{ return Kernel->NumBins(); }
+		unsigned int GetHop() const{ return Hop; }
+		unsigned long long NumFrames() const{ return Frames; }
+		double GetFrequency(unsigned int bin) const{ return Kernel->GetFrequency(bin); }
+		double GetFrameTime(unsigned long long frame) const{ return frame*double(Hop)/Kernel->GetSampleRate(); }	//Centre of a frame in seconds
+	};
+}
+
+#endif /*DFTCQT_H*/
@@ -0,0 +1,314 @@
+//DFTCosine.cpp
+#include <cmath>
+#include <map>
+#include <mutex>
+#include "DFTCosine.h"
+
+using namespace std;
+namespace DFT{
+	namespace{
+		//Owns every transform handed out by DFTCosine::Get()
+		struct CosineCache_T{
+			map<unsigned long long, DFTCosine*> Transforms;
+			mutex Lock;				//Guards the map, for transforms running on several threads
+			~CosineCache_T(){
+				map<unsigned long long, DFTCosine*>::iterator it;
+				for (it = Transforms.begin(); it != Transforms.end(); it++){
+					delete it->second;
+				}
+			}
+		};
+		CosineCache_T &CosineCache(){
+			static CosineCache_T cache;
+			return cache;
+		}
+		//Construct the cache while there is a single thread
+		CosineCache_T &Constructed = CosineCache();
+
+		inline complex<double> Multiply(const complex<double> &a, const complex<double> &b){
+			return complex<double>(a.real()*b.real() - a.imag()*b.imag(), a.real()*b.imag() + a.imag()*b.real());
+		}
+	}
+
+	/************** DFTCosine ****************/
+	//Get()
+	const DFTCosine &DFTCosine::Get(Type type, unsigned int n, bool orthonormal){
+		unsigned long long key = ((unsigned long long)n << 3) | (unsigned(type) << 1) | (orthonormal ? 1 : 0);
+		CosineCache_T &cache = CosineCache();
+		lock_guard<mutex> lock(cache.Lock);
+		map<unsigned long long, DFTCosine*>::iterator it = cache.Transforms.find(key);
+		if (it != cache.Transforms.end()){
+			return *it->second;
+		}
+		DFTCosine *transform = new DFTCosine(type, n, orthonormal);
+		cache.Transforms[key] = transform;
+		return *transform;
+	}
+
+	//Constructor
+	DFTCosine::DFTCosine(Type type, unsigned int n, bool orthonormal): Kind(type), Size(n), Orthonormal(orthonormal), Plan(NULL){
+		if (!n){
+			throw Exception(EXCEPTION_DATA_INVALID, "Transform length cannot be zero!");
+		}
+		if (Kind == DCT4){
+			if (n % 2 == 0){
+				unsigned int m = n/2;
+				Plan = &DFTPlan::Get(m);
+				PreTwiddle.resize(m);
+				Twiddle.resize(m);
+				for (unsigned int i = 0; i < m; i++){
+					double angle = -PI*(4*i + 1)/(4.0*n);
+					PreTwiddle[i] = complex<double>(cos(angle), sin(angle));
+					angle = -PI*i/double(n);
+					Twiddle[i] = complex<double>(cos(angle), sin(angle));
+				}
+			}
+			else{
+				//X[k] = Re( exp(-i pi (2k+1)/4N) * FFT_2N(x[n] exp(-i pi n/2N))[k] )
+				Plan = &DFTPlan::Get(2*n);
+				PreTwiddle.resize(n);
+				Twiddle.resize(n);
+				for (unsigned int i = 0; i < n; i++){
+					double angle = -PI*i/(2.0*n);
+					PreTwiddle[i] = complex<double>(cos(angle), sin(angle));
+					angle = -PI*(2*i + 1)/(4.0*n);
+					Twiddle[i] = complex<double>(cos(angle), sin(angle));
+				}
+			}
+		}
+		else{
+			Plan = &DFTPlan::Get(n);
+			Twiddle.resize(n);
+			for (unsigned int k = 0; k < n; k++){
+				double angle = -PI*k/(2.0*n);
+				Twiddle[k] = complex<double>(cos(angle), sin(angle));
+			}
+		}
+	}
+
+	//Forward2() - Makhoul
+	void DFTCosine::Forward2(const double *in, double *out, complex<double> *work) const{
+		//Reorder: even samples ascending then odd samples descending. out doubles as the reordered buffer
+		unsigned int n = Size;
+		for (unsigned int i = 0; 2*i < n; i++){
+			out[i] = in[2*i];
+		}
+		for (unsigned int i = 0; 2*i+1 < n; i++){
+			out[n-1-i] = in[2*i+1];
+		}
+		Plan->ForwardReal(out, work);
+		//X[k] = Re(W^k V[k]), with V[k] = conj(V[N-k]) above N/2
+		unsigned int bins = Plan->GetRealSize();
+		for (unsigned int k = 0; k < n; k++){
+			complex<double> v = k < bins ? work[k] : conj(work[n-k]);
+			out[k] = Multiply(Twiddle[k], v).real();
+		}
+	}
+
+	//Inverse2()
+	void DFTCosine::Inverse2(const double *in, double *out, complex<double> *work, double *real) const{
+		//V[k] = W^-k (X[k] - i X[N-k]), X[N] = 0
+		unsigned int n = Size;
+		unsigned int bins = Plan->GetRealSize();
+		for (unsigned int k = 0; k < bins; k++){
+			complex<double> x(in[k], k ? -in[n-k] : 0.0);
+			work[k] = Multiply(conj(Twiddle[k]), x);
+		}
+		Plan->InverseReal(work, real);
+		//Undo the reordering
+		for (unsigned int i = 0; 2*i < n; i++){
+			out[2*i] = real[i];
+		}
+		for (unsigned int i = 0; 2*i+1 < n; i++){
+			out[2*i+1] = real[n-1-i];
+		}
+	}
+
+	//Forward4()
+	void DFTCosine::Forward4(const double *in, double *out, complex<double> *work) const{
+		unsigned int n = Size;
+		if (n % 2 == 0){
+			unsigned int m = n/2;
+			for (unsigned int i = 0; i < m; i++){
+				work[i] = Multiply(complex<double>(in[2*i], in[n-1-2*i]), PreTwiddle[i]);
+			}
+			Plan->Forward(work);
+			for (unsigned int k = 0; k < m; k++){
+				complex<double> u = Multiply(work[k], Twiddle[k]);
+				out[2*k] = u.real();
+				out[n-1-2*k] = -u.imag();
+			}
+		}
+		else{
+			for (unsigned int i = 0; i < n; i++){
+				work[i] = PreTwiddle[i]*in[i];
+			}
+			for (unsigned int i = n; i < 2*n; i++){
+				work[i] = 0;
+			}
+			Plan->Forward(work);
+			for (unsigned int k = 0; k < n; k++){
+				out[k] = Multiply(work[k], Twiddle[k]).real();
+			}
+		}
+	}
+
+	//TransformOne()
+	void DFTCosine::TransformOne(const double *in, double *out, vector<complex<double> > &work, vector<double> &scaled) const{
+		unsigned int n = Size;
+		if (work.size() < 2*n + 1){
+			work.resize(2*n + 1);
+		}
+		if (scaled.size() < 2*n){
+			scaled.resize(2*n);
+		}
+		double first = sqrt(1.0/n), rest = sqrt(2.0/n);
+		switch (Kind){
+		case DCT2:
+			Forward2(in, out, &work[0]);
+			if (Orthonormal){
+				out[0] *= first;
+				for (unsigned int k = 1; k < n; k++){
+					out[k] *= rest;
+				}
+			}
+			break;
+		case DCT3:
+			if (Orthonormal){
+				//Undo the orthonormal DCT-II scaling and invert
+				scaled[0] = in[0]/first;
+				for (unsigned int k = 1; k < n; k++){
+					scaled[k] = in[k]/rest;
+				}
+				Inverse2(&scaled[0], out, &work[0], &scaled[n]);
+			}
+			else{
+				//DCT-III(DCT-II(x)) = N/2 x
+				Inverse2(in, out, &work[0], &scaled[n]);
+				for (unsigned int k = 0; k < n; k++){
+					out[k] *= n/2.0;
+				}
+			}
+			break;
+		case DCT4:
+			Forward4(in, out, &work[0]);
+			if (Orthonormal){
+				for (unsigned int k = 0; k < n; k++){
+					out[k] *= rest;
+				}
+			}
+			break;
+		}
+	}
+
+	//Transform()
+	void DFTCosine::Transform(const double *in, double *out) const{
+		vector<complex<double> > work;
+		vector<double> scaled;
+		TransformOne(in, out, work, scaled);
+	}
+
+	//TransformBatch()
+	void DFTCosine::TransformBatch(const double *in, double *out, unsigned int frames) const{
+		//Scratch space is shared by the whole stack
+		vector<complex<double> > work;
+		vector<double> scaled;
+		for (unsigned int f = 0; f < frames; f++){
+			TransformOne(in + f*Size, out + f*Size, work, scaled);
+		}
+	}
+
+	//Transform() - DFTData
+	void DFTCosine::Transform(const DFTData &in, DFTData &out) const{
+		unsigned int dimension = in.DFTDimension();
+		if (in.DFTNumInterval() != Size){
+			throw Exception(EXCEPTION_DATA_INVALID, "Data length does not match the transform length.");
+		}
+		//We might have to change the dimensions and intervaln of the output - be sure to catch exceptions
+		if (dimension != out.DFTDimension()){
+			out.DFTSetDimension(dimension);
+		}
+		if (Size != out.DFTNumInterval()){
+			out.DFTSetNumInterval(Size);
+		}
+		vector<complex<double> > work;
+		vector<double> scaled, column(Size), result(Size);
+		for (unsigned int j = 0; j < dimension; j++){
+			in.DFTGetSplit(j, 0, Size, &column[0], NULL);
+			TransformOne(&column[0], &result[0], work, scaled);
+			out.DFTSetSplit(j, 0, Size, &result[0], NULL);
+		}
+	}
+
+	/************** DFTMDCT ****************/
+	//Constructor
+	DFTMDCT::DFTMDCT(unsigned int n, WindowType window): Size(n), Core(NULL){
+		if (!n || n % 2){
+			throw Exception(EXCEPTION_DATA_INVALID, "MDCT length must be even and non-zero!");
+		}
+		MakeWindow(window, 2*n, Window);
+		Core = &DFTCosine::Get(DFTCosine::DCT4, n, false);
+	}
+
+	//Forward()
+	void DFTMDCT::Forward(const double *frame, double *coefficients) const{
+		ForwardBatch(frame, coefficients, 1, 2*Size);
+	}
+
+	//Inverse()
+	void DFTMDCT::Inverse(const double *coefficients, double *frame) const{
+		InverseBatch(coefficients, frame, 1, 2*Size);
+	}
+
+	//ForwardBatch()
+	//With the windowed frame split into quarters (a, b, c, d), MDCT = DCT-IV(-c_r - d, a - b_r)
+	void DFTMDCT::ForwardBatch(const double *in, double *out, unsigned int frames, unsigned int stride) const{
+		unsigned int n = Size, h = Size/2;
+		vector<double> folded(n);
+		for (unsigned int f = 0; f < frames; f++){
+			const double *x = in + f*stride;
+			const double *w = &Window[0];
+			for (unsigned int i = 0; i < h; i++){
+				//-c_r - d
+				folded[i] = -x[3*h-1-i]*w[3*h-1-i] - x[3*h+i]*w[3*h+i];
+				//a - b_r
+				folded[h+i] = x[i]*w[i] - x[n-1-i]*w[n-1-i];
+			}
+			Core->Transform(&folded[0], out + f*n);
+		}
+	}
+
+	//InverseBatch()
+	//With u = DCT-IV(X) split into halves (u1, u2), the unwindowed output is 2(u2, -u2_r, -u1_r, -u1)/N
+	void DFTMDCT::InverseBatch(const double *in, double *out, unsigned int frames, unsigned int stride) const{
+		unsigned int n = Size, h = Size/2;
+		bool overlap = stride < 2*n;
+		if (overlap && frames){
+			unsigned int length = (frames-1)*stride + 2*n;
+			for (unsigned int i = 0; i < length; i++){
+				out[i] = 0;
+			}
+		}
+		vector<double> u(n), y(2*n);
+		double scale = 2.0/n;
+		for (unsigned int f = 0; f < frames; f++){
+			Core->Transform(in + f*n, &u[0]);
+			for (unsigned int i = 0; i < h; i++){
+				y[i] = u[h+i];
+				y[n-1-i] = -u[h+i];
+				y[n+i] = -u[h-1-i];
+				y[3*h+i] = -u[i];
+			}
+			double *frame = out + f*stride;
+			for (unsigned int i = 0; i < 2*n; i++){
+				double value = y[i]*Window[i]*scale;
+				if (overlap){
+					frame[i] += value;
+				}
+				else{
+					frame[i] = value;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,111 @@
+/*
+	Discrete Cosine Transforms built on the FFT plans
+
+	DFTCosine
+	DCT-II, DCT-III and DCT-IV of real data in O(N log N):
+		- DCT-II through Makhoul's reordering and one real input transform of length N
+		- DCT-III as the inverse of that mapping through one real inverse transform of length N
+		- DCT-IV through one complex transform of length N/2 with pre and post twiddles (even N),
+		  or one complex transform of length 2N otherwise
+	cf http://en.wikipedia.org/wiki/Discrete_cosine_transform
+
+	Unnormalised definitions, with N the length:
+		DCT-II:  X[k] = sum x[n] cos(pi (2n+1) k / 2N)
+		DCT-III: X[k] = x[0]/2 + sum_{n>0} x[n] cos(pi n (2k+1) / 2N)
+		DCT-IV:  X[k] = sum x[n] cos(pi (2n+1)(2k+1) / 4N)
+	The orthonormal versions (the default) match Matlab's dct and idct: DCT-III is then the exact inverse of DCT-II,
+	and DCT-IV is its own inverse.
+
+	DFTMDCT
+	Windowed Modified Discrete Cosine Transform. Frames of 2N samples give N coefficients through a folding and
+	a DCT-IV. The inverse produces windowed 2N sample frames whose overlap-add at a hop of N cancels the time
+	domain aliasing. The window must satisfy w[n]^2 + w[n+N]^2 = 1; the sine window does.
+	cf http://en.wikipedia.org/wiki/Modified_discrete_cosine_transform
+
+	Both share the plan cache of DFTPlan and are immutable once constructed, so Get() hands out cached objects.
+*/
+#pragma once
+#ifndef DFTCosine_H
+#define DFTCosine_H
+
+#include <vector>
+#include <complex>
+#include "DFTData.h"
+#include "DFTPlan.h"
+#include "DFTUtility.h"
+
+namespace DFT{
+	/************** DFTCosine ****************/
+	class DFTCosine{
+	public:
+		enum Type { DCT2, DCT3, DCT4 };
+
+	private:
+		Type Kind;									//Which transform
+		unsigned int Size;							//Length
+		bool Orthonormal;							//Scale to an orthonormal transform
+		const DFTPlan *Plan;						//Length N plan for DCT-II/III, N/2 or 2N plan for DCT-IV
+		std::vector<std::complex<double> > Twiddle;	//exp(-i pi k/2N) for DCT-II/III. Post twiddle for DCT-IV
+		std::vector<std::complex<double> > PreTwiddle;	//Pre twiddle for DCT-IV
+
+		DFTCosine(const DFTCosine &);
+		DFTCosine &operator=(const DFTCosine &);
+
+	protected:
+		//Unnormalised kernels. work must hold Size+1 complex values (2*Size for odd length DCT-IV), real Size values
+		void Forward2(const double *in, double *out, std::complex<double> *work) const;
+		void Inverse2(const double *in, double *out, std::complex<double> *work, double *real) const;		//Exact inverse of Forward2()
+		void Forward4(const double *in, double *out, std::complex<double> *work) const;
+		//Transform one frame with scaling. scratch is resized as needed
+		void TransformOne(const double *in, double *out, std::vector<std::complex<double> > &work, std::vector<double> &scaled) const;
+
+	public:
+		DFTCosine(Type type, unsigned int n, bool orthonormal=true);
+
+		Type GetType() const{ return Kind; }
+		unsigned int GetSize() const{ return Size; }
+		bool IsOrthonormal() const{ return Orthonormal; }
+
+		//Transform n values from in into out. in and out may not overlap.
+		void Transform(const double *in, double *out) const;
+		//Transform a stack of frames, each GetSize() values, stored one after the other
+		void TransformBatch(const double *in, double *out, unsigned int frames) const;
+		//Transform the real part of every dimension of in along the intervals and store it in out.
+		//in must have GetSize() intervals. out is resized where it supports it, as DFTMatlab does.
+		void Transform(const DFTData &in, DFTData &out) const;
+
+		//Get a cached transform. Thread safe.
+		static const DFTCosine &Get(Type type, unsigned int n, bool orthonormal=true);
+	};
+
+	/************** DFTMDCT ****************/
+	class DFTMDCT{
+		unsigned int Size;							//Number of coefficients N. Frames are 2N samples
+		std::vector<double> Window;					//Analysis and synthesis window, 2N
+		const DFTCosine *Core;						//Unnormalised DCT-IV of length N
+
+		DFTMDCT(const DFTMDCT &);
+		DFTMDCT &operator=(const DFTMDCT &);
+
+	public:
+		//n is the number of coefficients and must be even. The window is 2n long.
+		DFTMDCT(unsigned int n, WindowType window=WindowSine);
+
+		unsigned int GetSize() const{ return Size; }
+		unsigned int GetFrameSize() const{ return 2*Size; }
+
+		//Window and transform one frame of 2N samples into N coefficients
+		void Forward(const double *frame, double *coefficients) const;
+		//Transform N coefficients back into a windowed frame of 2N samples, ready to be overlap-added at a hop of N
+		void Inverse(const double *coefficients, double *frame) const;
+
+		//Batch versions. Frame i starts at in + i*stride. Use stride N on a contiguous signal for the usual
+		//50% overlapped MDCT, or 2N for a stack of separate frames. Coefficients are written one frame after the other.
+		void ForwardBatch(const double *in, double *out, unsigned int frames, unsigned int stride) const;
+		//Inverse of a stack of coefficient frames. With a stride below 2N the frames are overlap-added into out, which must
+		//hold (frames-1)*stride + 2N samples and is cleared first. With stride 2N they are written side by side.
+		void InverseBatch(const double *in, double *out, unsigned int frames, unsigned int stride) const;
+	};
+}
+
+#endif /*DFTCosine_H*/
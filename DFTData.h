@@ -24,6 +24,7 @@ namespace DFT{
 
 	/********** DFTDATA *************/
 	class DFTData{
+		static const unsigned int FLOAT_RUN = 256;		//Values converted at a time by the single precision defaults
 	public:
 		enum Domain { Time, Frequency };				//Type enum
 		virtual ~DFTData(){}							//Virtual Destructor - cf http://www.parashift.com/c++-faq-lite/virtual-functions.html#faq-20.7
@@ -33,6 +34,11 @@ namespace DFT{
 		virtual Domain DFTDomain() const = 0;					//Return the domain the data is stored in
 		//Returns Interval. If Time Domain, returns the time interval between samples. If Freq Domain, returns the frequency interval between values
 		virtual double DFTInterval() const = 0;			
+		//Whether every value is real, so that transforms can take their real input path and skip the imaginary parts
+		virtual bool DFTIsReal() const{ return false; }
+		//Whether the values are conjugate symmetric, value N-k the conjugate of value k, and only intervals 0 to N/2
+		//are stored, so that transforms need only write those
+		virtual bool DFTIsHermitian() const{ return false; }
 
 		//Optional Setters
 		virtual void DFTSetDimension(unsigned int n){		//Set the number of dimensions. Can be unsupported.
@@ -55,6 +61,88 @@ namespace DFT{
 		//But there should not be a reason to do so
 		//Index starts from ZERO
 		virtual void DFTSet(unsigned int intervalN, unsigned int dimension, const std::complex<double> &data) = 0;
+
+		//Bulk access to count intervals of a dimension from interval first, so that whole columns are copied without
+		//a virtual call per sample. The defaults go through DFTGet() and DFTSet(); implementations override them with
+		//straight copies.
+		virtual void DFTGetRange(unsigned int dimension, unsigned int first, unsigned int count, std::complex<double> *out) const{
+			for (unsigned int i = 0; i < count; i++){
+				out[i] = DFTGet(first + i, dimension);
+			}
+		}
+		//Same, split into real and imaginary parts. imag can be NULL.
+		virtual void DFTGetSplit(unsigned int dimension, unsigned int first, unsigned int count, double *real, double *imag) const{
+			for (unsigned int i = 0; i < count; i++){
+				std::complex<double> value = DFTGet(first + i, dimension);
+				real[i] = value.real();
+				if (imag){
+					imag[i] = value.imag();
+				}
+			}
+		}
+		virtual void DFTSetRange(unsigned int dimension, unsigned int first, unsigned int count, const std::complex<double> *in){
+			for (unsigned int i = 0; i < count; i++){
+				DFTSet(first + i, dimension, in[i]);
+			}
+		}
+		//imag can be NULL for real values
+		virtual void DFTSetSplit(unsigned int dimension, unsigned int first, unsigned int count, const double *real, const double *imag){
+			for (unsigned int i = 0; i < count; i++){
+				DFTSet(first + i, dimension, std::complex<double>(real[i], imag ? imag[i] : 0));
+			}
+		}
+		//Single precision bulk access, for float pipelines. The defaults go through the double precision methods above,
+		//a run at a time; implementations storing floats override them with straight copies.
+		virtual void DFTGetRangeFloat(unsigned int dimension, unsigned int first, unsigned int count, std::complex<float> *out) const{
+			std::complex<double> buffer[FLOAT_RUN];
+			for (unsigned int done = 0; done < count; done += FLOAT_RUN){
+				unsigned int n = (count - done < FLOAT_RUN) ? count - done : FLOAT_RUN;
+				DFTGetRange(dimension, first + done, n, buffer);
+				for (unsigned int i = 0; i < n; i++){
+					out[done + i] = std::complex<float>(buffer[i]);
+				}
+			}
+		}
+		//imag can be NULL
+		virtual void DFTGetSplitFloat(unsigned int dimension, unsigned int first, unsigned int count, float *real, float *imag) const{
+			std::complex<double> buffer[FLOAT_RUN];
+			for (unsigned int done = 0; done < count; done += FLOAT_RUN){
+				unsigned int n = (count - done < FLOAT_RUN) ? count - done : FLOAT_RUN;
+				DFTGetRange(dimension, first + done, n, buffer);
+				for (unsigned int i = 0; i < n; i++){
+					real[done + i] = float(buffer[i].real());
+					if (imag){
+						imag[done + i] = float(buffer[i].imag());
+					}
+				}
+			}
+		}
+		virtual void DFTSetRangeFloat(unsigned int dimension, unsigned int first, unsigned int count, const std::complex<float> *in){
+			std::complex<double> buffer[FLOAT_RUN];
+			for (unsigned int done = 0; done < count; done += FLOAT_RUN){
+				unsigned int n = (count - done < FLOAT_RUN) ? count - done : FLOAT_RUN;
+				for (unsigned int i = 0; i < n; i++){
+					buffer[i] = std::complex<double>(in[done + i]);
+				}
+				DFTSetRange(dimension, first + done, n, buffer);
+			}
+		}
+		//imag can be NULL for real values
+		virtual void DFTSetSplitFloat(unsigned int dimension, unsigned int first, unsigned int count, const float *real, const float *imag){
+			std::complex<double> buffer[FLOAT_RUN];
+			for (unsigned int done = 0; done < count; done += FLOAT_RUN){
+				unsigned int n = (count - done < FLOAT_RUN) ? count - done : FLOAT_RUN;
+				for (unsigned int i = 0; i < n; i++){
+					buffer[i] = std::complex<double>(real[done + i], imag ? imag[done + i] : 0);
+				}
+				DFTSetRange(dimension, first + done, n, buffer);
+			}
+		}
+		//Where the values of a dimension are stored, when they are stored as complex<double>: interval i is at
+		//span[i*stride], for the DFTNumInterval() intervals. NULL when they are not, in which case use the methods above.
+		virtual const std::complex<double> *DFTSpan(unsigned int dimension, unsigned int &stride) const{
+			return NULL;
+		}
 	};
 
 	/********** DFTTime *************/
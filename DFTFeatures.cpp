@@ -0,0 +1,295 @@
+//DFTFeatures.cpp
+#include <cmath>
+#include <fstream>
+#include <algorithm>
+#include "DFTFeatures.h"
+#include "DFTSTFT.h"
+#ifdef WAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+namespace DFT{
+	namespace{
+		const double FLOOR = 1e-10;				//Added to the magnitudes for the flatness so that silent bins do not zero the product
+		const unsigned int BATCH_FRAMES = 64;	//Frames transformed before their features are computed in Extract()
+		const double LN2 = 0.69314718055994530942;
+
+		//Natural logarithm of the product of the two lanes, scaled by 2^exponent
+		inline double LogProduct(double a, double b, int exponent){
+			return log(a) + log(b) + exponent*LN2;
+		}
+	}
+
+	/************** DFTFeatureTable ****************/
+	//Reset()
+	void DFTFeatureTable::Reset(unsigned int channels, unsigned int peaks, double interval, double offset){
+		Channels = channels;
+		Peaks = peaks;
+		FrameInterval = interval;
+		FrameOffset = offset;
+		Rows = 0;
+		Centroid.clear();
+		Bandwidth.clear();
+		Rolloff.clear();
+		Flatness.clear();
+		Flux.clear();
+		PeakFrequency.clear();
+		PeakMagnitude.clear();
+	}
+
+	//AddFrames()
+	unsigned int DFTFeatureTable::AddFrames(unsigned int n){
+		if (!Channels){
+			throw Exception(EXCEPTION_INITIALISATION, "Feature table has not been reset with a number of channels.");
+		}
+		unsigned int first = NumFrames();
+		Rows += n*Channels;
+		Centroid.resize(Rows);
+		Bandwidth.resize(Rows);
+		Rolloff.resize(Rows);
+		Flatness.resize(Rows);
+		Flux.resize(Rows);
+		PeakFrequency.resize(Rows*Peaks);
+		PeakMagnitude.resize(Rows*Peaks);
+		return first;
+	}
+
+	//Write()
+	void DFTFeatureTable::Write(const char *filename) const{
+		ofstream file(filename, ios_base::out | ios_base::trunc);
+		if (!file){
+			throw Exception(EXCEPTION_FILE_CANNOT_OPEN_OUTPUT, "Unable to open file for writing.");
+		}
+		file << "time,channel,centroid,bandwidth,rolloff,flatness,flux";
+		for (unsigned int k = 0; k < Peaks; k++){
+			file << ",peak" << k+1 << "_frequency";
+		}
+		for (unsigned int k = 0; k < Peaks; k++){
+			file << ",peak" << k+1 << "_magnitude";
+		}
+		file << '\n';
+		for (unsigned int r = 0; r < Rows; r++){
+			file << GetFrameTime(r/Channels) << ',' << r % Channels << ',' << Centroid[r] << ',' << Bandwidth[r] << ','
+				<< Rolloff[r] << ',' << Flatness[r] << ',' << Flux[r];
+			for (unsigned int k = 0; k < Peaks; k++){
+				file << ',' << PeakFrequency[r*Peaks + k];
+			}
+			for (unsigned int k = 0; k < Peaks; k++){
+				file << ',' << PeakMagnitude[r*Peaks + k];
+			}
+			file << '\n';
+		}
+		if (!file){
+			throw Exception(EXCEPTION_FILE_CANNOT_OPEN_OUTPUT, "Unable to write the feature table.");
+		}
+	}
+
+	/************** DFTFeatures ****************/
+	//Constructor
+	DFTFeatures::DFTFeatures(unsigned int bins, double interval, unsigned int peaks, double rolloff)
+		: Bins(bins), BinInterval(interval), Peaks(peaks), RolloffFraction(rolloff){
+		if (bins < 3){
+			throw Exception(EXCEPTION_DATA_INVALID, "Frames must have at least three bins!");
+		}
+		if (interval <= 0){
+			throw Exception(EXCEPTION_DATA_INVALID, "Bin interval must be positive!");
+		}
+		if (!(rolloff > 0 && rolloff <= 1)){
+			throw Exception(EXCEPTION_DATA_INVALID, "Rolloff must be within (0, 1]!");
+		}
+		Frequency.resize(Bins);
+		for (unsigned int k = 0; k < Bins; k++){
+			Frequency[k] = k*BinInterval;
+		}
+	}
+
+	//Compute()
+	void DFTFeatures::Compute(const double *magnitudes, unsigned int frames, const double *previous,
+		DFTFeatureTable &table, unsigned int first, unsigned int channel) const{
+		if (table.NumPeaks() != Peaks || channel >= table.NumChannels() || first + frames > table.NumFrames()){
+			throw Exception(EXCEPTION_RANGE, "Feature table does not have room for the frames.");
+		}
+		unsigned int channels = table.NumChannels();
+		const double *frequency = &Frequency[0];
+		vector<unsigned int> peakBin(Peaks + 1);
+
+		for (unsigned int f = 0; f < frames; f++){
+			const double *m = magnitudes + f*Bins;
+			const double *p = (f > 0) ? m - Bins : previous;
+			unsigned int row = (first + f)*channels + channel;
+
+			//One pass for the sums
+			double sum, weighted, squared, flux, logProduct;
+			unsigned int k = 0;
+			int exponent = 0;
+#ifdef WAVE_SSE2
+			__m128d vSum = _mm_setzero_pd(), vWeighted = _mm_setzero_pd(), vSquared = _mm_setzero_pd();
+			__m128d vFlux = _mm_setzero_pd(), vProduct = _mm_set1_pd(1.0);
+			const __m128d vFloor = _mm_set1_pd(FLOOR), vZero = _mm_setzero_pd();
+			for (unsigned int run = 0; k + 1 < Bins; k += 2){
+				__m128d x = _mm_loadu_pd(m + k);
+				__m128d fx = _mm_mul_pd(_mm_loadu_pd(frequency + k), x);
+				vSum = _mm_add_pd(vSum, x);
+				vWeighted = _mm_add_pd(vWeighted, fx);
+				vSquared = _mm_add_pd(vSquared, _mm_mul_pd(_mm_loadu_pd(frequency + k), fx));
+				if (p){
+					__m128d d = _mm_max_pd(_mm_sub_pd(x, _mm_loadu_pd(p + k)), vZero);
+					vFlux = _mm_add_pd(vFlux, _mm_mul_pd(d, d));
+				}
+				vProduct = _mm_mul_pd(vProduct, _mm_add_pd(x, vFloor));
+				//Renormalise the running product before it can overflow or underflow
+				if (++run == 8){
+					double lanes[2];
+					int e0, e1;
+					_mm_storeu_pd(lanes, vProduct);
+					lanes[0] = frexp(lanes[0], &e0);
+					lanes[1] = frexp(lanes[1], &e1);
+					exponent += e0 + e1;
+					vProduct = _mm_loadu_pd(lanes);
+					run = 0;
+				}
+			}
+			double lanes[2];
+			_mm_storeu_pd(lanes, vSum);
+			sum = lanes[0] + lanes[1];
+			_mm_storeu_pd(lanes, vWeighted);
+			weighted = lanes[0] + lanes[1];
+			_mm_storeu_pd(lanes, vSquared);
+			squared = lanes[0] + lanes[1];
+			_mm_storeu_pd(lanes, vFlux);
+			flux = lanes[0] + lanes[1];
+			_mm_storeu_pd(lanes, vProduct);
+			double product0 = lanes[0], product1 = lanes[1];
+#else
+			sum = weighted = squared = flux = 0;
+			double product0 = 1, product1 = 1;
+			for (unsigned int run = 0; k < Bins; k++){
+				double x = m[k];
+				sum += x;
+				weighted += frequency[k]*x;
+				squared += frequency[k]*frequency[k]*x;
+				if (p){
+					double d = x - p[k];
+					flux += d > 0 ? d*d : 0;
+				}
+				product0 *= x + FLOOR;
+				if (++run == 16){
+					int e;
+					product0 = frexp(product0, &e);
+					exponent += e;
+					run = 0;
+				}
+			}
+#endif
+			//Odd bin left over
+			for (; k < Bins; k++){
+				double x = m[k];
+				sum += x;
+				weighted += frequency[k]*x;
+				squared += frequency[k]*frequency[k]*x;
+				if (p){
+					double d = x - p[k];
+					flux += d > 0 ? d*d : 0;
+				}
+				product0 *= x + FLOOR;
+			}
+			logProduct = LogProduct(product0, product1, exponent);
+
+			if (sum > 0){
+				double centroid = weighted/sum;
+				table.Centroid[row] = centroid;
+				table.Bandwidth[row] = sqrt(max(0.0, squared/sum - centroid*centroid));
+			}
+			else{
+				table.Centroid[row] = 0;
+				table.Bandwidth[row] = 0;
+			}
+			table.Flatness[row] = exp(logProduct/Bins)/(sum/Bins + FLOOR);
+			table.Flux[row] = sqrt(flux);
+
+			//Rolloff
+			double threshold = RolloffFraction*sum, cumulative = 0;
+			unsigned int rolloff = 0;
+			if (sum > 0){
+				for (rolloff = 0; rolloff < Bins - 1; rolloff++){
+					cumulative += m[rolloff];
+					if (cumulative >= threshold){
+						break;
+					}
+				}
+			}
+			table.Rolloff[row] = frequency[rolloff];
+
+			//Largest local maxima, kept sorted by decreasing magnitude
+			unsigned int found = 0;
+			for (k = 1; k + 1 < Bins && Peaks; k++){
+				double x = m[k];
+				if (!(x > m[k-1] && x >= m[k+1]) || (found == Peaks && x <= m[peakBin[found-1]])){
+					continue;
+				}
+				unsigned int i = (found < Peaks) ? found++ : found - 1;
+				for (; i > 0 && m[peakBin[i-1]] < x; i--){
+					peakBin[i] = peakBin[i-1];
+				}
+				peakBin[i] = k;
+			}
+			double *peakFrequency = &table.PeakFrequency[0] + row*Peaks;
+			double *peakMagnitude = &table.PeakMagnitude[0] + row*Peaks;
+			for (unsigned int i = 0; i < Peaks; i++){
+				if (i >= found){
+					peakFrequency[i] = 0;
+					peakMagnitude[i] = 0;
+					continue;
+				}
+				//Parabola through the log magnitudes of the bin and its neighbours
+				unsigned int b = peakBin[i];
+				double alpha = log(m[b-1] + FLOOR), beta = log(m[b] + FLOOR), gamma = log(m[b+1] + FLOOR);
+				double curvature = alpha - 2*beta + gamma;
+				double offset = (curvature < 0) ? 0.5*(alpha - gamma)/curvature : 0;
+				peakFrequency[i] = (b + offset)*BinInterval;
+				peakMagnitude[i] = exp(beta - 0.25*(alpha - gamma)*offset) - FLOOR;
+			}
+		}
+	}
+
+	//Extract()
+	void DFTFeatures::Extract(Wave::WaveFile &wave, DFTFeatureTable &table, unsigned int frame, unsigned int hop,
+		unsigned int peaks, double rolloff, WindowType window){
+		unsigned int channels = wave.NumChannels();
+		double interval = wave.Interval();
+		DFTAnalysis analysis(frame, hop, window);
+		analysis.Reset(channels);
+		unsigned int bins = analysis.GetBins();
+		DFTFeatures features(bins, 1.0/(interval*frame), peaks, rolloff);
+		table.Reset(channels, peaks, hop*interval, frame/2*interval);
+
+		vector<double> chunk(BATCH_FRAMES*hop*channels);
+		vector<double> magnitudes, previous(channels*bins);
+		vector<complex<double> > spectra;
+		bool first = true;
+		wave.DataRewind();
+		unsigned int blocks;
+		while ((blocks = wave.DataNextBlocks(&chunk[0], BATCH_FRAMES*hop)) != 0){
+			unsigned int n = analysis.Push(&chunk[0], blocks, spectra);
+			if (!n){
+				continue;
+			}
+			unsigned int row = table.AddFrames(n);
+			magnitudes.resize(n*bins);
+			for (unsigned int c = 0; c < channels; c++){
+				//Gather the magnitudes of the channel into contiguous frames
+				for (unsigned int f = 0; f < n; f++){
+					const complex<double> *spectrum = &spectra[(f*channels + c)*bins];
+					double *m = &magnitudes[f*bins];
+					for (unsigned int k = 0; k < bins; k++){
+						m[k] = sqrt(spectrum[k].real()*spectrum[k].real() + spectrum[k].imag()*spectrum[k].imag());
+					}
+				}
+				features.Compute(&magnitudes[0], n, first ? NULL : &previous[c*bins], table, row, c);
+				copy(magnitudes.end() - bins, magnitudes.end(), previous.begin() + c*bins);
+			}
+			first = false;
+		}
+	}
+}
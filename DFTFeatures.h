@@ -0,0 +1,102 @@
+/*
+	Spectral Features
+
+	DFTFeatures
+	Per frame descriptors of magnitude spectra, computed over contiguous frames rather than through DFTData::DFTGet():
+		- Centroid: magnitude weighted mean frequency
+		- Bandwidth: magnitude weighted standard deviation of the frequency around the centroid
+		- Rolloff: frequency below which a fraction (0.85 by default) of the total magnitude lies
+		- Flatness: geometric mean over arithmetic mean of the magnitudes, 1 for white noise and 0 for a pure tone
+		- Flux: L2 norm of the increase in magnitude from the previous frame of the same channel
+		- Peaks: the largest local maxima, with frequency and magnitude refined by fitting a parabola through
+		  the log magnitudes of the peak bin and its neighbours
+		cf http://en.wikipedia.org/wiki/Spectral_flatness, https://ccrma.stanford.edu/~jos/sasp/Quadratic_Interpolation_Spectral_Peaks.html
+
+	The sums behind the centroid, bandwidth, flatness and flux are accumulated in one SSE2 pass per frame. The
+	flatness uses a running product that is renormalised with frexp() so that no logarithm is needed per bin.
+
+	DFTFeatureTable
+	The result for a file. Every feature is a column of its own, one row per frame and channel, ordered frame by
+	frame and then channel by channel, so row = frame*NumChannels() + channel. Peaks are NumPeaks() columns of
+	frequencies and NumPeaks() columns of magnitudes; frames with fewer peaks have zeros in the remaining columns.
+	Write() saves the table as a CSV file with a header line.
+*/
+#pragma once
+#ifndef DFTFeatures_H
+#define DFTFeatures_H
+
+#include <vector>
+#include "DFTUtility.h"
+#include "WaveFile.h"
+
+namespace DFT{
+	/************** DFTFeatureTable ****************/
+	class DFTFeatureTable{
+		unsigned int Channels;					//Number of channels
+		unsigned int Peaks;						//Peaks per row
+		double FrameInterval;					//Time between the start of consecutive frames
+		double FrameOffset;						//Time of the centre of the first frame
+		unsigned int Rows;						//Number of rows
+
+	public:
+		//Columns
+		std::vector<double> Centroid;
+		std::vector<double> Bandwidth;
+		std::vector<double> Rolloff;
+		std::vector<double> Flatness;
+		std::vector<double> Flux;
+		std::vector<double> PeakFrequency;		//Peaks per row, row after row
+		std::vector<double> PeakMagnitude;		//Peaks per row, row after row
+
+		DFTFeatureTable(): Channels(0), Peaks(0), FrameInterval(1.0), FrameOffset(0), Rows(0){}
+
+		//Clear the table and set its shape. interval is the time between frames and offset the time of the first one.
+		void Reset(unsigned int channels, unsigned int peaks, double interval, double offset=0);
+		//Add rows for n more frames and return the index of the first one
+		unsigned int AddFrames(unsigned int n);
+
+		//Write the table to a CSV file: time, channel, the features and then the peak frequencies and magnitudes
+		void Write(const char *file) const;
+
+		//Getters
+		unsigned int NumChannels() const{ return Channels; }
+		unsigned int NumPeaks() const{ return Peaks; }
+		unsigned int NumFrames() const{ return Channels ? Rows/Channels : 0; }
+		unsigned int NumRows() const{ return Rows; }
+		double GetFrameInterval() const{ return FrameInterval; }
+		double GetFrameTime(unsigned int frame) const{ return FrameOffset + frame*FrameInterval; }
+	};
+
+	/************** DFTFeatures ****************/
+	class DFTFeatures{
+		unsigned int Bins;						//Magnitudes per frame
+		double BinInterval;						//Frequency spacing of the bins
+		unsigned int Peaks;						//Number of peaks to pick
+		double RolloffFraction;					//Fraction of the total magnitude for the rolloff
+		std::vector<double> Frequency;			//Frequency of every bin
+
+	public:
+		//bins is the number of magnitudes per frame, starting at DC, and interval their spacing in Hz.
+		//rolloff must be in (0, 1].
+		DFTFeatures(unsigned int bins, double interval, unsigned int peaks=5, double rolloff=0.85);
+
+		//Compute the features of frames consecutive magnitude frames of one channel, each GetBins() values.
+		//previous is the frame before the first for the flux, or NULL if there is none, in which case the flux of the first
+		//frame is zero. The results go into the rows of frames first, first+1, ... for channel in table.
+		void Compute(const double *magnitudes, unsigned int frames, const double *previous,
+			DFTFeatureTable &table, unsigned int first, unsigned int channel) const;
+
+		//Stream the data chunk of the wave file through a short time Fourier transform and compute the features of every
+		//frame of every channel. The file is read in batches of frames, so it need not fit in memory.
+		static void Extract(Wave::WaveFile &wave, DFTFeatureTable &table, unsigned int frame=2048, unsigned int hop=512,
+			unsigned int peaks=5, double rolloff=0.85, WindowType window=WindowHann);
+
+		//Getters
+		unsigned int GetBins() const{ return Bins; }
+		double GetBinInterval() const{ return BinInterval; }
+		unsigned int NumPeaks() const{ return Peaks; }
+		double GetRolloffFraction() const{ return RolloffFraction; }
+	};
+}
+
+#endif /*DFTFeatures_H*/
@@ -0,0 +1,182 @@
+//DFTFilterbank.cpp
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <algorithm>
+#include "DFTFilterbank.h"
+#include "DFTUtility.h"
+#include "WaveMisc.h"
+#ifdef WAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+namespace DFT{
+	namespace{
+		//Cache key. Sample rates need not be whole numbers.
+		struct FilterbankKey_T{
+			int Scale;
+			double SampleRate;
+			unsigned int FFTSize;
+			unsigned int Bands;
+			bool operator<(const FilterbankKey_T &op) const{
+				if (Scale != op.Scale) return Scale < op.Scale;
+				if (SampleRate != op.SampleRate) return SampleRate < op.SampleRate;
+				if (FFTSize != op.FFTSize) return FFTSize < op.FFTSize;
+				return Bands < op.Bands;
+			}
+		};
+		//Owns every filterbank handed out by DFTFilterbank::Get()
+		struct FilterbankCache_T{
+			map<FilterbankKey_T, DFTFilterbank*> Filterbanks;
+			mutex Lock;				//Guards the map, for transforms running on several threads
+			~FilterbankCache_T(){
+				map<FilterbankKey_T, DFTFilterbank*>::iterator it;
+				for (it = Filterbanks.begin(); it != Filterbanks.end(); it++){
+					delete it->second;
+				}
+			}
+		};
+		FilterbankCache_T &FilterbankCache(){
+			static FilterbankCache_T cache;
+			return cache;
+		}
+		//Construct the cache while there is a single thread
+		FilterbankCache_T &Constructed = FilterbankCache();
+	}
+
+	//Get()
+	const DFTFilterbank &DFTFilterbank::Get(Scale scale, double sampleRate, unsigned int fftSize, unsigned int bands){
+		FilterbankKey_T key = {int(scale), sampleRate, fftSize, bands};
+		FilterbankCache_T &cache = FilterbankCache();
+		lock_guard<mutex> lock(cache.Lock);
+		map<FilterbankKey_T, DFTFilterbank*>::iterator it = cache.Filterbanks.find(key);
+		if (it != cache.Filterbanks.end()){
+			return *it->second;
+		}
+		DFTFilterbank *filterbank = new DFTFilterbank(scale, sampleRate, fftSize, bands);
+		cache.Filterbanks[key] = filterbank;
+		return *filterbank;
+	}
+
+	//ToScale()
+	double DFTFilterbank::ToScale(Scale scale, double frequency){
+		if (scale == Bark){
+			//Traunmuller
+			return 26.81*frequency/(1960 + frequency) - 0.53;
+		}
+		return 2595*log10(1 + frequency/700);
+	}
+	//FromScale()
+	double DFTFilterbank::FromScale(Scale scale, double value){
+		if (scale == Bark){
+			return 1960*(value + 0.53)/(26.28 - value);
+		}
+		return 700*(pow(10, value/2595) - 1);
+	}
+
+	//Constructor
+	DFTFilterbank::DFTFilterbank(Scale scale, double sampleRate, unsigned int fftSize, unsigned int bands, double minimum, double maximum)
+		: Kind(scale), SampleRate(sampleRate), FFTSize(fftSize), Bands(bands), MinFrequency(minimum), MaxFrequency(maximum){
+		if (sampleRate <= 0 || fftSize < 2 || !bands){
+			throw Exception(EXCEPTION_DATA_INVALID, "Sample rate, transform length and number of bands must be positive!");
+		}
+		if (!MaxFrequency){
+			MaxFrequency = sampleRate/2;
+		}
+		if (MinFrequency < 0 || MaxFrequency <= MinFrequency || MaxFrequency > sampleRate/2){
+			throw Exception(EXCEPTION_DATA_INVALID, "Frequency range must be within DC and the Nyquist frequency!");
+		}
+		//Edges evenly spaced on the scale
+		vector<double> edges(Bands + 2);
+		double low = ToScale(Kind, MinFrequency), high = ToScale(Kind, MaxFrequency);
+		for (unsigned int i = 0; i < edges.size(); i++){
+			edges[i] = FromScale(Kind, low + (high - low)*i/(Bands + 1));
+		}
+		//Only the bins strictly within the edges of a filter have a non-zero weight
+		double spacing = sampleRate/fftSize;
+		unsigned int bins = GetBins();
+		Start.resize(Bands);
+		Offset.resize(Bands + 1);
+		Offset[0] = 0;
+		for (unsigned int b = 0; b < Bands; b++){
+			double left = edges[b], centre = edges[b+1], right = edges[b+2];
+			unsigned int first = unsigned(floor(left/spacing)) + 1;
+			unsigned int last = min(bins - 1, unsigned(ceil(right/spacing)) - 1);
+			Start[b] = min(first, bins);
+			for (unsigned int k = first; k <= last && k < bins; k++){
+				double frequency = k*spacing;
+				double weight = (frequency <= centre) ? (frequency - left)/(centre - left) : (right - frequency)/(right - centre);
+				Weights.push_back(max(0.0, weight));
+			}
+			Offset[b+1] = unsigned(Weights.size());
+		}
+
+		//Orthonormal DCT-II: c[k] = s(k) sum x[n] cos(pi k (2n+1)/2N), s(0) = sqrt(1/N), s(k) = sqrt(2/N)
+		Cosines.resize(Bands*Bands);
+		for (unsigned int k = 0; k < Bands; k++){
+			double s = sqrt((k ? 2.0 : 1.0)/Bands);
+			for (unsigned int n = 0; n < Bands; n++){
+				Cosines[k*Bands + n] = s*cos(PI*k*(2*n + 1)/(2.0*Bands));
+			}
+		}
+	}
+
+	//Energy()
+	double DFTFilterbank::Energy(const double *power, unsigned int band) const{
+		const double *x = power + Start[band], *w = GetWeights(band);
+		unsigned int n = GetLength(band), i = 0;
+		double sum = 0;
+#ifdef WAVE_SSE2
+		__m128d acc = _mm_setzero_pd();
+		for (; i + 1 < n; i += 2){
+			acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(w + i)));
+		}
+		double lanes[2];
+		_mm_storeu_pd(lanes, acc);
+		sum = lanes[0] + lanes[1];
+#endif
+		for (; i < n; i++){
+			sum += x[i]*w[i];
+		}
+		return sum;
+	}
+
+	//Apply()
+	void DFTFilterbank::Apply(const double *power, double *energies) const{
+		for (unsigned int b = 0; b < Bands; b++){
+			energies[b] = Energy(power, b);
+		}
+	}
+
+	//ApplyBatch()
+	void DFTFilterbank::ApplyBatch(const double *power, unsigned int frames, unsigned int stride, double *energies) const{
+		for (unsigned int f = 0; f < frames; f++){
+			Apply(power + f*stride, energies + f*Bands);
+		}
+	}
+
+	//Cepstrum()
+	void DFTFilterbank::Cepstrum(const double *power, unsigned int frames, unsigned int stride, unsigned int coefficients, double *out,
+		double floor) const{
+		if (coefficients > Bands){
+			throw Exception(EXCEPTION_DATA_INVALID, "Cannot have more coefficients than bands!");
+		}
+		vector<double> logEnergies(Bands);
+		for (unsigned int f = 0; f < frames; f++){
+			const double *frame = power + f*stride;
+			for (unsigned int b = 0; b < Bands; b++){
+				logEnergies[b] = log(Energy(frame, b) + floor);
+			}
+			double *cepstrum = out + f*coefficients;
+			for (unsigned int k = 0; k < coefficients; k++){
+				const double *row = &Cosines[k*Bands];
+				double sum = 0;
+				for (unsigned int n = 0; n < Bands; n++){
+					sum += row[n]*logEnergies[n];
+				}
+				cepstrum[k] = sum;
+			}
+		}
+	}
+}
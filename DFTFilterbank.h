@@ -0,0 +1,87 @@
+/*
+	Filterbank
+
+	DFTFilterbank
+	Triangular filters spaced evenly on the mel or Bark scale, applied to power spectra to get band energies, and
+	optionally the mel frequency cepstral coefficients (MFCC) of these energies.
+	cf http://en.wikipedia.org/wiki/Mel_scale, http://en.wikipedia.org/wiki/Bark_scale,
+	   Young et al., The HTK Book, section 5.4
+
+	The Bands filters have their edges at Bands+2 points evenly spaced on the scale between the minimum and maximum
+	frequencies. Filter b rises from zero at point b to one at point b+1 and falls back to zero at point b+2. As a
+	filter only covers the bins between its edges, it is stored as the bin it starts at and the weights from there,
+	rather than as a row of a dense Bands x Bins matrix that is mostly zeros. An energy is then the dot product of the
+	weights with a contiguous run of the power spectrum, done with SSE2 two bins at a time.
+
+	Cepstrum() fuses the rest of the MFCC computation into the same pass over each frame: the energies are compressed
+	with a log as they are produced, and multiplied by the first rows of an orthonormal DCT-II matrix precomputed with
+	the filterbank.
+
+	Power spectra are one sided, FFTSize/2+1 bins, as produced by DFTAnalysis and DFTWelch.
+	Filterbanks are immutable once constructed. Use DFTFilterbank::Get() to retrieve a cached one.
+*/
+#pragma once
+#ifndef DFTFilterbank_H
+#define DFTFilterbank_H
+
+#include <vector>
+#include "Exception.h"
+
+namespace DFT{
+	class DFTFilterbank{
+	public:
+		enum Scale { Mel, Bark };
+
+	private:
+		Scale Kind;									//Frequency scale of the filters
+		double SampleRate;							//Sample rate of the signal
+		unsigned int FFTSize;						//Length of the transforms of the spectra
+		unsigned int Bands;							//Number of filters
+		double MinFrequency;						//Lower edge of the first filter in Hz
+		double MaxFrequency;						//Upper edge of the last filter in Hz
+		std::vector<unsigned int> Start;			//First bin of each filter
+		std::vector<unsigned int> Offset;			//Offset of the weights of each filter in Weights, Bands+1 entries
+		std::vector<double> Weights;				//Weights of every filter, one after the other
+		std::vector<double> Cosines;				//Orthonormal DCT-II matrix, Bands x Bands, row major
+
+		DFTFilterbank(const DFTFilterbank &);
+		DFTFilterbank &operator=(const DFTFilterbank &);
+
+	protected:
+		double Energy(const double *power, unsigned int band) const;	//Weighted sum of the bins of a filter
+
+	public:
+		//maximum defaults to the Nyquist frequency when zero
+		DFTFilterbank(Scale scale, double sampleRate, unsigned int fftSize, unsigned int bands, double minimum=0, double maximum=0);
+
+		//Energies of the Bands filters over one power spectrum of GetBins() values
+		void Apply(const double *power, double *energies) const;
+		//Energies of a stack of power spectra. Frame i starts at power + i*stride; its Bands energies are written at
+		//energies + i*Bands.
+		void ApplyBatch(const double *power, unsigned int frames, unsigned int stride, double *energies) const;
+
+		//First coefficients cepstral coefficients, i.e. the orthonormal DCT-II of log(energy + floor), of a stack of power
+		//spectra laid out as for ApplyBatch(). The coefficients of frame i are written at out + i*coefficients.
+		void Cepstrum(const double *power, unsigned int frames, unsigned int stride, unsigned int coefficients, double *out,
+			double floor=1e-10) const;
+
+		//Getters
+		Scale GetScale() const{ return Kind; }
+		double GetSampleRate() const{ return SampleRate; }
+		unsigned int GetFFTSize() const{ return FFTSize; }
+		unsigned int GetBins() const{ return FFTSize/2 + 1; }
+		unsigned int NumBands() const{ return Bands; }
+		unsigned int GetStart(unsigned int band) const{ return Start[band]; }					//First bin of a filter
+		unsigned int GetLength(unsigned int band) const{ return Offset[band+1] - Offset[band]; }	//Number of bins of a filter
+		const double *GetWeights(unsigned int band) const{ return Weights.empty() ? 0 : &Weights[0] + Offset[band]; }
+
+		//Convert between Hz and the scale
+		static double ToScale(Scale scale, double frequency);
+		static double FromScale(Scale scale, double value);
+
+		//Get a cached filterbank over the whole band from DC to the Nyquist frequency. Thread safe.
+		static const DFTFilterbank &Get(Scale scale, double sampleRate, unsigned int fftSize, unsigned int bands);
+	};
+}
+
+#endif /*DFTFilterbank_H*/
@@ -1,11 +1,89 @@
 //DFTGeneric.cpp
+#include <algorithm>
+#include <cstring>
 #include "DFTGeneric.h"
+#include "WaveMisc.h"
+#ifdef WAVE_SSE2
+#include <emmintrin.h>
+#endif
 
 using namespace std;
 namespace DFT{
+	namespace{
+		//Split n complex values step apart into real and imaginary parts. imag can be NULL.
+		template <typename T, typename U> void Deinterleave(const complex<T> *in, unsigned int step, unsigned int n, U *real, U *imag){
+			for (unsigned int i = 0; i < n; i++, in += step){
+				real[i] = U(in->real());
+				if (imag){
+					imag[i] = U(in->imag());
+				}
+			}
+		}
+		void Deinterleave(const complex<double> *in, unsigned int step, unsigned int n, double *real, double *imag){
+			const double *x = reinterpret_cast<const double*>(in);
+			step *= 2;
+			unsigned int i = 0;
+#ifdef WAVE_SSE2
+			//(re0, im0), (re1, im1) -> (re0, re1), (im0, im1)
+			if (imag){
+				for (; i + 1 < n; i += 2){
+					__m128d a = _mm_loadu_pd(x + i*step), b = _mm_loadu_pd(x + (i + 1)*step);
+					_mm_storeu_pd(real + i, _mm_unpacklo_pd(a, b));
+					_mm_storeu_pd(imag + i, _mm_unpackhi_pd(a, b));
+				}
+			}
+#endif
+			for (; i < n; i++){
+				real[i] = x[i*step];
+				if (imag){
+					imag[i] = x[i*step + 1];
+				}
+			}
+		}
+		//The reverse. A NULL imag is zeros.
+		template <typename T, typename U> void Interleave(const U *real, const U *imag, unsigned int n, complex<T> *out, unsigned int step){
+			for (unsigned int i = 0; i < n; i++, out += step){
+				*out = complex<T>(T(real[i]), imag ? T(imag[i]) : T(0));
+			}
+		}
+		void Interleave(const double *real, const double *imag, unsigned int n, complex<double> *out, unsigned int step){
+			double *x = reinterpret_cast<double*>(out);
+			step *= 2;
+			unsigned int i = 0;
+#ifdef WAVE_SSE2
+			//(re0, re1), (im0, im1) -> (re0, im0), (re1, im1)
+			for (; i + 1 < n; i += 2){
+				__m128d re = _mm_loadu_pd(real + i), im = imag ? _mm_loadu_pd(imag + i) : _mm_setzero_pd();
+				_mm_storeu_pd(x + i*step, _mm_unpacklo_pd(re, im));
+				_mm_storeu_pd(x + (i + 1)*step, _mm_unpackhi_pd(re, im));
+			}
+#endif
+			for (; i < n; i++){
+				x[i*step] = real[i];
+				x[i*step + 1] = imag ? imag[i] : 0;
+			}
+		}
+
+		//Copy n complex values, from step apart, or to step apart
+		template <typename T, typename U> void Gather(const complex<T> *in, unsigned int step, unsigned int n, complex<U> *out){
+			for (unsigned int i = 0; i < n; i++, in += step){
+				out[i] = complex<U>(U(in->real()), U(in->imag()));
+			}
+		}
+		template <typename T, typename U> void Scatter(const complex<T> *in, unsigned int n, complex<U> *out, unsigned int step){
+			for (unsigned int i = 0; i < n; i++, out += step){
+				*out = complex<U>(U(in[i].real()), U(in[i].imag()));
+			}
+		}
+
+		//The values are complex<double>, for DFTSpan()
+		template <typename T> const complex<double> *AsDouble(const complex<T> *){ return NULL; }
+		const complex<double> *AsDouble(const complex<double> *data){ return data; }
+	}
+
 	//GetOffset()
 	//Calculate the offset index based on the parameters
-	unsigned int DFTGeneric::GetOffset(unsigned int intervalN, unsigned int dimension) const{
+	template <typename T> unsigned int DFTGeneric<T>::GetOffset(unsigned int intervalN, unsigned int dimension) const{
 		return intervalN*Dimension + dimension;
 	}
 	//CreateInterval() - Recursive edition. No good
@@ -30,44 +108,260 @@ namespace DFT{
 	}
 	*/
 	//CreateInterval() - Better edition
-	void DFTGeneric::CreateInterval(unsigned int intervalN) const{
+	template <typename T> void DFTGeneric<T>::CreateInterval(unsigned int intervalN){
 		//Check if the nth interval exist. If not, create it with all the appropriate dimensions
+		if (Storage == Split){
+			if (intervalN >= Intervals){
+				//Padding is kept at zero, so new intervals within the stride are already zeros
+				if (intervalN >= Stride){
+					Restride(max(intervalN + 1, Stride + Stride/2), Dimension);
+				}
+				Intervals = intervalN + 1;
+			}
+			return;
+		}
 		unsigned offset = GetOffset(intervalN, Dimension-1);
-		if (offset >= Data.size()){
-			for (unsigned i = Data.size(); i <= offset; i++){
-				Data.push_back(complex<double>(0,0));
+		if (offset >= Data.Size()){
+			//Grows geometrically, as push_back() would, but zero fills in one go
+			Values_T &values = Data.Edit();
+			if (offset >= values.capacity()){
+				values.reserve(max<size_t>(offset + 1, values.capacity() + values.capacity()/2));
 			}
+			values.resize(offset + 1);
 		}
 	}
 
+	//Restride()
+	template <typename T> void DFTGeneric<T>::Restride(unsigned int stride, unsigned int dimensions){
+		const unsigned int lineValues = unsigned(DFT_ALIGNMENT/sizeof(T));		//Values per cache line
+		stride = (stride + lineValues - 1)/lineValues*lineValues;
+		DFTAlignedArray<T> real((size_t) stride*dimensions), imag((size_t) stride*dimensions);
+		unsigned int kept = min(Intervals, stride);
+		for (unsigned int j = 0; j < min(dimensions, Dimension) && kept; j++){
+			memcpy(real.Get() + (size_t) j*stride, Real.Get() + (size_t) j*Stride, kept*sizeof(T));
+			memcpy(imag.Get() + (size_t) j*stride, Imag.Get() + (size_t) j*Stride, kept*sizeof(T));
+		}
+		Real.Swap(real);
+		Imag.Swap(imag);
+		Stride = stride;
+		Intervals = kept;
+	}
+
 	//Get Sample
-	std::complex<double> DFTGeneric::DFTGet(unsigned int intervalN, unsigned int dimension) const{
-		//Make sure the interval exist
-		CreateInterval(intervalN);
-		return Data[GetOffset(intervalN, dimension)];
+	template <typename T> std::complex<double> DFTGeneric<T>::DFTGet(unsigned int intervalN, unsigned int dimension) const{
+		if (dimension >= Dimension){
+			throw Exception(EXCEPTION_RANGE, "Out of range access.");
+		}
+		//Past the end reads as zero, without creating anything
+		if (intervalN >= DFTNumInterval()){
+			return complex<double>(0, 0);
+		}
+		if (Storage == Split){
+			size_t offset = (size_t) dimension*Stride + intervalN;
+			return complex<double>(Real[offset], Imag[offset]);
+		}
+		const complex<T> &value = Data[GetOffset(intervalN, dimension)];
+		return complex<double>(value.real(), value.imag());
 	}
 
 	//Set sample
-	void DFTGeneric::DFTSet(unsigned int intervalN, unsigned int dimension, const std::complex<double> &data){
+	template <typename T> void DFTGeneric<T>::DFTSet(unsigned int intervalN, unsigned int dimension, const std::complex<double> &data){
+		if (dimension >= Dimension){
+			throw Exception(EXCEPTION_RANGE, "Out of range access.");
+		}
 		//Make sure the interval exist
 		CreateInterval(intervalN);
+		if (Storage == Split){
+			size_t offset = (size_t) dimension*Stride + intervalN;
+			Real[offset] = T(data.real());
+			Imag[offset] = T(data.imag());
+			return;
+		}
 		unsigned offset = GetOffset(intervalN, dimension);
-		Data[offset] = data;
+		Data.Edit()[offset] = complex<T>(T(data.real()), T(data.imag()));
+	}
+
+	/**********
+		Bulk access
+	**********/
+	//GetRange()
+	template <typename T> template <typename U> void DFTGeneric<T>::GetRange(unsigned int dimension, unsigned int first, unsigned int count, complex<U> *out) const{
+		if (dimension >= Dimension){
+			throw Exception(EXCEPTION_RANGE, "Out of range access.");
+		}
+		//What is stored, then zeros
+		unsigned int intervals = DFTNumInterval();
+		unsigned int stored = (first < intervals) ? min(count, intervals - first) : 0;
+		if (stored){
+			if (Storage == Split){
+				Interleave(GetReal(dimension) + first, GetImag(dimension) + first, stored, out, 1);
+			}
+			else{
+				Gather(&Data[GetOffset(first, dimension)], Dimension, stored, out);
+			}
+		}
+		fill(out + stored, out + count, complex<U>(0, 0));
+	}
+
+	//GetSplit()
+	template <typename T> template <typename U> void DFTGeneric<T>::GetSplit(unsigned int dimension, unsigned int first, unsigned int count, U *real, U *imag) const{
+		if (dimension >= Dimension){
+			throw Exception(EXCEPTION_RANGE, "Out of range access.");
+		}
+		unsigned int intervals = DFTNumInterval();
+		unsigned int stored = (first < intervals) ? min(count, intervals - first) : 0;
+		if (stored){
+			if (Storage == Split){
+				copy(GetReal(dimension) + first, GetReal(dimension) + first + stored, real);
+				if (imag){
+					copy(GetImag(dimension) + first, GetImag(dimension) + first + stored, imag);
+				}
+			}
+			else{
+				Deinterleave(&Data[GetOffset(first, dimension)], Dimension, stored, real, imag);
+			}
+		}
+		fill(real + stored, real + count, U(0));
+		if (imag){
+			fill(imag + stored, imag + count, U(0));
+		}
+	}
+
+	//SetRange()
+	template <typename T> template <typename U> void DFTGeneric<T>::SetRange(unsigned int dimension, unsigned int first, unsigned int count, const complex<U> *in){
+		if (dimension >= Dimension){
+			throw Exception(EXCEPTION_RANGE, "Out of range access.");
+		}
+		if (!count){
+			return;
+		}
+		CreateInterval(first + count - 1);
+		if (Storage == Split){
+			Deinterleave(in, 1, count, GetReal(dimension) + first, GetImag(dimension) + first);
+			return;
+		}
+		Scatter(in, count, &Data.Edit()[GetOffset(first, dimension)], Dimension);
+	}
+
+	//SetSplit()
+	template <typename T> template <typename U> void DFTGeneric<T>::SetSplit(unsigned int dimension, unsigned int first, unsigned int count, const U *real, const U *imag){
+		if (dimension >= Dimension){
+			throw Exception(EXCEPTION_RANGE, "Out of range access.");
+		}
+		if (!count){
+			return;
+		}
+		CreateInterval(first + count - 1);
+		if (Storage == Split){
+			copy(real, real + count, GetReal(dimension) + first);
+			if (imag){
+				copy(imag, imag + count, GetImag(dimension) + first);
+			}
+			else{
+				fill(GetImag(dimension) + first, GetImag(dimension) + first + count, T(0));
+			}
+			return;
+		}
+		Interleave(real, imag, count, &Data.Edit()[GetOffset(first, dimension)], Dimension);
+	}
+
+	//DFTGetRange()
+	template <typename T> void DFTGeneric<T>::DFTGetRange(unsigned int dimension, unsigned int first, unsigned int count, complex<double> *out) const{
+		GetRange(dimension, first, count, out);
+	}
+	//DFTGetSplit()
+	template <typename T> void DFTGeneric<T>::DFTGetSplit(unsigned int dimension, unsigned int first, unsigned int count, double *real, double *imag) const{
+		GetSplit(dimension, first, count, real, imag);
+	}
+	//DFTSetRange()
+	template <typename T> void DFTGeneric<T>::DFTSetRange(unsigned int dimension, unsigned int first, unsigned int count, const complex<double> *in){
+		SetRange(dimension, first, count, in);
+	}
+	//DFTSetSplit()
+	template <typename T> void DFTGeneric<T>::DFTSetSplit(unsigned int dimension, unsigned int first, unsigned int count, const double *real, const double *imag){
+		SetSplit(dimension, first, count, real, imag);
+	}
+	//DFTGetRangeFloat()
+	template <typename T> void DFTGeneric<T>::DFTGetRangeFloat(unsigned int dimension, unsigned int first, unsigned int count, complex<float> *out) const{
+		GetRange(dimension, first, count, out);
+	}
+	//DFTGetSplitFloat()
+	template <typename T> void DFTGeneric<T>::DFTGetSplitFloat(unsigned int dimension, unsigned int first, unsigned int count, float *real, float *imag) const{
+		GetSplit(dimension, first, count, real, imag);
+	}
+	//DFTSetRangeFloat()
+	template <typename T> void DFTGeneric<T>::DFTSetRangeFloat(unsigned int dimension, unsigned int first, unsigned int count, const complex<float> *in){
+		SetRange(dimension, first, count, in);
+	}
+	//DFTSetSplitFloat()
+	template <typename T> void DFTGeneric<T>::DFTSetSplitFloat(unsigned int dimension, unsigned int first, unsigned int count, const float *real, const float *imag){
+		SetSplit(dimension, first, count, real, imag);
+	}
+
+	//DFTSpan()
+	template <typename T> const std::complex<double> *DFTGeneric<T>::DFTSpan(unsigned int dimension, unsigned int &stride) const{
+		if (Storage == Split || dimension >= Dimension || Data.IsEmpty()){
+			return NULL;
+		}
+		stride = Dimension;
+		return AsDouble(&Data[dimension]);
+	}
+
+	//SetLayout()
+	template <typename T> void DFTGeneric<T>::SetLayout(Layout layout){
+		if (layout == Storage){
+			return;
+		}
+		if (layout == Split){
+			unsigned int intervals = DFTNumInterval();
+			Intervals = 0;
+			Stride = 0;
+			Restride(intervals, Dimension);
+			Intervals = intervals;
+			for (unsigned int j = 0; j < Dimension && intervals; j++){
+				Deinterleave(&Data[j], Dimension, intervals, Real.Get() + (size_t) j*Stride, Imag.Get() + (size_t) j*Stride);
+			}
+			Data.Clear();
+		}
+		else{
+			Values_T &values = Data.Edit();
+			values.resize((size_t) Intervals*Dimension);
+			for (unsigned int j = 0; j < Dimension && Intervals; j++){
+				Interleave(Real.Get() + (size_t) j*Stride, Imag.Get() + (size_t) j*Stride, Intervals, &values[j], Dimension);
+			}
+			Real.Assign(0);
+			Imag.Assign(0);
+			Intervals = 0;
+			Stride = 0;
+		}
+		Storage = layout;
 	}
 
 	//Properties Changer
 	//Change number of intervals
-	void DFTGeneric::DFTSetNumInterval(unsigned int n){
+	template <typename T> void DFTGeneric<T>::DFTSetNumInterval(unsigned int n){
 		if (!n){
 			throw Exception(EXCEPTION_DATA_INVALID, "Number cannot be zero!");
 		}
 		if (n == DFTNumInterval()){
 			return;
 		}
-		Data.resize(n*Dimension);
+		if (Storage == Split){
+			if (n > Stride){
+				Restride(n, Dimension);
+			}
+			//Keep the padding at zero
+			for (unsigned int j = 0; j < Dimension && n < Intervals; j++){
+				fill(GetReal(j) + n, GetReal(j) + Intervals, T(0));
+				fill(GetImag(j) + n, GetImag(j) + Intervals, T(0));
+			}
+			Intervals = n;
+			return;
+		}
+		Data.Edit().resize(n*Dimension);
 	}
 	//Change Number of Dimensions.
-	void DFTGeneric::DFTSetDimension(unsigned int n){
+	template <typename T> void DFTGeneric<T>::DFTSetDimension(unsigned int n){
 		//This is a pain in the arse operation.
 		if (!n){
 			throw Exception(EXCEPTION_DATA_INVALID, "Number cannot be zero!");
@@ -75,8 +369,17 @@ namespace DFT{
 		if (n == Dimension){
 			return;
 		}
-		Data.resize(DFTNumInterval()*n);
+		if (Storage == Split){
+			//Dimensions are apart, so the ones kept keep their values
+			Restride(Stride, n);
+			Dimension = n;
+			return;
+		}
+		Data.Edit().resize(DFTNumInterval()*n);
 		Dimension = n;
 	}
-
+	//Instantiations
+	template class DFTGeneric<float>;
+	template class DFTGeneric<double>;
+	template class DFTGeneric<long double>;
 }
\ No newline at end of file
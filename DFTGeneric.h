@@ -8,6 +8,21 @@
 	These classes are in a diamond shaped inheritance. 
 	See http://www.parashift.com/c++-faq-lite/multiple-inheritance.html
 	for more details on the specifics of the care needed for their implementation
+
+	Values are stored in one of two layouts:
+	 - Interleaved: complex values, interval after interval, each with its Dimension values. The default.
+	 - Split: dimension after dimension, each as an array of real parts and an array of imaginary parts, Stride values
+	   apart. Arrays start on a cache line and Stride is a multiple of a cache line, padded with zeros, so that a
+	   kernel working on one dimension streams unit stride data with aligned SIMD loads, and Matlab style column major
+	   split matrices are copied with memcpy. Stride grows geometrically as intervals are created one at a time.
+	SetLayout() converts between the two, two values at a time with SSE2.
+	Either way, the memory comes from DFTPool. Interleaved values are shared by copies of the object until one of
+	them writes, cf DFTShared; split arrays are copied.
+
+	The classes are templates over the type of the real and imaginary parts, double by default, instantiated for
+	float, double and long double. DFTGenericTime and DFTGenericFrequency hold doubles, DFTGenericTimeFloat and
+	DFTGenericFrequencyFloat floats, 8 bytes per value instead of 16. The DFTData interface stays double; the
+	...Float bulk methods move floats to and from a float object without widening them.
 */
 #pragma once
 #ifndef DFTGeneric_H
@@ -17,33 +32,60 @@
 #pragma warning( disable : 4250 )
 
 #include "DFTData.h"
+#include "DFTAligned.h"
+#include "DFTShared.h"
 #include "Exception.h"
 #include <vector>
 
 namespace DFT{
 
 	/************** DFTGeneric ******************/
-	class DFTGeneric: public virtual DFTData{
+	template <typename T=double> class DFTGeneric: public virtual DFTData{
+	public:
+		enum Layout { Interleaved, Split };
+
+	private:
+		typedef typename DFTShared<std::complex<T> >::Vector_T Values_T;
+
 		unsigned int Dimension;				//The number of dimensions
 		double Interval;					//Interval between samples
-		mutable std::vector<complex<double> > Data;		//The data
+		Layout Storage;						//How the data is stored
+		DFTShared<std::complex<T> > Data;		//The data, Interleaved. Shared by copies until written.
+
+		//Split
+		unsigned int Intervals;				//Number of intervals
+		unsigned int Stride;				//Values between the starts of two dimensions
+		DFTAlignedArray<T> Real;			//Real parts, dimension after dimension
+		DFTAlignedArray<T> Imag;			//Imaginary parts, likewise
+
+		//Bulk access, whatever the precision of the caller
+		template <typename U> void GetRange(unsigned int dimension, unsigned int first, unsigned int count, std::complex<U> *out) const;
+		template <typename U> void GetSplit(unsigned int dimension, unsigned int first, unsigned int count, U *real, U *imag) const;
+		template <typename U> void SetRange(unsigned int dimension, unsigned int first, unsigned int count, const std::complex<U> *in);
+		template <typename U> void SetSplit(unsigned int dimension, unsigned int first, unsigned int count, const U *real, const U *imag);
 
 	protected: //Protected internal methods
 		unsigned int GetOffset(unsigned int intervalN, unsigned int dimension) const;		//Get the offset based on the param
-		void CreateInterval(unsigned int intervalN) const;									//Create the interval.
+		void CreateInterval(unsigned int intervalN);									//Create the interval.
+		void Restride(unsigned int stride, unsigned int dimensions);					//Split: move to a new stride and number of dimensions
 
 	public:
 		//Construct the object.
 		//n is the number of dimensions, interval is the interval.
 		//Size is the projected number of samples. This is so that memory for the data structure can be allocated accordingly.
 		//If not set, will not do any allocation
-		DFTGeneric(unsigned int n=1, double interval = 1.0, unsigned int size=0): Dimension(n), Interval(interval) {
+		DFTGeneric(unsigned int n=1, double interval = 1.0, unsigned int size=0, Layout layout=Interleaved)
+			: Dimension(n), Interval(interval), Storage(layout), Intervals(0), Stride(0) {
 			if (Dimension == 0 || Interval <= 0){
 				throw Exception(EXCEPTION_DATA_INVALID, "Dimension and/or interval cannot <= zero!");
 			}
 			if (size){
-				Data.reserve(size);
-				Data.clear();		//Irritating problem with reserve creating element zero
+				if (Storage == Split){
+					Restride((size + Dimension - 1)/Dimension, Dimension);
+				}
+				else{
+					Data.Edit().reserve(size);
+				}
 			}
 		}
 		//Virtual destructor
@@ -52,8 +94,8 @@ namespace DFT{
 		//Properties Getter
 		unsigned int DFTDimension() const{ return Dimension; }				//Return the number of dimensions
 		double DFTInterval() const{ return Interval; }						//Returns the interval
-		unsigned int DFTSample() const{ return Data.size(); }					//Returns number of discrete samples
-		unsigned int DFTNumInterval() const{ return Data.size()/Dimension; }	//Returns number of intervals
+		unsigned int DFTSample() const{ return DFTNumInterval()*Dimension; }	//Returns number of discrete samples
+		unsigned int DFTNumInterval() const{ return (Storage == Split) ? Intervals : unsigned(Data.Size()/Dimension); }	//Returns number of intervals
 
 		//Properties Setter
 		void DFTSetInterval(double n){								//Set interval
@@ -65,24 +107,56 @@ namespace DFT{
 		void DFTSetDimension(unsigned int n);			//Set Number of dimensions - note this operation will render existing data invalid
 		void DFTSetNumInterval(unsigned int n);			//Set number of intervals
 
-		//Samples getter and setter
+		//Samples getter and setter. Intervals past the end read as zeros and are created by the setter. The getters
+		//change nothing, so that threads may read at once, while none writes.
 		std::complex<double> DFTGet(unsigned int intervalN, unsigned int dimension) const;					//Get sample
 		void DFTSet(unsigned int intervalN, unsigned int dimension, const std::complex<double> &data);		//Set sample
 
+		//Bulk access. Intervals are stored one after the other, each with its Dimension values, so a dimension is a
+		//strided span of the data; with a single dimension, copies are contiguous. Intervals past the end read as zeros
+		//and are created by the setters, as for DFTGet() and DFTSet().
+		void DFTGetRange(unsigned int dimension, unsigned int first, unsigned int count, std::complex<double> *out) const;
+		void DFTGetSplit(unsigned int dimension, unsigned int first, unsigned int count, double *real, double *imag) const;
+		void DFTSetRange(unsigned int dimension, unsigned int first, unsigned int count, const std::complex<double> *in);
+		void DFTSetSplit(unsigned int dimension, unsigned int first, unsigned int count, const double *real, const double *imag);
+		void DFTGetRangeFloat(unsigned int dimension, unsigned int first, unsigned int count, std::complex<float> *out) const;
+		void DFTGetSplitFloat(unsigned int dimension, unsigned int first, unsigned int count, float *real, float *imag) const;
+		void DFTSetRangeFloat(unsigned int dimension, unsigned int first, unsigned int count, const std::complex<float> *in);
+		void DFTSetSplitFloat(unsigned int dimension, unsigned int first, unsigned int count, const float *real, const float *imag);
+		const std::complex<double> *DFTSpan(unsigned int dimension, unsigned int &stride) const;		//NULL unless T is double
+
+		//Layout
+		Layout GetLayout() const{ return Storage; }
+		void SetLayout(Layout layout);			//Convert the data to the layout
+		//Split: the real and imaginary parts of a dimension, DFTNumInterval() values followed by zeros up to GetStride(),
+		//on a cache line. NULL when Interleaved.
+		unsigned int GetStride() const{ return Stride; }
+		T *GetReal(unsigned int dimension){ return (Storage == Split) ? Real.Get() + (size_t) dimension*Stride : NULL; }
+		T *GetImag(unsigned int dimension){ return (Storage == Split) ? Imag.Get() + (size_t) dimension*Stride : NULL; }
+		const T *GetReal(unsigned int dimension) const{ return (Storage == Split) ? Real.Get() + (size_t) dimension*Stride : NULL; }
+		const T *GetImag(unsigned int dimension) const{ return (Storage == Split) ? Imag.Get() + (size_t) dimension*Stride : NULL; }
+
 	};
 
 	/************** DFTGenericTime *************/
-	class DFTGenericTime: public DFTGeneric, public DFTTime{ 
+	template <typename T=double> class DFTGenericTimeOf: public DFTGeneric<T>, public DFTTime{
 	public:
 		//Constructor
-		DFTGenericTime(unsigned int n=1, double interval = 1, unsigned int size=0): DFTGeneric(n, interval, size) { }
+		DFTGenericTimeOf(unsigned int n=1, double interval = 1, unsigned int size=0, typename DFTGeneric<T>::Layout layout=DFTGeneric<T>::Interleaved)
+			: DFTGeneric<T>(n, interval, size, layout) { }
 	};
 	/************** DFTGenericFrequency ********/
-	class DFTGenericFrequency: public DFTGeneric, public DFTFrequency{ 
+	template <typename T=double> class DFTGenericFrequencyOf: public DFTGeneric<T>, public DFTFrequency{
 	public:
 		//Constructor
-		DFTGenericFrequency(unsigned int n=1, double interval = 1, unsigned int size=0): DFTGeneric(n,interval, size) { }
+		DFTGenericFrequencyOf(unsigned int n=1, double interval = 1, unsigned int size=0, typename DFTGeneric<T>::Layout layout=DFTGeneric<T>::Interleaved)
+			: DFTGeneric<T>(n, interval, size, layout) { }
 	};
+
+	typedef DFTGenericTimeOf<double> DFTGenericTime;
+	typedef DFTGenericTimeOf<float> DFTGenericTimeFloat;
+	typedef DFTGenericFrequencyOf<double> DFTGenericFrequency;
+	typedef DFTGenericFrequencyOf<float> DFTGenericFrequencyFloat;
 }
 
 #endif /*DFTGeneric_H*/
\ No newline at end of file
@@ -0,0 +1,145 @@
+//DFTHalfSpectrum.cpp
+#include <algorithm>
+#include "DFTHalfSpectrum.h"
+
+using namespace std;
+namespace DFT{
+	//Constructor
+	DFTHalfSpectrum::DFTHalfSpectrum(unsigned int n, double interval, unsigned int intervals)
+		: Bins(n, vector<complex<double> >(StoredBins(intervals))), Intervals(intervals), Interval(interval){
+		if (!n || interval <= 0){
+			throw Exception(EXCEPTION_DATA_INVALID, "Dimension and/or interval cannot <= zero!");
+		}
+	}
+
+	//Check()
+	void DFTHalfSpectrum::Check(unsigned int intervalN, unsigned int dimension) const{
+		if (intervalN >= Intervals || dimension >= Bins.size()){
+			throw Exception(EXCEPTION_RANGE, "Out of range access.");
+		}
+	}
+
+	//DFTSetInterval()
+	void DFTHalfSpectrum::DFTSetInterval(double n){
+		if (n <= 0){
+			throw Exception(EXCEPTION_DATA_INVALID, "Interval cannot <= zero!");
+		}
+		Interval = n;
+	}
+
+	//DFTSetDimension()
+	void DFTHalfSpectrum::DFTSetDimension(unsigned int n){
+		if (!n){
+			throw Exception(EXCEPTION_DATA_INVALID, "Number cannot be zero!");
+		}
+		Bins.resize(n, vector<complex<double> >(StoredBins(Intervals)));
+	}
+
+	//DFTSetNumInterval()
+	void DFTHalfSpectrum::DFTSetNumInterval(unsigned int n){
+		for (unsigned int j = 0; j < Bins.size(); j++){
+			Bins[j].resize(StoredBins(n));
+		}
+		Intervals = n;
+	}
+
+	//DFTGet()
+	complex<double> DFTHalfSpectrum::DFTGet(unsigned int intervalN, unsigned int dimension) const{
+		Check(intervalN, dimension);
+		if (intervalN <= Intervals/2){
+			return Bins[dimension][intervalN];
+		}
+		return conj(Bins[dimension][Intervals - intervalN]);
+	}
+
+	//DFTSet()
+	void DFTHalfSpectrum::DFTSet(unsigned int intervalN, unsigned int dimension, const complex<double> &data){
+		Check(intervalN, dimension);
+		if (intervalN <= Intervals/2){
+			Bins[dimension][intervalN] = data;
+		}
+		else{
+			Bins[dimension][Intervals - intervalN] = conj(data);
+		}
+	}
+
+	//DFTGetRange()
+	void DFTHalfSpectrum::DFTGetRange(unsigned int dimension, unsigned int first, unsigned int count, complex<double> *out) const{
+		if (!count){
+			return;
+		}
+		Check(first + count - 1, dimension);
+		const complex<double> *bins = &Bins[dimension][0];
+		unsigned int half = Intervals/2, i = 0;
+		for (; i < count && first + i <= half; i++){
+			out[i] = bins[first + i];
+		}
+		for (; i < count; i++){
+			out[i] = conj(bins[Intervals - first - i]);
+		}
+	}
+
+	//DFTGetSplit()
+	void DFTHalfSpectrum::DFTGetSplit(unsigned int dimension, unsigned int first, unsigned int count, double *real, double *imag) const{
+		if (!count){
+			return;
+		}
+		Check(first + count - 1, dimension);
+		const complex<double> *bins = &Bins[dimension][0];
+		unsigned int half = Intervals/2, i = 0;
+		for (; i < count && first + i <= half; i++){
+			real[i] = bins[first + i].real();
+			if (imag){
+				imag[i] = bins[first + i].imag();
+			}
+		}
+		for (; i < count; i++){
+			real[i] = bins[Intervals - first - i].real();
+			if (imag){
+				imag[i] = -bins[Intervals - first - i].imag();
+			}
+		}
+	}
+
+	//DFTSetRange()
+	void DFTHalfSpectrum::DFTSetRange(unsigned int dimension, unsigned int first, unsigned int count, const complex<double> *in){
+		if (!count){
+			return;
+		}
+		Check(first + count - 1, dimension);
+		complex<double> *bins = &Bins[dimension][0];
+		unsigned int half = Intervals/2, i = 0;
+		for (; i < count && first + i <= half; i++){
+			bins[first + i] = in[i];
+		}
+		for (; i < count; i++){
+			bins[Intervals - first - i] = conj(in[i]);
+		}
+	}
+
+	//DFTSetSplit()
+	void DFTHalfSpectrum::DFTSetSplit(unsigned int dimension, unsigned int first, unsigned int count, const double *real, const double *imag){
+		if (!count){
+			return;
+		}
+		Check(first + count - 1, dimension);
+		complex<double> *bins = &Bins[dimension][0];
+		unsigned int half = Intervals/2, i = 0;
+		for (; i < count && first + i <= half; i++){
+			bins[first + i] = complex<double>(real[i], imag ? imag[i] : 0);
+		}
+		for (; i < count; i++){
+			bins[Intervals - first - i] = complex<double>(real[i], imag ? -imag[i] : 0);
+		}
+	}
+
+	//GetBins()
+	complex<double> *DFTHalfSpectrum::GetBins(unsigned int dimension){
+		Check(0, dimension);
+		return &Bins[dimension][0];
+	}
+	const complex<double> *DFTHalfSpectrum::GetBins(unsigned int dimension) const{
+		Check(0, dimension);
+		return &Bins[dimension][0];
+	}
+}
@@ -0,0 +1,67 @@
+/*
+	DFTHalfSpectrum
+
+	A frequency domain container for the spectra of real signals. Such a spectrum is conjugate symmetric,
+	X[N-k] = conj(X[k]), so only bins 0 to N/2 of the N intervals are stored, dimension after dimension, and the
+	upper half is served by conjugating its mirror. Writing a bin of the upper half writes the conjugate into its
+	mirror, so that engines writing the whole spectrum still work, but engines that check DFTIsHermitian() only
+	write the N/2+1 bins they compute.
+
+	Bins 0 and, for even N, N/2 are their own mirror and should be real; this is not enforced.
+	Unlike DFTGeneric, intervals are not created on access: set the number of intervals first, as the transforms
+	and CopyData() do. Accesses past the end throw EXCEPTION_RANGE.
+*/
+#pragma once
+#ifndef DFTHalfSpectrum_H
+#define DFTHalfSpectrum_H
+
+#include <vector>
+#include <complex>
+#include "DFTData.h"
+#include "Exception.h"
+
+namespace DFT{
+	class DFTHalfSpectrum: public DFTFrequency{
+		std::vector<std::vector<std::complex<double> > > Bins;	//Bins 0 to N/2, per dimension
+		unsigned int Intervals;									//N
+		double Interval;										//Frequency interval between bins
+
+	protected:
+		void Check(unsigned int intervalN, unsigned int dimension) const;
+
+	public:
+		//n is the number of dimensions, intervals the number of intervals N of the whole spectrum
+		DFTHalfSpectrum(unsigned int n=1, double interval=1.0, unsigned int intervals=0);
+
+		//Number of bins stored for N intervals
+		static unsigned int StoredBins(unsigned int intervals){ return intervals ? intervals/2 + 1 : 0; }
+
+		//Properties Getter
+		unsigned int DFTDimension() const{ return unsigned(Bins.size()); }
+		unsigned int DFTSample() const{ return Intervals*DFTDimension(); }
+		unsigned int DFTNumInterval() const{ return Intervals; }
+		double DFTInterval() const{ return Interval; }
+		bool DFTIsHermitian() const{ return true; }
+
+		//Properties Setter
+		void DFTSetInterval(double n);
+		void DFTSetDimension(unsigned int n);			//Dimensions kept keep their bins
+		void DFTSetNumInterval(unsigned int n);		//Bins kept keep their values
+
+		//Samples getter and setter
+		std::complex<double> DFTGet(unsigned int intervalN, unsigned int dimension) const;
+		void DFTSet(unsigned int intervalN, unsigned int dimension, const std::complex<double> &data);
+
+		//Bulk access
+		void DFTGetRange(unsigned int dimension, unsigned int first, unsigned int count, std::complex<double> *out) const;
+		void DFTGetSplit(unsigned int dimension, unsigned int first, unsigned int count, double *real, double *imag) const;
+		void DFTSetRange(unsigned int dimension, unsigned int first, unsigned int count, const std::complex<double> *in);
+		void DFTSetSplit(unsigned int dimension, unsigned int first, unsigned int count, const double *real, const double *imag);
+
+		//The StoredBins() bins of a dimension
+		std::complex<double> *GetBins(unsigned int dimension);
+		const std::complex<double> *GetBins(unsigned int dimension) const;
+	};
+}
+
+#endif /*DFTHalfSpectrum_H*/
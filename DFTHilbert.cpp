@@ -0,0 +1,189 @@
+//DFTHilbert.cpp
+#include <cmath>
+#include <algorithm>
+#include "DFTHilbert.h"
+
+using namespace std;
+namespace DFT{
+	//Constructor
+	DFTHilbert::DFTHilbert(unsigned int blockSize, unsigned int margin)
+		: BlockSize(blockSize), Margin(margin), Plan(NULL), Channels(0), Filled(0), First(true), Emitted(0){
+		if (!blockSize || blockSize <= 2*margin){
+			throw Exception(EXCEPTION_DATA_INVALID, "Block must be longer than twice the margin!");
+		}
+		Plan = &DFTPlan::Get(blockSize);
+		Buffer.resize(blockSize);
+	}
+
+	//Transform()
+	void DFTHilbert::Transform(const DFTPlan &plan, complex<double> *buffer){
+		unsigned int n = plan.GetSize();
+		//Half spectrum over the samples
+		plan.ForwardReal(reinterpret_cast<const double*>(buffer), buffer);
+		//Double the positive frequencies. DC and, for even lengths, the Nyquist frequency are shared with the negative
+		//frequencies and stay as they are.
+		unsigned int negative = n/2 + 1;
+		for (unsigned int k = 1; k < (n + 1)/2; k++){
+			buffer[k] *= 2;
+		}
+		for (unsigned int k = negative; k < n; k++){
+			buffer[k] = 0;
+		}
+		plan.Inverse(buffer);
+	}
+
+	//Emit()
+	void DFTHilbert::Emit(unsigned int begin, unsigned int end, vector<complex<double> > &out){
+		size_t base = out.size();
+		out.resize(base + (end - begin)*Channels);
+		double *samples = reinterpret_cast<double*>(&Buffer[0]);
+		for (unsigned int c = 0; c < Channels; c++){
+			const double *input = &Input[c*BlockSize];
+			copy(input, input + BlockSize, samples);
+			Transform(*Plan, &Buffer[0]);
+			for (unsigned int i = begin; i < end; i++){
+				out[base + (i - begin)*Channels + c] = Buffer[i];
+			}
+		}
+		Emitted += end - begin;
+	}
+
+	//Reset()
+	void DFTHilbert::Reset(unsigned int channels){
+		if (!channels){
+			throw Exception(EXCEPTION_DATA_INVALID, "Channels cannot be zero!");
+		}
+		Channels = channels;
+		Input.assign(Channels*BlockSize, 0);
+		Filled = 0;
+		First = true;
+		Emitted = 0;
+	}
+
+	//Push()
+	unsigned int DFTHilbert::Push(const double *data, unsigned int blocks, vector<complex<double> > &out){
+		if (!Channels){
+			throw Exception(EXCEPTION_INITIALISATION, "Transform has not been reset for a signal.");
+		}
+		out.clear();
+		unsigned int consumed = 0;
+		while (consumed < blocks){
+			unsigned int n = min(blocks - consumed, BlockSize - Filled);
+			//De-interleave
+			for (unsigned int c = 0; c < Channels; c++){
+				double *input = &Input[c*BlockSize + Filled];
+				for (unsigned int i = 0; i < n; i++){
+					input[i] = data[(consumed + i)*Channels + c];
+				}
+			}
+			Filled += n;
+			consumed += n;
+			if (Filled == BlockSize){
+				Emit(First ? 0 : Margin, BlockSize - Margin, out);
+				//The next block starts with the last 2*Margin samples: the Margin samples not kept, and the Margin before them
+				for (unsigned int c = 0; c < Channels; c++){
+					double *input = &Input[c*BlockSize];
+					copy(input + BlockSize - 2*Margin, input + BlockSize, input);
+				}
+				Filled = 2*Margin;
+				First = false;
+			}
+		}
+		return unsigned(out.size()/Channels);
+	}
+
+	//Flush()
+	unsigned int DFTHilbert::Flush(vector<complex<double> > &out){
+		out.clear();
+		unsigned int begin = First ? 0 : Margin;
+		if (Channels && Filled > begin){
+			for (unsigned int c = 0; c < Channels; c++){
+				fill(Input.begin() + c*BlockSize + Filled, Input.begin() + (c + 1)*BlockSize, 0.0);
+			}
+			Emit(begin, Filled, out);
+		}
+		Filled = 0;
+		First = true;
+		return Channels ? unsigned(out.size()/Channels) : 0;
+	}
+
+	//Envelope()
+	void DFTHilbert::Envelope(Wave::WaveFile &wave, Wave::WaveWriter &writer){
+		if (writer.NumChannels() != wave.NumChannels()){
+			throw Exception(EXCEPTION_DATA_INVALID, "Writer does not have the channels of the file.");
+		}
+		Reset(wave.NumChannels());
+		vector<double> chunk(BlockSize*Channels), envelope;
+		vector<complex<double> > analytic;
+		unsigned int blocks;
+		bool end = false;
+		wave.DataRewind();
+		while (!end){
+			blocks = wave.DataNextBlocks(&chunk[0], BlockSize);
+			unsigned int n;
+			if (blocks){
+				n = Push(&chunk[0], blocks, analytic);
+			}
+			else{
+				n = Flush(analytic);
+				end = true;
+			}
+			envelope.resize(n*Channels);
+			for (unsigned int i = 0; i < n*Channels; i++){
+				envelope[i] = abs(analytic[i]);
+			}
+			if (n){
+				writer.Write(&envelope[0], n);
+			}
+		}
+	}
+
+	//Analytic() - DFTTime
+	void DFTHilbert::Analytic(const DFTTime &in, DFTData &out){
+		unsigned int n = in.DFTNumInterval(), dimension = in.DFTDimension();
+		//We might have to change the dimensions and intervaln of the output - be sure to catch exceptions
+		if (dimension != out.DFTDimension()){
+			out.DFTSetDimension(dimension);
+		}
+		if (n != out.DFTNumInterval()){
+			out.DFTSetNumInterval(n);
+		}
+		if (in.DFTInterval() != out.DFTInterval()){
+			out.DFTSetInterval(in.DFTInterval());
+		}
+		if (!n){
+			return;
+		}
+		const DFTPlan &plan = DFTPlan::Get(n);
+		vector<complex<double> > buffer(n);
+		double *samples = reinterpret_cast<double*>(&buffer[0]);
+		for (unsigned int j = 0; j < dimension; j++){
+			in.DFTGetSplit(j, 0, n, samples, NULL);
+			Transform(plan, &buffer[0]);
+			for (unsigned int i = 0; i < n; i++){
+				out.DFTSet(i, j, buffer[i]);
+			}
+		}
+	}
+
+	//Analytic() - Samples
+	void DFTHilbert::Analytic(const double *in, unsigned int n, complex<double> *out){
+		if (!n){
+			return;
+		}
+		copy(in, in + n, reinterpret_cast<double*>(out));
+		Transform(DFTPlan::Get(n), out);
+	}
+
+	//Frequency()
+	void DFTHilbert::Frequency(const complex<double> *analytic, unsigned int count, unsigned int stride, double sampleRate,
+		complex<double> &previous, double *frequency){
+		const double scale = sampleRate/(2*PI);
+		for (unsigned int i = 0; i < count; i++){
+			const complex<double> &z = analytic[i*stride];
+			//Phase of z against the previous sample, no unwrapping needed
+			frequency[i] = arg(z*conj(previous))*scale;
+			previous = z;
+		}
+	}
+}
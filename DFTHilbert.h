@@ -0,0 +1,88 @@
+/*
+	Analytic Signal
+
+	DFTHilbert
+	The analytic signal x + i H{x} of a real signal, from which the amplitude envelope |x + i H{x}| and the
+	instantaneous frequency (the rate of change of its phase) follow.
+	cf http://en.wikipedia.org/wiki/Analytic_signal#Discrete-time_analytic_signal, Marple, "Computing the discrete-time
+	"analytic" signal via FFT", IEEE Trans. Signal Processing 47(9), 1999
+
+	The analytic signal of N samples is computed as Matlab's hilbert() does: one forward real transform, the positive
+	frequencies doubled and the negative ones cleared, and one inverse complex transform. The three steps work in a
+	single buffer of N complex values: the samples are written into it as doubles, the real transform runs in place and
+	the masked half spectrum is inverted where it lies. Analytic() does this for each channel of a DFTTime object.
+
+	Files too large for one transform are streamed in overlapping blocks: every block of BlockSize samples is
+	transformed on its own and only its centre, Margin samples away from either end, is kept; the next block starts
+	2*Margin samples before the end of the previous one. The kernel of the Hilbert transform decays as 1/n, so the
+	difference to a whole signal transform falls with the margin. Both versions are approximate at the very ends of the
+	signal, where the whole signal transform wraps around and the streamed one sees zeros.
+*/
+#pragma once
+#ifndef DFTHilbert_H
+#define DFTHilbert_H
+
+#include <vector>
+#include <complex>
+#include "DFTData.h"
+#include "DFTPlan.h"
+#include "DFTUtility.h"
+#include "WaveFile.h"
+#include "WaveWriter.h"
+
+namespace DFT{
+	class DFTHilbert{
+		unsigned int BlockSize;					//Samples per transform
+		unsigned int Margin;					//Samples discarded at each inner end of a block
+		const DFTPlan *Plan;					//Cached transform plan
+
+		unsigned int Channels;					//Number of channels
+		std::vector<double> Input;				//Samples of the current block. Channel major, BlockSize per channel
+		unsigned int Filled;					//Number of samples per channel in Input
+		bool First;								//Whether the current block starts the signal, which is kept from its start
+		unsigned long long Emitted;				//Samples per channel produced
+
+		std::vector<std::complex<double> > Buffer;	//Scratch space
+
+	protected:
+		//Analytic signal of Buffer, whose first n doubles hold the samples, in place. Plan is the plan for n.
+		static void Transform(const DFTPlan &plan, std::complex<double> *buffer);
+		//Transform the current block and append samples [begin, end) of it to out, interleaved by channel
+		void Emit(unsigned int begin, unsigned int end, std::vector<std::complex<double> > &out);
+
+	public:
+		//blockSize is the transform length used for streaming and must be more than twice the margin
+		DFTHilbert(unsigned int blockSize=16384, unsigned int margin=2048);
+
+		//Get ready for a signal with the number of channels
+		void Reset(unsigned int channels);
+
+		//Add blocks of samples, interleaved by channel. The analytic samples completed by these blocks, interleaved by
+		//channel as well, replace the content of out. Returns their number per channel.
+		unsigned int Push(const double *data, unsigned int blocks, std::vector<std::complex<double> > &out);
+		//End of the signal. The remaining analytic samples replace the content of out. Returns their number per channel.
+		unsigned int Flush(std::vector<std::complex<double> > &out);
+
+		//Stream the data chunk of the wave file and write the amplitude envelope of every channel to the writer,
+		//which must be open with as many channels
+		void Envelope(Wave::WaveFile &wave, Wave::WaveWriter &writer);
+
+		//Getters
+		unsigned int GetBlockSize() const{ return BlockSize; }
+		unsigned int GetMargin() const{ return Margin; }
+		unsigned long long NumSamples() const{ return Emitted; }		//Samples per channel produced since Reset()
+
+		//Whole signal analytic signal of every dimension of in (real parts only) into out, which gets the same
+		//dimensions, intervals and interval
+		static void Analytic(const DFTTime &in, DFTData &out);
+		//Whole signal analytic signal of n real samples
+		static void Analytic(const double *in, unsigned int n, std::complex<double> *out);
+
+		//Instantaneous frequency in Hz of count analytic samples taken every stride values, each against the one
+		//before it: previous is the sample before the first one, and is updated to the last one
+		static void Frequency(const std::complex<double> *analytic, unsigned int count, unsigned int stride, double sampleRate,
+			std::complex<double> &previous, double *frequency);
+	};
+}
+
+#endif /*DFTHilbert_H*/
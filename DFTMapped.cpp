@@ -0,0 +1,263 @@
+//DFTMapped.cpp
+#include <cstring>
+#include <algorithm>
+#include "DFTMapped.h"
+
+using namespace std;
+namespace DFT{
+	namespace{
+		const char MAPPED_MAGIC[8] = {'W', 'D', 'F', 'T', 'M', 'A', 'P', 'D'};
+		const unsigned int MAPPED_VERSION = 1;
+		const unsigned long long DATA_OFFSET = 4096ULL;		//Header padded to a page, so that values start on one
+	}
+
+	//Constructor
+	DFTMapped::DFTMapped(): Dimension(1), Intervals(0), Interval(1.0){
+	}
+
+	//DataOffset()
+	unsigned long long DFTMapped::DataOffset(){
+		return DATA_OFFSET;
+	}
+
+	//Capacity()
+	unsigned long long DFTMapped::Capacity() const{
+		if (File.GetSize() <= DATA_OFFSET){
+			return 0;
+		}
+		return (File.GetSize() - DATA_OFFSET)/(sizeof(complex<double>)*Dimension);
+	}
+
+	//CheckOpen()
+	void DFTMapped::CheckOpen() const{
+		if (!File.IsOpen()){
+			throw Exception(EXCEPTION_FILE_NOT_OPEN, "File is not open for processing.");
+		}
+	}
+
+	//CheckWritable()
+	void DFTMapped::CheckWritable() const{
+		CheckOpen();
+		if (!File.IsWritable()){
+			throw Exception(EXCEPTION_UNSUPPORTED, "File is open read only.");
+		}
+	}
+
+	//Reserve()
+	void DFTMapped::Reserve(unsigned int intervals, bool exact){
+		unsigned long long capacity = Capacity();
+		if (!exact && intervals <= capacity){
+			return;
+		}
+		//Grows geometrically, as DFTGeneric does, so that creating intervals one at a time does not remap every time
+		unsigned long long room = intervals;
+		if (!exact){
+			room = max(room, capacity + capacity/2);
+		}
+		File.Resize(DATA_OFFSET + room*sizeof(complex<double>)*Dimension);
+	}
+
+	//Store()
+	void DFTMapped::Store(){
+		Header_T *head = Head();
+		head->Dimension = Dimension;
+		head->Intervals = Intervals;
+		head->Interval = Interval;
+	}
+
+	//CreateInterval()
+	void DFTMapped::CreateInterval(unsigned int intervalN){
+		if (intervalN >= Intervals){
+			//What lies past Intervals is always zeros, so nothing has to be written
+			Reserve(intervalN + 1, false);
+			Intervals = intervalN + 1;
+			Store();
+		}
+	}
+
+	//Create()
+	void DFTMapped::Create(const char *file, unsigned int n, double interval, unsigned int intervals){
+		if (!n || interval <= 0){
+			throw Exception(EXCEPTION_DATA_INVALID, "Dimension and/or interval cannot <= zero!");
+		}
+		Close();
+		File.Create(file, DATA_OFFSET + (unsigned long long) intervals*n*sizeof(complex<double>));
+		Header_T *head = Head();
+		memcpy(head->Magic, MAPPED_MAGIC, sizeof(head->Magic));
+		head->Version = MAPPED_VERSION;
+		head->Domain = DFTDomain();
+		head->DataOffset = DATA_OFFSET;
+		Dimension = n;
+		Intervals = intervals;
+		Interval = interval;
+		Store();
+	}
+
+	//Open()
+	bool DFTMapped::Open(const char *file, bool writable){
+		Close();
+		if (!File.Open(file, writable)){
+			return false;
+		}
+		const Header_T *head = reinterpret_cast<const Header_T*>(File.Data());
+		if (File.GetSize() < DATA_OFFSET || memcmp(head->Magic, MAPPED_MAGIC, sizeof(head->Magic)) || head->Version != MAPPED_VERSION ||
+			head->DataOffset != DATA_OFFSET || head->Domain != unsigned(DFTDomain()) || !head->Dimension || head->Interval <= 0 ||
+			File.GetSize() - DATA_OFFSET < (unsigned long long) head->Intervals*head->Dimension*sizeof(complex<double>)){
+			File.Close();
+			throw Exception(EXCEPTION_PARSE_FORMAT_ERROR, "File is not a mapped store of this domain.");
+		}
+		Dimension = head->Dimension;
+		Intervals = head->Intervals;
+		Interval = head->Interval;
+		return true;
+	}
+
+	//Close()
+	void DFTMapped::Close(){
+		File.Close();
+		Dimension = 1;
+		Intervals = 0;
+		Interval = 1.0;
+	}
+
+	//DFTSetInterval()
+	void DFTMapped::DFTSetInterval(double n){
+		if (n <= 0){
+			throw Exception(EXCEPTION_DATA_INVALID, "Interval cannot <= zero!");
+		}
+		CheckWritable();
+		Interval = n;
+		Store();
+	}
+
+	//DFTSetDimension()
+	void DFTMapped::DFTSetDimension(unsigned int n){
+		if (!n){
+			throw Exception(EXCEPTION_DATA_INVALID, "Number cannot be zero!");
+		}
+		if (n == Dimension){
+			return;
+		}
+		CheckWritable();
+		//Drop the values and size the file afresh, which leaves zeros
+		File.Resize(DATA_OFFSET);
+		Dimension = n;
+		Reserve(Intervals, true);
+		Store();
+	}
+
+	//DFTSetNumInterval()
+	void DFTMapped::DFTSetNumInterval(unsigned int n){
+		if (n == Intervals){
+			return;
+		}
+		CheckWritable();
+		if (n < Intervals){
+			//Cut the file, so that what lies past the end is zeros again and takes no space
+			Reserve(n, true);
+		}
+		else{
+			Reserve(n, false);
+		}
+		Intervals = n;
+		Store();
+	}
+
+	//DFTGet()
+	complex<double> DFTMapped::DFTGet(unsigned int intervalN, unsigned int dimension) const{
+		if (dimension >= Dimension){
+			throw Exception(EXCEPTION_RANGE, "Out of range access.");
+		}
+		if (intervalN >= Intervals){
+			return complex<double>(0, 0);
+		}
+		return Values()[(size_t) intervalN*Dimension + dimension];
+	}
+
+	//DFTSet()
+	void DFTMapped::DFTSet(unsigned int intervalN, unsigned int dimension, const complex<double> &data){
+		if (dimension >= Dimension){
+			throw Exception(EXCEPTION_RANGE, "Out of range access.");
+		}
+		CheckWritable();
+		CreateInterval(intervalN);
+		Values()[(size_t) intervalN*Dimension + dimension] = data;
+	}
+
+	//DFTGetRange()
+	void DFTMapped::DFTGetRange(unsigned int dimension, unsigned int first, unsigned int count, complex<double> *out) const{
+		if (dimension >= Dimension){
+			throw Exception(EXCEPTION_RANGE, "Out of range access.");
+		}
+		unsigned int stored = (first < Intervals) ? min(count, Intervals - first) : 0;
+		if (stored){
+			const complex<double> *in = Values() + (size_t) first*Dimension + dimension;
+			for (unsigned int i = 0; i < stored; i++, in += Dimension){
+				out[i] = *in;
+			}
+		}
+		fill(out + stored, out + count, complex<double>(0, 0));
+	}
+
+	//DFTGetSplit()
+	void DFTMapped::DFTGetSplit(unsigned int dimension, unsigned int first, unsigned int count, double *real, double *imag) const{
+		if (dimension >= Dimension){
+			throw Exception(EXCEPTION_RANGE, "Out of range access.");
+		}
+		unsigned int stored = (first < Intervals) ? min(count, Intervals - first) : 0;
+		if (stored){
+			const complex<double> *in = Values() + (size_t) first*Dimension + dimension;
+			for (unsigned int i = 0; i < stored; i++, in += Dimension){
+				real[i] = in->real();
+				if (imag){
+					imag[i] = in->imag();
+				}
+			}
+		}
+		fill(real + stored, real + count, 0.0);
+		if (imag){
+			fill(imag + stored, imag + count, 0.0);
+		}
+	}
+
+	//DFTSetRange()
+	void DFTMapped::DFTSetRange(unsigned int dimension, unsigned int first, unsigned int count, const complex<double> *in){
+		if (dimension >= Dimension){
+			throw Exception(EXCEPTION_RANGE, "Out of range access.");
+		}
+		if (!count){
+			return;
+		}
+		CheckWritable();
+		CreateInterval(first + count - 1);
+		complex<double> *out = Values() + (size_t) first*Dimension + dimension;
+		for (unsigned int i = 0; i < count; i++, out += Dimension){
+			*out = in[i];
+		}
+	}
+
+	//DFTSetSplit()
+	void DFTMapped::DFTSetSplit(unsigned int dimension, unsigned int first, unsigned int count, const double *real, const double *imag){
+		if (dimension >= Dimension){
+			throw Exception(EXCEPTION_RANGE, "Out of range access.");
+		}
+		if (!count){
+			return;
+		}
+		CheckWritable();
+		CreateInterval(first + count - 1);
+		complex<double> *out = Values() + (size_t) first*Dimension + dimension;
+		for (unsigned int i = 0; i < count; i++, out += Dimension){
+			*out = complex<double>(real[i], imag ? imag[i] : 0);
+		}
+	}
+
+	//DFTSpan()
+	const complex<double> *DFTMapped::DFTSpan(unsigned int dimension, unsigned int &stride) const{
+		if (dimension >= Dimension || !Intervals){
+			return NULL;
+		}
+		stride = Dimension;
+		return Values() + dimension;
+	}
+}
@@ -0,0 +1,111 @@
+/*
+	DFTMapped
+
+	A container whose values are kept in a memory mapped file rather than in memory, for spectra and signals too large
+	to hold: the system pages values in as they are read and writes them back as it sees fit, so only what is being
+	worked on takes memory. The file outlives the object and can be opened again, in another session, without
+	computing its content again. Several processes can open the same file read only at once and share its pages.
+	Use DFTMappedTime or DFTMappedFrequency.
+
+	The file starts with a header giving the domain, number of dimensions and intervals and the interval, padded to
+	a page. Then follow the values as complex<double>, interval after interval, each with its dimensions, as in an
+	Interleaved DFTGeneric; DFTSpan() gives them out, so that transforms read them where they lie.
+	The file is created sparse where the file system allows: intervals never written take no space. It grows as
+	intervals are created, half its size again at a time, and shrinks when intervals are dropped.
+
+	As with DFTGeneric, intervals past the end read as zeros and are created by the setters. Reading changes nothing,
+	so that threads may read at once, while none writes. Setters throw EXCEPTION_UNSUPPORTED when the file is open
+	read only. Changing the number of dimensions of a container that holds intervals resets their values to zero.
+	Advise() passes on to the mapping how the values will be read, e.g. Sequential for a transform of the whole file.
+*/
+#pragma once
+#ifndef DFTMapped_H
+#define DFTMapped_H
+
+#include <complex>
+#include "DFTData.h"
+#include "WaveMapping.h"
+#include "Exception.h"
+
+namespace DFT{
+	/************** DFTMapped ******************/
+	class DFTMapped: public virtual DFTData{
+		//Start of the file
+		struct Header_T{
+			char Magic[8];						//MAPPED_MAGIC
+			unsigned int Version;				//MAPPED_VERSION
+			unsigned int Domain;				//DFTData::Domain
+			unsigned int Dimension;
+			unsigned int Intervals;
+			double Interval;
+			unsigned long long DataOffset;		//Byte offset of the first value
+		};
+
+		Wave::MappedFile File;
+		unsigned int Dimension;
+		unsigned int Intervals;
+		double Interval;
+
+		//Not copyable
+		DFTMapped(const DFTMapped &);
+		DFTMapped &operator=(const DFTMapped &);
+
+	protected:
+		Header_T *Head(){ return reinterpret_cast<Header_T*>(File.Data()); }
+		std::complex<double> *Values(){ return reinterpret_cast<std::complex<double>*>(File.Data() + DataOffset()); }
+		const std::complex<double> *Values() const{ return reinterpret_cast<const std::complex<double>*>(File.Data() + DataOffset()); }
+		static unsigned long long DataOffset();
+		unsigned long long Capacity() const;					//Intervals the file has room for
+		void CheckOpen() const;
+		void CheckWritable() const;
+		void CreateInterval(unsigned int intervalN);			//Make sure the interval exists, growing the file
+		void Reserve(unsigned int intervals, bool exact);		//Make room for intervals in the file
+		void Store();											//Write the properties into the header
+
+	public:
+		DFTMapped();
+		virtual ~DFTMapped(){}
+
+		//Create the file, or truncate it if it exists, for n dimensions and intervals intervals, all zeros
+		void Create(const char *file, unsigned int n=1, double interval=1.0, unsigned int intervals=0);
+		//Open a file made by Create(). Returns false if it does not exist or cannot be opened.
+		//Throws EXCEPTION_PARSE_FORMAT_ERROR if it is not such a file or not of the domain of this object.
+		bool Open(const char *file, bool writable=false);
+		void Close();											//Unmap and close the file
+		void Flush(){ File.Flush(); }							//Write the changes to the file now
+		void Advise(Wave::MappedFile::Access access){ File.Advise(access); }
+		bool IsOpen() const{ return File.IsOpen(); }
+		bool IsWritable() const{ return File.IsWritable(); }
+
+		//Properties Getter
+		unsigned int DFTDimension() const{ return Dimension; }
+		unsigned int DFTSample() const{ return Intervals*Dimension; }
+		unsigned int DFTNumInterval() const{ return Intervals; }
+		double DFTInterval() const{ return Interval; }
+
+		//Properties Setter
+		void DFTSetInterval(double n);
+		void DFTSetDimension(unsigned int n);
+		void DFTSetNumInterval(unsigned int n);
+
+		//Samples getter and setter
+		std::complex<double> DFTGet(unsigned int intervalN, unsigned int dimension) const;
+		void DFTSet(unsigned int intervalN, unsigned int dimension, const std::complex<double> &data);
+
+		//Bulk access
+		void DFTGetRange(unsigned int dimension, unsigned int first, unsigned int count, std::complex<double> *out) const;
+		void DFTGetSplit(unsigned int dimension, unsigned int first, unsigned int count, double *real, double *imag) const;
+		void DFTSetRange(unsigned int dimension, unsigned int first, unsigned int count, const std::complex<double> *in);
+		void DFTSetSplit(unsigned int dimension, unsigned int first, unsigned int count, const double *real, const double *imag);
+		const std::complex<double> *DFTSpan(unsigned int dimension, unsigned int &stride) const;
+	};
+
+	/************** DFTMappedTime *************/
+	class DFTMappedTime: public DFTMapped, public DFTTime{
+	};
+	/************** DFTMappedFrequency ********/
+	class DFTMappedFrequency: public DFTMapped, public DFTFrequency{
+	};
+}
+
+#endif /*DFTMapped_H*/
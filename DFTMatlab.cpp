@@ -11,8 +11,9 @@ namespace DFT{
 
 		//To prevent memory leaks, we better wrap everything around a try block. Just in case the data types throw exceptions
 		try{
-			//Create the matrices
-			T = mxCreateDoubleMatrix(intervaln, dimension, mxCOMPLEX);
+			//Create the matrices. Real input leaves out the imaginary array; Matlab takes its real path.
+			bool real = TimeDomain->DFTIsReal();
+			T = mxCreateDoubleMatrix(intervaln, dimension, real ? mxREAL : mxCOMPLEX);
 			//F = mxCreateDoubleMatrix(interval, dimension, mxCOMPLEX);
 			if (!T){
 				throw Exception(EXCEPTION_MEMORY_ERROR, "Could not allocate memory for Matrices");
@@ -29,13 +30,7 @@ namespace DFT{
 			// i.e. for a 2x2 matrix, the pointers go like this: (matrix coordinates column by row - x,y)
 			// 1,1 -> 1,2 -> 2,1 -> 2,2
 			for (unsigned j = 0; j < dimension; j++){
-				for (unsigned i = 0; i < intervaln; i++){
-					complex<double> num = TimeDomain->DFTGet(i, j);
-					//std::cout << i << " " << j << " " << num.real() << endl;
-					//engPutVariable(Matlab, "T", T);
-					*(TReal + j*intervaln+i) = num.real();
-					*(TIm + j*intervaln+i) = num.imag();
-				}
+				TimeDomain->DFTGetSplit(j, 0, intervaln, TReal + j*intervaln, TIm ? TIm + j*intervaln : NULL);
 			}
 
 			//Put variable in workspace
@@ -61,14 +56,10 @@ namespace DFT{
 				FrequencyDomain->DFTSetNumInterval(intervaln);
 			}
 
+			//A Hermitian frequency domain only takes the lower half
+			unsigned stored = (FrequencyDomain->DFTIsHermitian() && intervaln) ? intervaln/2 + 1 : intervaln;
 			for (unsigned j = 0; j < dimension; j++){
-				for (unsigned i = 0; i < intervaln; i++){
-					complex<double> num(*(TReal + j*intervaln+i),0);
-					if (TIm){
-						num.imag(*(TIm + j*intervaln+i));
-					}
-					FrequencyDomain->DFTSet(i,j,num);
-				}
+				FrequencyDomain->DFTSetSplit(j, 0, stored, TReal + j*intervaln, TIm ? TIm + j*intervaln : NULL);
 			}
 		}
 		catch(...){
@@ -91,6 +82,30 @@ namespace DFT{
 		}
 	}
 
+	//Put data in the workspace
+	void DFTMatlab::PutVariable(const char *name, const DFTData &data){
+		unsigned intervaln = data.DFTNumInterval();
+		unsigned dimension = data.DFTDimension();
+		bool real = data.DFTIsReal();
+		mxArray *M = mxCreateDoubleMatrix(intervaln, dimension, real ? mxREAL : mxCOMPLEX);
+		if (!M){
+			throw Exception(EXCEPTION_MEMORY_ERROR, "Could not allocate memory for Matrices");
+		}
+		try{
+			double *MReal = mxGetPr(M);
+			double *MIm = mxGetPi(M);
+			for (unsigned j = 0; j < dimension; j++){
+				data.DFTGetSplit(j, 0, intervaln, MReal + j*intervaln, MIm ? MIm + j*intervaln : NULL);
+			}
+			engPutVariable(Matlab, name, M);
+		}
+		catch(...){
+			mxDestroyArray(M);
+			throw;
+		}
+		mxDestroyArray(M);
+	}
+
 	//Inverse Fourier Transform
 	void DFTMatlab::InverseDiscreteFourierTransform(){
 		//cf http://www.mathworks.com/help/techdoc/apiref/bqoqnz0.html
@@ -118,20 +133,14 @@ namespace DFT{
 			// i.e. for a 2x2 matrix, the pointers go like this: (matrix coordinates column by row - x,y)
 			// 1,1 -> 1,2 -> 2,1 -> 2,2
 			for (unsigned j = 0; j < dimension; j++){
-				for (unsigned i = 0; i < intervaln; i++){
-					complex<double> num = FrequencyDomain->DFTGet(i, j);
-					//std::cout << i << " " << j << " " << num.real() << endl;
-					//engPutVariable(Matlab, "T", T);
-					*(TReal + j*intervaln+i) = num.real();
-					*(TIm + j*intervaln+i) = num.imag();
-				}
+				FrequencyDomain->DFTGetSplit(j, 0, intervaln, TReal + j*intervaln, TIm + j*intervaln);
 			}
 
 			//Put variable in workspace
 			engPutVariable(Matlab, "F", F);  
 
-			//Let's do iFFT
-			engEvalString(Matlab, "T = ifftn(F)");
+			//Let's do iFFT. A real time domain gets the real result of a conjugate symmetric spectrum.
+			engEvalString(Matlab, TimeDomain->DFTIsReal() ? "T = ifftn(F, 'symmetric')" : "T = ifftn(F)");
 
 			//Get T back from workspace
 			T = engGetVariable(Matlab, "T");
@@ -151,13 +160,7 @@ namespace DFT{
 			}
 
 			for (unsigned j = 0; j < dimension; j++){
-				for (unsigned i = 0; i < intervaln; i++){
-					complex<double> num(*(TReal + j*intervaln+i),0);
-					if (TIm){
-						num.imag(*(TIm + j*intervaln+i));
-					}
-					TimeDomain->DFTSet(i,j,num);
-				}
+				TimeDomain->DFTSetSplit(j, 0, intervaln, TReal + j*intervaln, TIm ? TIm + j*intervaln : NULL);
 			}
 		}
 		catch(...){
@@ -50,6 +50,8 @@ namespace DFT{
 
 		//******** MATLAB Specific Methods **************//
 		Engine *GetEngine(){ return Matlab; }
+		//Copy data into the workspace as variable name, as the transforms leave T and F there
+		void PutVariable(const char *name, const DFTData &data);
 	};
 }
 
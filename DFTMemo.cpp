@@ -0,0 +1,317 @@
+//DFTMemo.cpp
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include "DFTMemo.h"
+
+using namespace std;
+namespace DFT{
+	namespace{
+		const char MEMO_MAGIC[8] = {'W', 'D', 'F', 'T', 'M', 'E', 'M', 'O'};
+		const unsigned int MEMO_VERSION = 2;
+		const unsigned int HASH_WORDS = 4096U;		//Words gathered before they are hashed
+
+		//Start of a file of the disk tier
+		struct MemoHeader_T{
+			char Magic[8];
+			unsigned int Version;
+			unsigned int Intervals;
+			unsigned int Dimensions;
+			unsigned int Stored;
+			unsigned long long High;
+			unsigned long long Low;
+		};
+
+		inline unsigned long long Rotate(unsigned long long x, int r){
+			return (x << r) | (x >> (64 - r));
+		}
+		inline unsigned long long Finalise(unsigned long long k){
+			k ^= k >> 33;
+			k *= 0xff51afd7ed558ccdULL;
+			k ^= k >> 33;
+			k *= 0xc4ceb9fe1a85ec53ULL;
+			k ^= k >> 33;
+			return k;
+		}
+
+		//MurmurHash3 x64_128, fed 128 bits at a time
+		class Murmur_T{
+			unsigned long long H1, H2;
+			unsigned long long Length;				//Bytes hashed
+		public:
+			Murmur_T(): H1(0x9368e53c2f6af274ULL), H2(0x586dcd208f7cd3fdULL), Length(0){}
+			void Add(const unsigned long long *words, unsigned int n){
+				const unsigned long long c1 = 0x87c37b91114253d5ULL, c2 = 0x4cf5ad432745937fULL;
+				unsigned int i = 0;
+				for (; i + 1 < n; i += 2){
+					unsigned long long k1 = words[i], k2 = words[i+1];
+					k1 *= c1; k1 = Rotate(k1, 31); k1 *= c2; H1 ^= k1;
+					H1 = Rotate(H1, 27); H1 += H2; H1 = H1*5 + 0x52dce729;
+					k2 *= c2; k2 = Rotate(k2, 33); k2 *= c1; H2 ^= k2;
+					H2 = Rotate(H2, 31); H2 += H1; H2 = H2*5 + 0x38495ab5;
+				}
+				//An odd word out is the tail of the stream
+				if (i < n){
+					unsigned long long k1 = words[i];
+					k1 *= c1; k1 = Rotate(k1, 31); k1 *= c2; H1 ^= k1;
+				}
+				Length += n*8ULL;
+			}
+			DFTDigest Get() const{
+				unsigned long long h1 = H1 ^ Length, h2 = H2 ^ Length;
+				h1 += h2;
+				h2 += h1;
+				h1 = Finalise(h1);
+				h2 = Finalise(h2);
+				h1 += h2;
+				h2 += h1;
+				DFTDigest digest = {h1, h2};
+				return digest;
+			}
+		};
+
+	}
+
+	/************** DFTDigest ****************/
+	//Compute()
+	DFTDigest DFTDigest::Compute(const DFTData &data, const char *transform){
+		unsigned int intervals = data.DFTNumInterval(), dimensions = data.DFTDimension();
+		Murmur_T hash;
+		//Parameters first, padded to whole words
+		vector<unsigned long long> words;
+		size_t length = strlen(transform);
+		unsigned int n = unsigned((length + 7)/8);
+		words.assign(n + 2, 0);
+		memcpy(&words[0], transform, length);
+		words[n] = intervals;
+		words[n+1] = dimensions;
+		hash.Add(&words[0], n + 2);
+		//Then the samples, a run of intervals at a time. Each value is two whole words.
+		vector<complex<double> > values(HASH_WORDS/2);
+		for (unsigned int j = 0; j < dimensions; j++){
+			for (unsigned int first = 0; first < intervals; first += HASH_WORDS/2){
+				unsigned int count = min(HASH_WORDS/2, intervals - first);
+				data.DFTGetRange(j, first, count, &values[0]);
+				hash.Add(reinterpret_cast<const unsigned long long*>(&values[0]), 2*count);
+			}
+		}
+		return hash.Get();
+	}
+
+	/************** DFTMemo ****************/
+	//Constructor
+	DFTMemo::DFTMemo(unsigned long long capacity, const string &directory)
+		: Capacity(capacity), Size(0), Directory(directory), Hits(0), DiskHits(0), Misses(0){
+	}
+
+	//SetCapacity()
+	void DFTMemo::SetCapacity(unsigned long long capacity){
+		Capacity = capacity;
+		Evict();
+	}
+
+	//Clear()
+	void DFTMemo::Clear(){
+		Entries.clear();
+		Recent.clear();
+		Size = 0;
+	}
+
+	//FileName()
+	string DFTMemo::FileName(const DFTDigest &key) const{
+		char name[40];
+		sprintf(name, "%016llx%016llx.dfm", key.High, key.Low);
+		string path = Directory;
+		if (!path.empty() && path[path.size() - 1] != '/' && path[path.size() - 1] != '\\'){
+			path += '/';
+		}
+		return path + name;
+	}
+
+	//Evict()
+	void DFTMemo::Evict(){
+		while (Size > Capacity && !Recent.empty()){
+			map<DFTDigest, Entry_T>::iterator it = Entries.find(Recent.back());
+			Size -= it->second.Values.size()*sizeof(complex<double>);
+			Entries.erase(it);
+			Recent.pop_back();
+		}
+	}
+
+	//Insert()
+	DFTMemo::Entry_T *DFTMemo::Insert(const DFTDigest &key, Entry_T &entry){
+		unsigned long long bytes = entry.Values.size()*sizeof(complex<double>);
+		if (bytes > Capacity){
+			return NULL;
+		}
+		map<DFTDigest, Entry_T>::iterator it = Entries.find(key);
+		if (it != Entries.end()){
+			//Same content, same result
+			return &it->second;
+		}
+		Entry_T &stored = Entries[key];
+		stored.Intervals = entry.Intervals;
+		stored.Dimensions = entry.Dimensions;
+		stored.Stored = entry.Stored;
+		stored.Values.swap(entry.Values);
+		Recent.push_front(key);
+		stored.Use = Recent.begin();
+		Size += bytes;
+		Evict();
+		//Evict() leaves the most recent alone as it fits
+		return &stored;
+	}
+
+	//Read()
+	bool DFTMemo::Read(const DFTDigest &key, Entry_T &entry) const{
+		ifstream file(FileName(key).c_str(), ios_base::in | ios_base::binary);
+		if (!file){
+			return false;
+		}
+		MemoHeader_T header;
+		if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || memcmp(header.Magic, MEMO_MAGIC, sizeof(header.Magic)) ||
+			header.Version != MEMO_VERSION || header.High != key.High || header.Low != key.Low){
+			return false;
+		}
+		entry.Intervals = header.Intervals;
+		entry.Dimensions = header.Dimensions;
+		entry.Stored = header.Stored;
+		if (entry.Stored > entry.Intervals){
+			return false;
+		}
+		entry.Values.resize((size_t) header.Stored*header.Dimensions);
+		if (!entry.Values.empty() && !file.read(reinterpret_cast<char*>(&entry.Values[0]), entry.Values.size()*sizeof(complex<double>))){
+			//Truncated
+			return false;
+		}
+		return true;
+	}
+
+	//Write()
+	bool DFTMemo::Write(const DFTDigest &key, const Entry_T &entry) const{
+		//Written aside then renamed, so that a file of the tier is either complete or missing
+		string name = FileName(key), temporary = name + ".tmp";
+		{
+			ofstream file(temporary.c_str(), ios_base::out | ios_base::binary | ios_base::trunc);
+			if (!file){
+				return false;
+			}
+			MemoHeader_T header;
+			memset(&header, 0, sizeof(header));
+			memcpy(header.Magic, MEMO_MAGIC, sizeof(header.Magic));
+			header.Version = MEMO_VERSION;
+			header.Intervals = entry.Intervals;
+			header.Dimensions = entry.Dimensions;
+			header.Stored = entry.Stored;
+			header.High = key.High;
+			header.Low = key.Low;
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			if (!entry.Values.empty()){
+				file.write(reinterpret_cast<const char*>(&entry.Values[0]), entry.Values.size()*sizeof(complex<double>));
+			}
+			if (!file){
+				file.close();
+				remove(temporary.c_str());
+				return false;
+			}
+		}
+		remove(name.c_str());
+		if (rename(temporary.c_str(), name.c_str())){
+			remove(temporary.c_str());
+			return false;
+		}
+		return true;
+	}
+
+	//Put()
+	void DFTMemo::Put(const Entry_T &entry, DFTData &out){
+		if (entry.Dimensions != out.DFTDimension()){
+			out.DFTSetDimension(entry.Dimensions);
+		}
+		if (entry.Intervals != out.DFTNumInterval()){
+			out.DFTSetNumInterval(entry.Intervals);
+		}
+		const complex<double> *values = entry.Values.empty() ? NULL : &entry.Values[0];
+		//The upper half of a Hermitian result, unless out mirrors it itself
+		vector<complex<double> > upper;
+		unsigned int mirrored = out.DFTIsHermitian() ? 0 : entry.Intervals - entry.Stored;
+		for (unsigned int j = 0; j < entry.Dimensions && entry.Intervals; j++){
+			const complex<double> *lower = values + (size_t) j*entry.Stored;
+			out.DFTSetRange(j, 0, entry.Stored, lower);
+			if (mirrored){
+				upper.resize(mirrored);
+				for (unsigned int i = 0; i < mirrored; i++){
+					upper[i] = conj(lower[entry.Intervals - entry.Stored - i]);
+				}
+				out.DFTSetRange(j, entry.Stored, mirrored, &upper[0]);
+			}
+		}
+	}
+
+	//Load()
+	bool DFTMemo::Load(const DFTDigest &key, DFTData &out){
+		map<DFTDigest, Entry_T>::iterator it = Entries.find(key);
+		if (it != Entries.end()){
+			Recent.splice(Recent.begin(), Recent, it->second.Use);
+			Hits++;
+			Put(it->second, out);
+			return true;
+		}
+		Entry_T entry;
+		if (Directory.empty() || !Read(key, entry)){
+			Misses++;
+			return false;
+		}
+		DiskHits++;
+		Put(entry, out);
+		Insert(key, entry);
+		return true;
+	}
+
+	//Store()
+	void DFTMemo::Store(const DFTDigest &key, const DFTData &result){
+		Entry_T entry;
+		entry.Intervals = result.DFTNumInterval();
+		entry.Dimensions = result.DFTDimension();
+		entry.Stored = (result.DFTIsHermitian() && entry.Intervals) ? entry.Intervals/2 + 1 : entry.Intervals;
+		entry.Values.resize((size_t) entry.Stored*entry.Dimensions);
+		for (unsigned int j = 0; j < entry.Dimensions && entry.Stored; j++){
+			result.DFTGetRange(j, 0, entry.Stored, &entry.Values[(size_t) j*entry.Stored]);
+		}
+		//The transform is done; failing to keep it on disk only costs a miss later
+		if (!Directory.empty()){
+			Write(key, entry);
+		}
+		Insert(key, entry);
+	}
+
+	/************** DFTMemoised ****************/
+	//Constructor
+	DFTMemoised::DFTMemoised(DFT &transform, DFTMemo &memo, const string &name)
+		: DFT(transform.GetTimeDomain(), transform.GetFrequencyDomain()), Transform(transform), Memo(memo), Name(name), Hit(false){
+	}
+
+	//DiscreteFourierTransform()
+	void DFTMemoised::DiscreteFourierTransform(){
+		DFTDigest key = DFTDigest::Compute(*TimeDomain, (Name + ":forward").c_str());
+		Hit = Memo.Load(key, *FrequencyDomain);
+		if (Hit){
+			return;
+		}
+		Transform.DiscreteFourierTransform();
+		Memo.Store(key, *FrequencyDomain);
+	}
+
+	//InverseDiscreteFourierTransform()
+	void DFTMemoised::InverseDiscreteFourierTransform(){
+		//A real time domain takes the real result of a transform, which differs unless the spectrum is conjugate symmetric
+		DFTDigest key = DFTDigest::Compute(*FrequencyDomain, (Name + (TimeDomain->DFTIsReal() ? ":inverse:real" : ":inverse")).c_str());
+		Hit = Memo.Load(key, *TimeDomain);
+		if (Hit){
+			return;
+		}
+		Transform.InverseDiscreteFourierTransform();
+		Memo.Store(key, *TimeDomain);
+	}
+}
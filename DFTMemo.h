@@ -0,0 +1,132 @@
+/*
+	Transform Memoisation
+
+	DFTDigest
+	128 bit digest of the content of a DFTData object and of the transform applied to it, MurmurHash3 x64_128 over the
+	bit patterns of the samples read through DFTGetRange() and the shape of the data.
+	cf https://github.com/aappleby/smhasher/blob/master/src/MurmurHash3.cpp
+	Hashing is a single pass at a few words per nanosecond, far less than any transform of the data, let alone the
+	round trip through Matlab.
+
+	DFTMemo
+	Results of transforms keyed by the digest of their input, so that the same audio transformed again, e.g. the same
+	file under another name or a job run again, is served without computing anything.
+	The memory tier holds the most recently used results up to Capacity bytes and evicts the least recently used. The
+	optional disk tier keeps every result in a file of its own, named after the digest, in Directory; results found on
+	disk are brought back into memory. Results larger than Capacity only go to disk.
+	A file on disk starts with a header repeating the digest and the shape, then the values dimension after dimension.
+	Hermitian results, cf DFTData::DFTIsHermitian(), are kept as their lower half in both tiers.
+
+	DFTMemoised
+	A DFT that serves its transforms from a DFTMemo and asks another DFT, e.g. DFTMatlab, on a miss. Name tells
+	transforms that differ other than by their input apart, e.g. "fftn".
+*/
+#pragma once
+#ifndef DFTMemo_H
+#define DFTMemo_H
+
+#include <vector>
+#include <list>
+#include <map>
+#include <string>
+#include <complex>
+#include "DFT.h"
+#include "DFTData.h"
+
+namespace DFT{
+	/************** DFTDigest ****************/
+	struct DFTDigest{
+		unsigned long long High;
+		unsigned long long Low;
+
+		bool operator<(const DFTDigest &op) const{ return High != op.High ? High < op.High : Low < op.Low; }
+		bool operator==(const DFTDigest &op) const{ return High == op.High && Low == op.Low; }
+
+		//Digest of the data and of the name of the transform applied to it
+		static DFTDigest Compute(const DFTData &data, const char *transform);
+	};
+
+	/************** DFTMemo ****************/
+	class DFTMemo{
+		//A result
+		struct Entry_T{
+			unsigned int Intervals;
+			unsigned int Dimensions;
+			unsigned int Stored;							//Intervals stored per dimension, the lower half of a Hermitian result
+			std::vector<std::complex<double> > Values;		//Dimension after dimension
+			std::list<DFTDigest>::iterator Use;				//Place in Recent
+		};
+
+		unsigned long long Capacity;						//Bytes the memory tier may hold
+		unsigned long long Size;							//Bytes it holds
+		std::string Directory;								//Disk tier, none if empty
+		std::map<DFTDigest, Entry_T> Entries;				//Memory tier
+		std::list<DFTDigest> Recent;						//Most recently used first
+
+		//Statistics
+		unsigned long long Hits;
+		unsigned long long DiskHits;
+		unsigned long long Misses;
+
+		DFTMemo(const DFTMemo &);
+		DFTMemo &operator=(const DFTMemo &);
+
+	protected:
+		std::string FileName(const DFTDigest &key) const;		//Path of a result in the disk tier
+		Entry_T *Insert(const DFTDigest &key, Entry_T &entry);	//Add to the memory tier, taking the values. NULL if too large.
+		void Evict();											//Drop the least recently used until within Capacity
+		bool Read(const DFTDigest &key, Entry_T &entry) const;	//From the disk tier
+		bool Write(const DFTDigest &key, const Entry_T &entry) const;	//To the disk tier. False if it could not be written.
+		static void Put(const Entry_T &entry, DFTData &out);	//Copy a result into a data object
+
+	public:
+		//capacity is in bytes. directory is the disk tier, none if empty.
+		explicit DFTMemo(unsigned long long capacity=256ULL << 20, const std::string &directory="");
+
+		//Copy the result stored under key into out, resized where it supports it. False if there is none.
+		bool Load(const DFTDigest &key, DFTData &out);
+		//Store result under key, in memory and on disk. A result that cannot be written to disk is only in memory.
+		void Store(const DFTDigest &key, const DFTData &result);
+		void Clear();								//Empty the memory tier. The disk tier is left alone.
+
+		//Setters
+		void SetCapacity(unsigned long long capacity);
+		void SetDirectory(const std::string &directory){ Directory = directory; }	//Empty for none
+
+		//Getters
+		unsigned long long GetCapacity() const{ return Capacity; }
+		unsigned long long GetSize() const{ return Size; }
+		const std::string &GetDirectory() const{ return Directory; }
+		unsigned int NumEntries() const{ return unsigned(Entries.size()); }
+		unsigned long long NumHits() const{ return Hits; }				//Served from memory
+		unsigned long long NumDiskHits() const{ return DiskHits; }		//Served from disk
+		unsigned long long NumMisses() const{ return Misses; }
+	};
+
+	/************** DFTMemoised ****************/
+	class DFTMemoised: public DFT{
+		DFT &Transform;						//Computes the misses
+		DFTMemo &Memo;						//Results
+		std::string Name;					//Name of the transform
+		bool Hit;							//Whether the last transform was served from the memo
+
+		DFTMemoised(const DFTMemoised &);
+		DFTMemoised &operator=(const DFTMemoised &);
+
+	public:
+		//Uses the data objects of transform
+		DFTMemoised(DFT &transform, DFTMemo &memo, const std::string &name);
+
+		void DiscreteFourierTransform();		//Perform Discrete Fourier Transform
+		void InverseDiscreteFourierTransform();	//Perform Inverse Discrete Fourier Transform
+
+		//Whether the last transform was served from the memo, i.e. the transform given was not asked for it
+		bool WasHit() const{ return Hit; }
+
+		//Setters, passed on to the transform
+		void SetPointer(DFTTime *ptr){ TimeDomain = ptr; Transform.SetPointer(ptr); }
+		void SetPointer(DFTFrequency *ptr){ FrequencyDomain = ptr; Transform.SetPointer(ptr); }
+	};
+}
+
+#endif /*DFTMemo_H*/
@@ -0,0 +1,159 @@
+//DFTOnset.cpp
+#include <cmath>
+#include <algorithm>
+#include "DFTOnset.h"
+#ifdef WAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+namespace DFT{
+	//Constructor
+	DFTOnset::DFTOnset(unsigned int frame, unsigned int hop, double delta, unsigned int lookahead, unsigned int history,
+		unsigned int wait, double compression, WindowType window)
+		: Analysis(frame, hop, window), Compression(compression), Delta(delta), Lookahead(lookahead), History(history),
+		Wait(wait), Normalisation(1.0), Channels(0), SampleInterval(1.0), Frames(0), Evaluated(0), LastOnset(-1){
+		if (compression < 0){
+			throw Exception(EXCEPTION_DATA_INVALID, "Compression cannot be negative!");
+		}
+		const vector<double> &coefficients = Analysis.GetWindow();
+		double sum = 0;
+		for (unsigned int i = 0; i < coefficients.size(); i++){
+			sum += coefficients[i];
+		}
+		Normalisation = 2/sum;
+		Ring.assign(History + Lookahead + 1, 0);
+	}
+
+	//Reset()
+	void DFTOnset::Reset(unsigned int channels, double interval){
+		if (!channels || interval <= 0){
+			throw Exception(EXCEPTION_DATA_INVALID, "Channels and/or interval cannot <= zero!");
+		}
+		Analysis.Reset(channels);
+		Channels = channels;
+		SampleInterval = interval;
+		//Silence before the signal, so that a sound present from the start is an onset
+		Previous.assign(Channels*Analysis.GetBins(), 0);
+		Current.assign(Channels*Analysis.GetBins(), 0);
+		fill(Ring.begin(), Ring.end(), 0.0);
+		Frames = 0;
+		Evaluated = 0;
+		LastOnset = -1;
+	}
+
+	//Flux()
+	double DFTOnset::Flux(const complex<double> *spectra){
+		unsigned int n = Channels*Analysis.GetBins();
+		for (unsigned int k = 0; k < n; k++){
+			double magnitude = sqrt(spectra[k].real()*spectra[k].real() + spectra[k].imag()*spectra[k].imag())*Normalisation;
+			Current[k] = Compression ? log(1 + Compression*magnitude) : magnitude;
+		}
+		//Half wave rectified difference, all channels at once
+		const double *current = &Current[0], *previous = &Previous[0];
+		double sum = 0;
+		unsigned int k = 0;
+#ifdef WAVE_SSE2
+		__m128d acc = _mm_setzero_pd(), zero = _mm_setzero_pd();
+		for (; k + 1 < n; k += 2){
+			acc = _mm_add_pd(acc, _mm_max_pd(_mm_sub_pd(_mm_loadu_pd(current + k), _mm_loadu_pd(previous + k)), zero));
+		}
+		double lanes[2];
+		_mm_storeu_pd(lanes, acc);
+		sum = lanes[0] + lanes[1];
+#endif
+		for (; k < n; k++){
+			double d = current[k] - previous[k];
+			sum += d > 0 ? d : 0;
+		}
+		Previous.swap(Current);
+		return sum/n;
+	}
+
+	//IsOnset()
+	bool DFTOnset::IsOnset(unsigned long long n, unsigned long long last){
+		unsigned int size = unsigned(Ring.size());
+		double value = Ring[n % size];
+		if (LastOnset >= 0 && n - LastOnset < Wait){
+			return false;
+		}
+		unsigned long long end = min(last, n + Lookahead);
+		//Local maximum
+		for (unsigned long long j = (n > Lookahead ? n - Lookahead : 0); j <= end; j++){
+			if (Ring[j % size] > value){
+				return false;
+			}
+		}
+		//Above the local mean
+		unsigned long long begin = n > History ? n - History : 0;
+		double mean = 0;
+		for (unsigned long long j = begin; j <= end; j++){
+			mean += Ring[j % size];
+		}
+		mean /= double(end - begin + 1);
+		if (value < mean + Delta){
+			return false;
+		}
+		LastOnset = (long long)n;
+		return true;
+	}
+
+	//Evaluate()
+	void DFTOnset::Evaluate(unsigned long long last, vector<double> &onsets, bool final){
+		double offset = GetFrameSize()/2*SampleInterval;
+		while (Evaluated < Frames && (final || Evaluated + Lookahead <= last)){
+			if (IsOnset(Evaluated, last)){
+				onsets.push_back(Evaluated*GetHop()*SampleInterval + offset);
+			}
+			Evaluated++;
+		}
+	}
+
+	//Push()
+	unsigned int DFTOnset::Push(const double *data, unsigned int blocks, vector<double> &onsets){
+		if (!Channels){
+			throw Exception(EXCEPTION_INITIALISATION, "Detector has not been reset for a signal.");
+		}
+		onsets.clear();
+		unsigned int frames = Analysis.Push(data, blocks, Spectra);
+		unsigned int bins = Analysis.GetBins();
+		for (unsigned int f = 0; f < frames; f++){
+			Ring[Frames % Ring.size()] = Flux(&Spectra[f*Channels*bins]);
+			Frames++;
+			Evaluate(Frames - 1, onsets);
+		}
+		return unsigned(onsets.size());
+	}
+
+	//Flush()
+	unsigned int DFTOnset::Flush(vector<double> &onsets){
+		onsets.clear();
+		if (Frames){
+			//Let the last frames through with a shortened lookahead
+			Evaluate(Frames - 1, onsets, true);
+		}
+		return unsigned(onsets.size());
+	}
+
+	//Detect()
+	void DFTOnset::Detect(Wave::WaveFile &wave, vector<double> &onsets){
+		Reset(wave.NumChannels(), wave.Interval());
+		onsets.clear();
+		//Full scale to [-1, 1]
+		double scale = ldexp(1.0, 1 - int(wave.SampleSize()));
+		unsigned int hop = GetHop();
+		vector<double> chunk(hop*Channels), found;
+		wave.DataRewind();
+		unsigned int blocks;
+		while ((blocks = wave.DataNextBlocks(&chunk[0], hop)) != 0){
+			for (unsigned int i = 0; i < blocks*Channels; i++){
+				chunk[i] *= scale;
+			}
+			if (Push(&chunk[0], blocks, found)){
+				onsets.insert(onsets.end(), found.begin(), found.end());
+			}
+		}
+		Flush(found);
+		onsets.insert(onsets.end(), found.begin(), found.end());
+	}
+}
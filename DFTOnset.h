@@ -0,0 +1,85 @@
+/*
+	Onset Detection
+
+	DFTOnset
+	Online onset detection with the spectral flux.
+	cf Dixon, "Onset detection revisited", DAFx 2006; Bock, Krebs & Schedl, "Evaluating the online capabilities of
+	onset detection methods", ISMIR 2012
+
+	The signal goes through a short time Fourier transform one frame at a time. Magnitudes are scaled so that a full
+	scale sinusoid peaks at one and compressed with log(1 + Compression*|X|). The detection function of a frame is
+	the half wave rectified increase of the compressed magnitudes over the previous frame, summed over the bins and
+	channels and divided by their number. Only the previous frame is kept; the sum runs in one SSE2 pass.
+
+	A frame n is an onset when, with L the lookahead and H the history:
+		- it is the maximum of the detection function over frames n-L to n+L
+		- it is at least Delta above the mean of the detection function over frames n-H to n+L
+		- it is at least Wait frames after the previous onset
+	The detection function values are kept in a ring buffer of H+L+1 frames, so memory does not depend on the
+	length of the signal and an onset is reported L frames after the frame it was found in.
+
+	Samples are expected to be scaled to [-1, 1]. Detect() does this for a WaveFile and reads the data chunk with
+	the block iterator, hop by hop.
+*/
+#pragma once
+#ifndef DFTOnset_H
+#define DFTOnset_H
+
+#include <vector>
+#include <complex>
+#include "DFTSTFT.h"
+#include "WaveFile.h"
+
+namespace DFT{
+	class DFTOnset{
+		DFTAnalysis Analysis;					//Framing and transform
+		double Compression;						//Logarithmic compression factor. Zero to use the magnitudes as they are
+		double Delta;							//Threshold above the local mean
+		unsigned int Lookahead;					//Frames after the candidate
+		unsigned int History;					//Frames before the candidate for the mean
+		unsigned int Wait;						//Minimum frames between onsets
+		double Normalisation;					//Scales the magnitudes so that a full scale sinusoid peaks at one
+
+		unsigned int Channels;					//Number of channels
+		double SampleInterval;					//Time between samples
+		std::vector<double> Previous;			//Compressed magnitudes of the previous frame. Channel major
+		std::vector<double> Current;			//Compressed magnitudes of the current frame. Channel major
+		std::vector<double> Ring;				//Detection function of the last History+Lookahead+1 frames
+		unsigned long long Frames;				//Frames seen
+		unsigned long long Evaluated;			//Frames evaluated as candidates
+		long long LastOnset;					//Frame of the last onset, or negative if none
+
+		std::vector<std::complex<double> > Spectra;		//Scratch space
+
+	protected:
+		double Flux(const std::complex<double> *spectra);		//Detection function of the frame whose spectra are given, one per channel
+		bool IsOnset(unsigned long long n, unsigned long long last);	//Peak picking of frame n using the frames up to last
+		//Evaluate the candidates whose lookahead ends by frame last, or all the remaining ones if final
+		void Evaluate(unsigned long long last, std::vector<double> &onsets, bool final=false);
+
+	public:
+		//frame and hop are in samples. lookahead, history and wait are in frames.
+		DFTOnset(unsigned int frame=2048, unsigned int hop=441, double delta=0.01, unsigned int lookahead=2, unsigned int history=10,
+			unsigned int wait=3, double compression=100, WindowType window=WindowHann);
+
+		//Get ready for a new signal with the number of channels and sampling interval
+		void Reset(unsigned int channels, double interval);
+
+		//Add blocks of samples, interleaved by channel. The times in seconds of the onsets confirmed by these blocks
+		//replace the content of onsets. Returns their number.
+		unsigned int Push(const double *data, unsigned int blocks, std::vector<double> &onsets);
+		//End of the signal. The last frames are evaluated with what lookahead they have.
+		unsigned int Flush(std::vector<double> &onsets);
+
+		//Stream the data chunk of the wave file through the detector and return the time of every onset
+		void Detect(Wave::WaveFile &wave, std::vector<double> &onsets);
+
+		//Getters
+		unsigned int GetFrameSize() const{ return Analysis.GetFrameSize(); }
+		unsigned int GetHop() const{ return Analysis.GetHop(); }
+		unsigned int GetLookahead() const{ return Lookahead; }
+		unsigned long long NumFrames() const{ return Frames; }
+	};
+}
+
+#endif /*DFTOnset_H*/
@@ -0,0 +1,275 @@
+//DFTPitch.cpp
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include "DFTPitch.h"
+
+using namespace std;
+namespace DFT{
+	namespace{
+		const unsigned int BATCH_FRAMES = 256;		//Frames per channel estimated together in Track()
+		const unsigned int MIN_FRAMES_PER_THREAD = 8;	//Below this a thread costs more than it saves
+
+		//Estimate a range of frames. Runs on a worker thread.
+		void EstimateRange(const DFTPitch *pitch, const double *frames, unsigned int stride, unsigned int begin, unsigned int end,
+			double *frequency, double *confidence, unsigned int outStride){
+			DFTPitch::Scratch_T scratch;
+			for (unsigned int i = begin; i < end; i++){
+				frequency[i*outStride] = pitch->Estimate(frames + i*stride, confidence[i*outStride], scratch);
+			}
+		}
+
+		//A batch shared by the threads of EstimateBatch(), which take MIN_FRAMES_PER_THREAD frames at a time
+		struct Batch_T{
+			const DFTPitch *Pitch;
+			const double *Frames;
+			unsigned int Stride;
+			unsigned int Count;
+			double *Frequency;
+			double *Confidence;
+			unsigned int OutStride;
+			atomic<unsigned int> Next;		//First frame not taken
+			atomic<bool> Failed;			//Whether a thread has thrown
+			mutex Lock;						//Guards what follows
+			int ErrorCode;					//What it threw first
+			string ErrorMessage;
+		};
+		//Body of the threads, and of the calling thread. Exceptions are kept for the calling thread to throw.
+		void EstimateShare(Batch_T *batch){
+			int code;
+			string message;
+			try{
+				while (!batch->Failed){
+					unsigned int begin = batch->Next.fetch_add(MIN_FRAMES_PER_THREAD);
+					if (begin >= batch->Count){
+						return;
+					}
+					EstimateRange(batch->Pitch, batch->Frames, batch->Stride, begin, min(batch->Count, begin + MIN_FRAMES_PER_THREAD),
+						batch->Frequency, batch->Confidence, batch->OutStride);
+				}
+				return;
+			}
+			catch(Exception &e){
+				code = e.GetErrorCode();
+				message = e.GetErrorMessage();
+			}
+			catch(bad_alloc &){
+				code = EXCEPTION_MEMORY_ERROR;
+				message = "Out of memory.";
+			}
+			catch(...){
+				code = EXCEPTION_UNEXPECTED;
+				message = "Unexpected error while estimating the pitch.";
+			}
+			lock_guard<mutex> lock(batch->Lock);
+			if (!batch->Failed){
+				batch->ErrorCode = code;
+				batch->ErrorMessage = message;
+				batch->Failed = true;
+			}
+		}
+	}
+
+	//Constructor
+	DFTPitch::DFTPitch(double sampleRate, double minimum, double maximum, unsigned int hop, double threshold, unsigned int threads)
+		: SampleRate(sampleRate), MinLag(0), MaxLag(0), Window(0), Hop(hop), Threshold(threshold), Threads(threads), Plan(NULL){
+		if (sampleRate <= 0 || minimum <= 0 || maximum <= minimum){
+			throw Exception(EXCEPTION_DATA_INVALID, "Sample rate and frequencies must be positive, with the maximum above the minimum!");
+		}
+		MinLag = unsigned(floor(sampleRate/maximum));
+		MaxLag = unsigned(ceil(sampleRate/minimum));
+		if (MinLag < 2 || MaxLag < MinLag + 2){
+			throw Exception(EXCEPTION_DATA_INVALID, "Frequency range does not fit the sample rate!");
+		}
+		Window = MaxLag;
+		if (!Hop){
+			Hop = max(1U, GetFrameSize()/4);
+		}
+		if (!Threads){
+			Threads = max(1U, thread::hardware_concurrency());
+		}
+		//Linear correlation of every lag up to MaxLag without wrapping around
+		unsigned int n = 2;
+		while (n < Window + MaxLag){
+			n <<= 1;
+		}
+		Plan = &DFTPlan::Get(n);
+	}
+
+	//Prepare()
+	void DFTPitch::Prepare(Scratch_T &scratch) const{
+		unsigned int n = Plan->GetSize();
+		if (scratch.Lagged.size() != n){
+			scratch.Lagged.assign(n, 0);
+			scratch.Windowed.assign(n, 0);
+			scratch.Spectrum.resize(Plan->GetRealSize());
+			scratch.Cross.resize(Plan->GetRealSize());
+			scratch.Correlation.resize(n);
+			scratch.Difference.resize(MaxLag + 1);
+		}
+	}
+
+	//Estimate()
+	double DFTPitch::Estimate(const double *frame, double &confidence, Scratch_T &scratch) const{
+		Prepare(scratch);
+		unsigned int size = GetFrameSize();
+		//The padding beyond the frame and the window stays zero from Prepare()
+		copy(frame, frame + size, scratch.Lagged.begin());
+		copy(frame, frame + Window, scratch.Windowed.begin());
+		Plan->ForwardReal(&scratch.Lagged[0], &scratch.Spectrum[0]);
+		Plan->ForwardReal(&scratch.Windowed[0], &scratch.Cross[0]);
+		//r(tau) = sum x[j] x[j+tau] is the inverse transform of conj(W) L
+		for (unsigned int k = 0; k < scratch.Cross.size(); k++){
+			const complex<double> &a = scratch.Cross[k], &b = scratch.Spectrum[k];
+			scratch.Cross[k] = complex<double>(a.real()*b.real() + a.imag()*b.imag(), a.real()*b.imag() - a.imag()*b.real());
+		}
+		Plan->InverseReal(&scratch.Cross[0], &scratch.Correlation[0]);
+
+		//Cumulative mean normalised difference, with the energy of the lagged window slid along the frame
+		double *normalised = &scratch.Difference[0];
+		double energy0 = 0;
+		for (unsigned int j = 0; j < Window; j++){
+			energy0 += frame[j]*frame[j];
+		}
+		double energy = energy0, sum = 0;
+		normalised[0] = 1;
+		for (unsigned int tau = 1; tau <= MaxLag; tau++){
+			energy += frame[tau + Window - 1]*frame[tau + Window - 1] - frame[tau - 1]*frame[tau - 1];
+			double d = max(0.0, energy0 + energy - 2*scratch.Correlation[tau]);
+			sum += d;
+			normalised[tau] = (sum > 0) ? d*tau/sum : 1;
+		}
+
+		//First dip below the threshold, followed down to its minimum. Otherwise the global minimum.
+		unsigned int best = 0;
+		for (unsigned int tau = MinLag; tau <= MaxLag; tau++){
+			if (normalised[tau] < Threshold){
+				while (tau < MaxLag && normalised[tau+1] < normalised[tau]){
+					tau++;
+				}
+				best = tau;
+				break;
+			}
+		}
+		if (!best){
+			best = MinLag;
+			for (unsigned int tau = MinLag + 1; tau <= MaxLag; tau++){
+				if (normalised[tau] < normalised[best]){
+					best = tau;
+				}
+			}
+		}
+
+		//Parabolic interpolation
+		double offset = 0, value = normalised[best];
+		if (best > MinLag && best < MaxLag){
+			double a = normalised[best-1], b = normalised[best], c = normalised[best+1];
+			double curvature = a - 2*b + c;
+			if (curvature > 0){
+				offset = 0.5*(a - c)/curvature;
+				value = b - 0.25*(a - c)*offset;
+			}
+		}
+		confidence = min(1.0, max(0.0, 1 - value));
+		return SampleRate/(best + offset);
+	}
+	double DFTPitch::Estimate(const double *frame, double &confidence) const{
+		Scratch_T scratch;
+		return Estimate(frame, confidence, scratch);
+	}
+
+	//EstimateBatch()
+	void DFTPitch::EstimateBatch(const double *frames, unsigned int stride, unsigned int count,
+		double *frequency, double *confidence, unsigned int outStride) const{
+		unsigned int workers = min(Threads, count/MIN_FRAMES_PER_THREAD);
+		if (workers <= 1){
+			EstimateRange(this, frames, stride, 0, count, frequency, confidence, outStride);
+			return;
+		}
+		//The threads, the calling thread among them, take frames as they go. If a thread cannot be started, those
+		//started and the calling thread do its share.
+		Batch_T batch;
+		batch.Pitch = this;
+		batch.Frames = frames;
+		batch.Stride = stride;
+		batch.Count = count;
+		batch.Frequency = frequency;
+		batch.Confidence = confidence;
+		batch.OutStride = outStride;
+		batch.Next = 0;
+		batch.Failed = false;
+		batch.ErrorCode = 0;
+		vector<thread> pool;
+		try{
+			pool.reserve(workers - 1);
+			for (unsigned int w = 0; w + 1 < workers; w++){
+				pool.push_back(thread(EstimateShare, &batch));
+			}
+		}
+		catch(...){
+		}
+		EstimateShare(&batch);
+		for (unsigned int w = 0; w < pool.size(); w++){
+			pool[w].join();
+		}
+		if (batch.Failed){
+			throw Exception(batch.ErrorCode, batch.ErrorMessage.c_str());
+		}
+	}
+
+	//Track()
+	void DFTPitch::Track(Wave::WaveFile &wave, DFTPitchTrack &track) const{
+		if (wave.SampleRate() != SampleRate){
+			throw Exception(EXCEPTION_DATA_INVALID, "Sample rate of the file does not match the tracker.");
+		}
+		unsigned int channels = wave.NumChannels();
+		if (!channels){
+			throw Exception(EXCEPTION_DATA_INVALID, "File has no channels.");
+		}
+		unsigned int size = GetFrameSize();
+		track.Channels = channels;
+		track.FrameInterval = Hop/SampleRate;
+		track.FrameOffset = (Window/2)/SampleRate;
+		track.Frequency.clear();
+		track.Confidence.clear();
+
+		//Samples of the frames of the current batch. Channel major, capacity per channel
+		unsigned int read = BATCH_FRAMES*Hop;
+		unsigned int capacity = size + read;
+		vector<double> history(channels*capacity), chunk(read*channels);
+		unsigned int filled = 0;
+		wave.DataRewind();
+		unsigned int blocks;
+		while ((blocks = wave.DataNextBlocks(&chunk[0], read)) != 0){
+			//De-interleave
+			for (unsigned int c = 0; c < channels; c++){
+				double *samples = &history[c*capacity + filled];
+				for (unsigned int i = 0; i < blocks; i++){
+					samples[i] = chunk[i*channels + c];
+				}
+			}
+			filled += blocks;
+			if (filled < size){
+				continue;
+			}
+			unsigned int count = (filled - size)/Hop + 1;
+			unsigned int first = track.NumFrames();
+			track.Frequency.resize((first + count)*channels);
+			track.Confidence.resize((first + count)*channels);
+			for (unsigned int c = 0; c < channels; c++){
+				EstimateBatch(&history[c*capacity], Hop, count,
+					&track.Frequency[first*channels + c], &track.Confidence[first*channels + c], channels);
+			}
+			//Keep the samples of the frames still to come
+			unsigned int consumed = count*Hop;
+			for (unsigned int c = 0; c < channels; c++){
+				double *samples = &history[c*capacity];
+				copy(samples + consumed, samples + filled, samples);
+			}
+			filled -= consumed;
+		}
+	}
+}
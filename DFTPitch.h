@@ -0,0 +1,106 @@
+/*
+	Pitch Tracking
+
+	DFTPitch
+	Fundamental frequency estimation with the YIN algorithm.
+	cf de Cheveigne & Kawahara, "YIN, a fundamental frequency estimator for speech and music", JASA 2002
+
+	For a frame of Window + MaxLag samples the difference function
+		d(tau) = sum_{j<Window} (x[j] - x[j+tau])^2 = e(0) + e(tau) - 2 r(tau)
+	is built from the energies e(tau) of the lagged windows, taken from a running sum of squares, and the cross
+	correlation r(tau) of the first Window samples with the whole frame. r is computed for every lag at once with
+	one real forward transform of each and one real inverse transform, all through a power of two plan that is
+	looked up once, instead of the O(Window*MaxLag) direct sums.
+	The cumulative mean normalised difference d'(tau) = d(tau) tau / sum_{1..tau} d is then searched for the first
+	dip below the threshold between the lags of the highest and lowest frequency, and the lag is refined by
+	parabolic interpolation. Without such a dip the global minimum is taken. The confidence is 1 - d'(tau):
+	close to 1 for periodic frames and low for noise or silence.
+
+	Track() streams a WaveFile frame by frame. Frames are gathered in batches and the frames of a batch,
+	channel after channel, are shared among worker threads that each own their scratch space.
+
+	DFTPitchTrack
+	The result: a frequency and a confidence per frame and channel, row = frame*NumChannels() + channel.
+*/
+#pragma once
+#ifndef DFTPitch_H
+#define DFTPitch_H
+
+#include <vector>
+#include <complex>
+#include "DFTPlan.h"
+#include "WaveFile.h"
+
+namespace DFT{
+	/************** DFTPitchTrack ****************/
+	struct DFTPitchTrack{
+		unsigned int Channels;					//Number of channels
+		double FrameInterval;					//Time between the start of consecutive frames
+		double FrameOffset;						//Time of the centre of the first frame
+		std::vector<double> Frequency;			//Fundamental frequency in Hz
+		std::vector<double> Confidence;			//Within [0, 1]
+
+		DFTPitchTrack(): Channels(0), FrameInterval(1.0), FrameOffset(0){}
+		unsigned int NumFrames() const{ return Channels ? unsigned(Frequency.size())/Channels : 0; }
+		double GetFrameTime(unsigned int frame) const{ return FrameOffset + frame*FrameInterval; }
+	};
+
+	/************** DFTPitch ****************/
+	class DFTPitch{
+	public:
+		//Scratch space for one frame. Each thread needs its own.
+		struct Scratch_T{
+			std::vector<double> Lagged;					//Frame, zero padded to the transform length
+			std::vector<double> Windowed;				//First Window samples, zero padded
+			std::vector<std::complex<double> > Spectrum;
+			std::vector<std::complex<double> > Cross;
+			std::vector<double> Correlation;
+			std::vector<double> Difference;
+		};
+
+	private:
+		double SampleRate;						//Samples per second
+		unsigned int MinLag;					//Lag of the highest frequency
+		unsigned int MaxLag;					//Lag of the lowest frequency
+		unsigned int Window;					//Integration window
+		unsigned int Hop;						//Samples between the start of consecutive frames
+		double Threshold;						//Absolute threshold on d'
+		unsigned int Threads;					//Worker threads for Track()
+		const DFTPlan *Plan;					//Cached plan of at least Window + MaxLag
+
+		//Not copyable
+		DFTPitch(const DFTPitch &);
+		DFTPitch &operator=(const DFTPitch &);
+
+	protected:
+		void Prepare(Scratch_T &scratch) const;		//Size the scratch space
+
+	public:
+		//Track frequencies between minimum and maximum in Hz. The integration window is one period of the minimum
+		//frequency. hop is in samples; zero means a quarter of the frame. threads of zero uses one per core.
+		DFTPitch(double sampleRate, double minimum=60, double maximum=800, unsigned int hop=0, double threshold=0.1, unsigned int threads=0);
+
+		//Estimate the frequency of a frame of GetFrameSize() samples. Returns the frequency in Hz and sets confidence.
+		double Estimate(const double *frame, double &confidence, Scratch_T &scratch) const;
+		double Estimate(const double *frame, double &confidence) const;
+
+		//Estimate count frames, frame i starting at frames + i*stride, and write the results to frequency[i] and confidence[i]
+		//scaled by outStride. The frames are shared among the worker threads; what one throws is thrown once all have stopped.
+		void EstimateBatch(const double *frames, unsigned int stride, unsigned int count,
+			double *frequency, double *confidence, unsigned int outStride=1) const;
+
+		//Stream the data chunk of the wave file and estimate every frame of every channel.
+		//The file is read batch by batch so it need not fit in memory. Its sample rate must match.
+		void Track(Wave::WaveFile &wave, DFTPitchTrack &track) const;
+
+		//Getters
+		unsigned int GetFrameSize() const{ return Window + MaxLag; }
+		unsigned int GetWindow() const{ return Window; }
+		unsigned int GetHop() const{ return Hop; }
+		unsigned int GetMinLag() const{ return MinLag; }
+		unsigned int GetMaxLag() const{ return MaxLag; }
+		unsigned int NumThreads() const{ return Threads; }
+	};
+}
+
+#endif /*DFTPitch_H*/
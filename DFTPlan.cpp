@@ -0,0 +1,250 @@
+//DFTPlan.cpp
+#include <cmath>
+#include <map>
+#include <mutex>
+#include "DFTPlan.h"
+#include "DFTUtility.h"
+#include "DFTPool.h"
+
+using namespace std;
+namespace DFT{
+	/*
+		Plan cache
+	*/
+	namespace{
+		//Owns every plan handed out by DFTPlan::Get()
+		struct PlanCache_T{
+			map<unsigned int, DFTPlan*> Plans;
+			recursive_mutex Lock;		//Guards the map. Recursive, as constructing a plan may Get() others
+			~PlanCache_T(){
+				map<unsigned int, DFTPlan*>::iterator it;
+				for (it = Plans.begin(); it != Plans.end(); it++){
+					delete it->second;
+				}
+			}
+		};
+		PlanCache_T &PlanCache(){
+			static PlanCache_T cache;
+			return cache;
+		}
+		//Construct the cache while there is a single thread
+		PlanCache_T &Constructed = PlanCache();
+
+		//Scratch space of a transform, drawn from the pool
+		typedef vector<complex<double>, DFTPoolAllocator<complex<double> > > Scratch_T;
+
+		//Multiply two complex numbers without the NaN handling that std::complex does
+		inline complex<double> Multiply(const complex<double> &a, const complex<double> &b){
+			return complex<double>(a.real()*b.real() - a.imag()*b.imag(), a.real()*b.imag() + a.imag()*b.real());
+		}
+	}
+
+	//Get()
+	const DFTPlan &DFTPlan::Get(unsigned int n){
+		PlanCache_T &cache = PlanCache();
+		lock_guard<recursive_mutex> lock(cache.Lock);
+		map<unsigned int, DFTPlan*>::iterator it = cache.Plans.find(n);
+		if (it != cache.Plans.end()){
+			return *it->second;
+		}
+		//Constructing a plan may recursively Get() other plans, so insert only after construction
+		DFTPlan *plan = new DFTPlan(n);
+		cache.Plans[n] = plan;
+		return *plan;
+	}
+
+	//Constructor
+	DFTPlan::DFTPlan(unsigned int n): Size(n), IsPowerOfTwo(false), Convolution(NULL), Half(NULL){
+		if (!n){
+			throw Exception(EXCEPTION_DATA_INVALID, "Transform length cannot be zero!");
+		}
+		IsPowerOfTwo = (n & (n-1)) == 0;
+
+		if (IsPowerOfTwo){
+			//Twiddle factors
+			Twiddle.resize(n/2);
+			for (unsigned int k = 0; k < n/2; k++){
+				double angle = -2*PI*k/n;
+				Twiddle[k] = complex<double>(cos(angle), sin(angle));
+			}
+			//Bit reversal table
+			unsigned int bits = 0;
+			while ((1U << bits) < n){
+				bits++;
+			}
+			Reverse.resize(n);
+			for (unsigned int i = 0; i < n; i++){
+				unsigned int r = 0;
+				for (unsigned int b = 0; b < bits; b++){
+					r |= ((i >> b) & 1U) << (bits-1-b);
+				}
+				Reverse[i] = r;
+			}
+		}
+		else{
+			//Bluestein - convolution length must be at least 2N-1
+			unsigned int m = 1;
+			while (m < 2*n-1){
+				m <<= 1;
+			}
+			Convolution = &Get(m);
+
+			Chirp.resize(n);
+			for (unsigned int k = 0; k < n; k++){
+				//k^2 mod 2N keeps the angle small and precise for large k
+				unsigned long long k2 = ((unsigned long long)k*k) % (2ULL*n);
+				double angle = -PI*double(k2)/n;
+				Chirp[k] = complex<double>(cos(angle), sin(angle));
+			}
+			ChirpSpectrum.assign(m, complex<double>(0,0));
+			ChirpSpectrum[0] = conj(Chirp[0]);
+			for (unsigned int k = 1; k < n; k++){
+				ChirpSpectrum[k] = ChirpSpectrum[m-k] = conj(Chirp[k]);
+			}
+			Convolution->Forward(&ChirpSpectrum[0]);
+		}
+
+		//Real input path
+		if (n % 2 == 0){
+			Half = &Get(n/2);
+			RealTwiddle.resize(n/2+1);
+			for (unsigned int k = 0; k <= n/2; k++){
+				double angle = -2*PI*k/n;
+				RealTwiddle[k] = complex<double>(cos(angle), sin(angle));
+			}
+		}
+	}
+
+	//Radix2()
+	void DFTPlan::Radix2(complex<double> *data) const{
+		//Bit reversal permutation
+		for (unsigned int i = 0; i < Size; i++){
+			unsigned int r = Reverse[i];
+			if (r > i){
+				swap(data[i], data[r]);
+			}
+		}
+		//Butterflies
+		for (unsigned int length = 2; length <= Size; length <<= 1){
+			unsigned int half = length/2;
+			unsigned int step = Size/length;
+			for (unsigned int i = 0; i < Size; i += length){
+				complex<double> *a = data + i, *b = data + i + half;
+				for (unsigned int j = 0; j < half; j++){
+					complex<double> v = Multiply(b[j], Twiddle[j*step]);
+					b[j] = a[j] - v;
+					a[j] += v;
+				}
+			}
+		}
+	}
+
+	//Bluestein()
+	void DFTPlan::Bluestein(complex<double> *data) const{
+		unsigned int m = Convolution->GetSize();
+		Scratch_T work(m, complex<double>(0,0));
+		for (unsigned int k = 0; k < Size; k++){
+			work[k] = Multiply(data[k], Chirp[k]);
+		}
+		Convolution->Forward(&work[0]);
+		for (unsigned int k = 0; k < m; k++){
+			work[k] = Multiply(work[k], ChirpSpectrum[k]);
+		}
+		Convolution->Inverse(&work[0]);
+		for (unsigned int k = 0; k < Size; k++){
+			data[k] = Multiply(work[k], Chirp[k]);
+		}
+	}
+
+	//Forward()
+	void DFTPlan::Forward(complex<double> *data) const{
+		if (Size == 1){
+			return;
+		}
+		if (IsPowerOfTwo){
+			Radix2(data);
+		}
+		else{
+			Bluestein(data);
+		}
+	}
+
+	//Inverse()
+	//Uses ifft(x) = conj(fft(conj(x)))/N
+	void DFTPlan::Inverse(complex<double> *data) const{
+		for (unsigned int i = 0; i < Size; i++){
+			data[i] = conj(data[i]);
+		}
+		Forward(data);
+		double scale = 1.0/Size;
+		for (unsigned int i = 0; i < Size; i++){
+			data[i] = complex<double>(data[i].real()*scale, -data[i].imag()*scale);
+		}
+	}
+
+	//ForwardReal()
+	void DFTPlan::ForwardReal(const double *in, complex<double> *out) const{
+		if (!Half){
+			//Odd length. No packing trick available
+			Scratch_T work(in, in+Size);
+			Forward(&work[0]);
+			for (unsigned int k = 0; k < GetRealSize(); k++){
+				out[k] = work[k];
+			}
+			return;
+		}
+		//Pack even samples into the real part and odd samples into the imaginary part
+		unsigned int n = Size/2;
+		for (unsigned int i = 0; i < n; i++){
+			out[i] = complex<double>(in[2*i], in[2*i+1]);
+		}
+		Half->Forward(out);
+
+		//Untangle. With Z the half length transform:
+		//	E[k] = (Z[k] + conj(Z[n-k]))/2, O[k] = (Z[k] - conj(Z[n-k]))/2i, X[k] = E[k] + W^k O[k]
+		complex<double> z0 = out[0];
+		out[0] = complex<double>(z0.real() + z0.imag(), 0);
+		out[n] = complex<double>(z0.real() - z0.imag(), 0);
+		for (unsigned int k = 1; k <= n/2; k++){
+			unsigned int m = n - k;
+			complex<double> a = out[k], b = conj(out[m]);
+			complex<double> even = (a + b)*0.5;
+			complex<double> odd = (a - b)*complex<double>(0,-0.5);
+			out[k] = even + Multiply(RealTwiddle[k], odd);
+			out[m] = conj(even) + Multiply(RealTwiddle[m], conj(odd));
+		}
+	}
+
+	//InverseReal()
+	void DFTPlan::InverseReal(const complex<double> *in, double *out) const{
+		if (!Half){
+			//Odd length. Rebuild the full spectrum from the conjugate symmetry
+			Scratch_T work(Size);
+			for (unsigned int k = 0; k < GetRealSize(); k++){
+				work[k] = in[k];
+			}
+			for (unsigned int k = GetRealSize(); k < Size; k++){
+				work[k] = conj(in[Size-k]);
+			}
+			Inverse(&work[0]);
+			for (unsigned int i = 0; i < Size; i++){
+				out[i] = work[i].real();
+			}
+			return;
+		}
+		//Reverse of the untangling done in ForwardReal()
+		unsigned int n = Size/2;
+		Scratch_T work(n);
+		for (unsigned int k = 0; k < n; k++){
+			complex<double> a = in[k], b = conj(in[n-k]);
+			complex<double> even = (a + b)*0.5;
+			complex<double> odd = Multiply(a - b, conj(RealTwiddle[k]))*0.5;
+			work[k] = even + Multiply(complex<double>(0,1), odd);
+		}
+		Half->Inverse(&work[0]);
+		for (unsigned int i = 0; i < n; i++){
+			out[2*i] = work[i].real();
+			out[2*i+1] = work[i].imag();
+		}
+	}
+}
@@ -0,0 +1,76 @@
+/*
+	DFTPlan
+
+	A native Fast Fourier Transform "plan" so that the DFT classes do not have to go through Matlab
+	for every transform.
+
+	A plan holds everything that can be precomputed for a transform of a given length:
+		- Power of two lengths use an iterative radix-2 transform with a precomputed twiddle and bit reversal table
+		- All other lengths use Bluestein's algorithm, i.e. a chirp-z convolution through a power of two plan
+		- Even lengths additionally get a real input path that packs the signal into a complex transform of half the length
+
+	Plans are immutable once constructed. Use DFTPlan::Get() to retrieve a cached plan instead of constructing
+	one for every transform.
+
+	Conventions follow Matlab's fft and ifft:
+		Forward: X[k] = sum x[n] exp(-2 pi i k n / N)
+		Inverse: x[n] = 1/N sum X[k] exp(2 pi i k n / N)
+
+	cf http://en.wikipedia.org/wiki/Cooley%E2%80%93Tukey_FFT_algorithm
+	   http://en.wikipedia.org/wiki/Bluestein%27s_FFT_algorithm
+*/
+#pragma once
+#ifndef DFTPlan_H
+#define DFTPlan_H
+
+#include <complex>
+#include <vector>
+#include "Exception.h"
+
+namespace DFT{
+	class DFTPlan{
+		unsigned int Size;									//Length of the transform
+		bool IsPowerOfTwo;									//Whether the radix-2 path is used
+		std::vector<std::complex<double> > Twiddle;			//Radix-2 twiddle factors exp(-2 pi i k / N) for k < N/2
+		std::vector<unsigned int> Reverse;					//Radix-2 bit reversal permutation
+
+		//Bluestein
+		const DFTPlan *Convolution;							//Power of two plan used for the convolution
+		std::vector<std::complex<double> > Chirp;			//exp(-pi i n^2 / N)
+		std::vector<std::complex<double> > ChirpSpectrum;	//Transform of the conjugate chirp, zero padded
+
+		//Real input path. Only set up for even lengths
+		const DFTPlan *Half;								//Plan for N/2
+		std::vector<std::complex<double> > RealTwiddle;		//exp(-2 pi i k / N) for k <= N/2
+
+		//Copying a plan is pointless. Use Get()
+		DFTPlan(const DFTPlan &);
+		DFTPlan &operator=(const DFTPlan &);
+
+	protected:
+		void Radix2(std::complex<double> *data) const;			//In place radix-2 forward transform
+		void Bluestein(std::complex<double> *data) const;		//In place Bluestein forward transform
+
+	public:
+		//Construct a plan for a transform of length n. Throws if n is zero.
+		explicit DFTPlan(unsigned int n);
+
+		unsigned int GetSize() const{ return Size; }				//Length of the transform
+		unsigned int GetRealSize() const{ return Size/2 + 1; }		//Number of bins produced by the real input path
+
+		//Complex transforms. In place, data must hold GetSize() elements
+		void Forward(std::complex<double> *data) const;		//Forward transform. Not normalised
+		void Inverse(std::complex<double> *data) const;		//Inverse transform. Scaled by 1/N
+
+		//Real input transforms. Only the non-negative frequencies (GetRealSize() bins) are produced or consumed
+		//as the rest of the spectrum is the complex conjugate of these.
+		//in has GetSize() samples. in may be the storage of out, read as doubles, for an in place transform.
+		void ForwardReal(const double *in, std::complex<double> *out) const;
+		void InverseReal(const std::complex<double> *in, double *out) const;		//out has GetSize() samples. Scaled by 1/N
+
+		//Get a cached plan for the length n. Plans are created on first use and live until the program exits. Thread safe.
+		static const DFTPlan &Get(unsigned int n);
+	};
+}
+
+#endif /*DFTPlan_H*/
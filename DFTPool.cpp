@@ -0,0 +1,203 @@
+//DFTPool.cpp
+#include <cstdlib>
+#include <functional>
+#include <thread>
+#include "DFTPool.h"
+#ifdef _WIN32
+#include <windows.h>
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+
+using namespace std;
+namespace DFT{
+	namespace{
+		const unsigned int MIN_SHIFT = 6;					//Smallest class, 64 bytes
+		const unsigned long long CAPACITY = 256ULL << 20;	//Bytes kept by default
+
+		//Construct the pool while there is a single thread
+		DFTPool &Constructed = DFTPool::Get();
+
+		//Index of the highest bit set
+		unsigned int HighBit(size_t x){
+			unsigned int bit = 0;
+			while (x >>= 1){
+				bit++;
+			}
+			return bit;
+		}
+	}
+
+	//Get()
+	//Never destroyed, so that objects destroyed after it at exit can still release their blocks
+	DFTPool &DFTPool::Get(){
+		static DFTPool *pool = new DFTPool;
+		return *pool;
+	}
+
+	//Constructor
+	DFTPool::DFTPool(): Capacity(CAPACITY), Kept(0), HugePages(false), Fresh(0), Reused(0){
+	}
+
+	//ClassOf()
+	unsigned int DFTPool::ClassOf(size_t bytes){
+		if (bytes <= (size_t(1) << MIN_SHIFT)){
+			return 0;
+		}
+		//Four classes per power of two: 5/4, 6/4, 7/4 and 8/4 of the power below
+		size_t b = bytes - 1;
+		unsigned int shift = HighBit(b);
+		unsigned int c = (shift - MIN_SHIFT)*4 + unsigned((b >> (shift - 2)) & 3) + 1;
+		return (c < CLASSES) ? c : unsigned(CLASSES);
+	}
+
+	//ClassSize()
+	size_t DFTPool::ClassSize(unsigned int c){
+		if (!c){
+			return size_t(1) << MIN_SHIFT;
+		}
+		unsigned int shift = (c - 1)/4 + MIN_SHIFT;
+		return size_t(4 + (c - 1)%4 + 1) << (shift - 2);
+	}
+
+	//Local()
+	DFTPool::Shard_T &DFTPool::Local(){
+		return Shards[hash<thread::id>()(this_thread::get_id()) % SHARDS];
+	}
+
+	//System()
+	void *DFTPool::System(size_t bytes){
+		void *block = NULL;
+		if (bytes < LARGE_BLOCK){
+#ifdef _WIN32
+			block = _aligned_malloc(bytes, DFT_ALIGNMENT);
+#else
+			if (posix_memalign(&block, DFT_ALIGNMENT, bytes)){
+				block = NULL;
+			}
+#endif
+		}
+		else{
+			bool huge = HugePages && bytes >= HUGE_PAGE;
+#ifdef _WIN32
+			if (huge){
+				//Large pages come in multiples of their size and only to processes holding the privilege
+				size_t page = GetLargePageMinimum();
+				if (page){
+					block = VirtualAlloc(NULL, (bytes + page - 1)/page*page, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+				}
+			}
+			if (!block){
+				block = VirtualAlloc(NULL, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+			}
+#else
+			block = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (block == MAP_FAILED){
+				block = NULL;
+			}
+#ifdef MADV_HUGEPAGE
+			else if (huge){
+				madvise(block, bytes, MADV_HUGEPAGE);
+			}
+#endif
+#endif
+		}
+		if (!block){
+			throw bad_alloc();
+		}
+		Fresh++;
+		return block;
+	}
+
+	//Return()
+	void DFTPool::Return(void *block, size_t bytes){
+		if (bytes < LARGE_BLOCK){
+#ifdef _WIN32
+			_aligned_free(block);
+#else
+			free(block);
+#endif
+			return;
+		}
+#ifdef _WIN32
+		VirtualFree(block, 0, MEM_RELEASE);
+#else
+		munmap(block, bytes);
+#endif
+	}
+
+	//Allocate()
+	void *DFTPool::Allocate(size_t bytes){
+		unsigned int c = ClassOf(bytes);
+		if (c == CLASSES){
+			return System(bytes);
+		}
+		//The shard of the thread first, then the others
+		Shard_T *local = &Local();
+		for (unsigned int s = 0; s < SHARDS; s++){
+			Shard_T &shard = Shards[(local - Shards + s) % SHARDS];
+			lock_guard<mutex> lock(shard.Lock);
+			if (!shard.Free[c].empty()){
+				void *block = shard.Free[c].back();
+				shard.Free[c].pop_back();
+				Kept -= ClassSize(c);
+				Reused++;
+				return block;
+			}
+		}
+		return System(ClassSize(c));
+	}
+
+	//Release()
+	void DFTPool::Release(void *block, size_t bytes){
+		if (!block){
+			return;
+		}
+		unsigned int c = ClassOf(bytes);
+		if (c == CLASSES){
+			Return(block, bytes);
+			return;
+		}
+		size_t size = ClassSize(c);
+		//Reserve the room first, so that threads releasing at once do not overshoot
+		if (Kept.fetch_add(size) + size > Capacity){
+			Kept -= size;
+			Return(block, size);
+			return;
+		}
+		Shard_T &shard = Local();
+		try{
+			lock_guard<mutex> lock(shard.Lock);
+			shard.Free[c].push_back(block);
+		}
+		catch(...){
+			//No room to keep it
+			Kept -= size;
+			Return(block, size);
+		}
+	}
+
+	//Trim()
+	void DFTPool::Trim(){
+		for (unsigned int s = 0; s < SHARDS; s++){
+			lock_guard<mutex> lock(Shards[s].Lock);
+			for (unsigned int c = 0; c < CLASSES; c++){
+				vector<void*> &blocks = Shards[s].Free[c];
+				for (size_t i = 0; i < blocks.size(); i++){
+					Return(blocks[i], ClassSize(c));
+				}
+				Kept -= blocks.size()*ClassSize(c);
+				vector<void*>().swap(blocks);
+			}
+		}
+	}
+
+	//SetCapacity()
+	void DFTPool::SetCapacity(unsigned long long bytes){
+		Capacity = bytes;
+		if (Kept > Capacity){
+			Trim();
+		}
+	}
+}
@@ -0,0 +1,126 @@
+/*
+	DFTPool
+
+	A pool of memory blocks for the buffers that are allocated over and over again: the data of DFTGeneric and DFTReal
+	objects, the scratch space of the transforms and the read buffers of WaveFile. Batch processing allocates the
+	same sizes for every file and every frame; the pool hands the blocks released by one back to the next, so that
+	once warm no large block is asked of the system and no fresh page is faulted in.
+
+	Blocks are sorted in size classes, four per power of two, so that a block is at most 25% larger than asked.
+	Blocks larger than the largest class, 2 GB, are not pooled.
+	Released blocks are kept in one of several shards picked by the id of the releasing thread, each with a lock of
+	its own, so that threads hardly ever contend for a lock. This stands in for thread local caches, which the
+	compilers targeted do not offer for objects with destructors. A thread that misses in its shard looks in the
+	others before going to the system.
+	At most Capacity bytes are kept; blocks released past that go back to the system. Trim() returns them all.
+
+	Every block is aligned on DFT_ALIGNMENT bytes. Blocks of LARGE_BLOCK bytes and more are whole pages from the system
+	(VirtualAlloc, mmap), zero filled when fresh. With SetHugePages(true), those of HUGE_PAGE bytes and more are
+	backed by huge pages where the system allows: MEM_LARGE_PAGES, which needs SeLockMemoryPrivilege, or
+	madvise(MADV_HUGEPAGE). Otherwise normal pages are used.
+
+	The pool is created before main() and lives as long as the program. Use DFTPool::Get().
+
+	DFTPoolAllocator
+	A standard allocator drawing from the pool, for std::vector and the like.
+*/
+#pragma once
+#ifndef DFTPool_H
+#define DFTPool_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+#include <mutex>
+#include <atomic>
+
+namespace DFT{
+	const unsigned int DFT_ALIGNMENT = 64;		//Bytes
+
+	/************** DFTPool ****************/
+	class DFTPool{
+	public:
+		enum { CLASSES = 101, SHARDS = 16 };
+		static const size_t LARGE_BLOCK = 65536;			//Blocks from here on are pages from the system
+		static const size_t HUGE_PAGE = 2097152;			//Blocks from here on can be huge pages
+
+	private:
+		struct Shard_T{
+			std::mutex Lock;
+			std::vector<void*> Free[CLASSES];		//Released blocks of each class
+		};
+		Shard_T Shards[SHARDS];
+		std::atomic<unsigned long long> Capacity;	//Bytes that may be kept
+		std::atomic<unsigned long long> Kept;		//Bytes kept
+		std::atomic<bool> HugePages;
+
+		//Statistics
+		std::atomic<unsigned long long> Fresh;		//Blocks from the system
+		std::atomic<unsigned long long> Reused;		//Blocks from the pool
+
+		DFTPool();
+		DFTPool(const DFTPool &);
+		DFTPool &operator=(const DFTPool &);
+
+	protected:
+		static unsigned int ClassOf(size_t bytes);		//Class of the blocks for a request of bytes. CLASSES if too large.
+		static size_t ClassSize(unsigned int c);		//Bytes of the blocks of a class
+		Shard_T &Local();								//Shard of the calling thread
+		void *System(size_t bytes);						//Block from the system
+		static void Return(void *block, size_t bytes);	//Back to the system
+
+	public:
+		static DFTPool &Get();
+
+		//A block of at least bytes, aligned on DFT_ALIGNMENT. Throws bad_alloc. Content is undefined.
+		void *Allocate(size_t bytes);
+		//Release a block from Allocate(); bytes is what was asked for
+		void Release(void *block, size_t bytes);
+		void Trim();								//Give every block kept back to the system
+
+		//Setters
+		void SetCapacity(unsigned long long bytes);
+		void SetHugePages(bool use){ HugePages = use; }
+
+		//Getters
+		unsigned long long GetCapacity() const{ return Capacity; }
+		unsigned long long GetKept() const{ return Kept; }
+		bool GetHugePages() const{ return HugePages; }
+		unsigned long long NumFresh() const{ return Fresh; }
+		unsigned long long NumReused() const{ return Reused; }
+	};
+
+	/************** DFTPoolAllocator ****************/
+	template <typename T> class DFTPoolAllocator{
+	public:
+		typedef T value_type;
+		typedef T *pointer;
+		typedef const T *const_pointer;
+		typedef T &reference;
+		typedef const T &const_reference;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+		template <typename U> struct rebind{ typedef DFTPoolAllocator<U> other; };
+
+		DFTPoolAllocator(){}
+		template <typename U> DFTPoolAllocator(const DFTPoolAllocator<U> &){}
+
+		pointer address(reference x) const{ return &x; }
+		const_pointer address(const_reference x) const{ return &x; }
+		pointer allocate(size_type n, const void * = 0){
+			if (n > max_size()){
+				throw std::bad_alloc();
+			}
+			return static_cast<pointer>(DFTPool::Get().Allocate(n*sizeof(T)));
+		}
+		void deallocate(pointer p, size_type n){ DFTPool::Get().Release(p, n*sizeof(T)); }
+		size_type max_size() const{ return size_t(-1)/sizeof(T); }
+		void construct(pointer p, const T &value){ new(static_cast<void*>(p)) T(value); }
+		void destroy(pointer p){ p->~T(); }
+
+		bool operator==(const DFTPoolAllocator &) const{ return true; }
+		bool operator!=(const DFTPoolAllocator &) const{ return false; }
+	};
+}
+
+#endif /*DFTPool_H*/
@@ -0,0 +1,222 @@
+//DFTPyramid.cpp
+#include <cmath>
+#include <limits>
+#include <fstream>
+#include <algorithm>
+#include "DFTPyramid.h"
+
+using namespace std;
+namespace DFT{
+	namespace{
+		const unsigned int STREAM_BLOCKS = 4096U;		//Blocks read from a wave file at a time
+	}
+
+	//Constructor
+	DFTPyramid::DFTPyramid(unsigned int leaf): Leaf(leaf), Samples(0), Dimensions(0), Series(0), Interval(1.0){
+		if (!leaf){
+			throw Exception(EXCEPTION_DATA_INVALID, "Buckets must hold at least one sample!");
+		}
+	}
+
+	//Start()
+	void DFTPyramid::Start(unsigned int samples, unsigned int dimensions, bool imaginary, double interval){
+		Samples = samples;
+		Dimensions = dimensions;
+		Series = imaginary ? 2*dimensions : dimensions;
+		Interval = interval;
+		Levels.assign(1, Level_T());
+		Level_T &level = Levels[0];
+		level.Bucket = Leaf;
+		level.Count = (samples + Leaf - 1)/Leaf;
+		level.Min.assign(Series*level.Count, numeric_limits<double>::max());
+		level.Max.assign(Series*level.Count, -numeric_limits<double>::max());
+		level.Energy.assign(Series*level.Count, 0);
+	}
+
+	//Add()
+	void DFTPyramid::Add(unsigned int series, unsigned int index, double value){
+		Level_T &level = Levels[0];
+		unsigned int i = series*level.Count + index/Leaf;
+		if (value < level.Min[i]){
+			level.Min[i] = value;
+		}
+		if (value > level.Max[i]){
+			level.Max[i] = value;
+		}
+		level.Energy[i] += value*value;
+	}
+
+	//Add() - DFTData
+	void DFTPyramid::Add(const DFTData &data, unsigned int begin, unsigned int end){
+		//A run of a dimension at a time through the bulk getters, which a WaveFile decodes in one pass. Samples of a
+		//series are added in the same order as one at a time.
+		bool imaginary = Series > Dimensions;
+		vector<double> real(min(STREAM_BLOCKS, end - begin)), imag(imaginary ? real.size() : 0);
+		for (unsigned int j = 0; j < Dimensions; j++){
+			for (unsigned int first = begin; first < end; first += STREAM_BLOCKS){
+				unsigned int n = min(STREAM_BLOCKS, end - first);
+				data.DFTGetSplit(j, first, n, &real[0], imaginary ? &imag[0] : NULL);
+				for (unsigned int i = 0; i < n; i++){
+					Add(j, first + i, real[i]);
+				}
+				for (unsigned int i = 0; imaginary && i < n; i++){
+					Add(Dimensions + j, first + i, imag[i]);
+				}
+			}
+		}
+	}
+
+	//Merge()
+	void DFTPyramid::Merge(unsigned int level, unsigned int first, unsigned int last){
+		const Level_T &fine = Levels[level - 1];
+		Level_T &coarse = Levels[level];
+		for (unsigned int s = 0; s < Series; s++){
+			const double *min = &fine.Min[s*fine.Count], *max = &fine.Max[s*fine.Count], *energy = &fine.Energy[s*fine.Count];
+			for (unsigned int b = first; b <= last; b++){
+				unsigned int i = s*coarse.Count + b, a = 2*b;
+				if (a + 1 < fine.Count){
+					coarse.Min[i] = std::min(min[a], min[a+1]);
+					coarse.Max[i] = std::max(max[a], max[a+1]);
+					coarse.Energy[i] = energy[a] + energy[a+1];
+				}
+				else{
+					coarse.Min[i] = min[a];
+					coarse.Max[i] = max[a];
+					coarse.Energy[i] = energy[a];
+				}
+			}
+		}
+	}
+
+	//Finish()
+	void DFTPyramid::Finish(){
+		while (Levels.back().Count > 1){
+			Levels.push_back(Level_T());
+			const Level_T &fine = Levels[Levels.size() - 2];
+			Level_T &coarse = Levels.back();
+			coarse.Bucket = fine.Bucket*2;
+			coarse.Count = (fine.Count + 1)/2;
+			coarse.Min.resize(Series*coarse.Count);
+			coarse.Max.resize(Series*coarse.Count);
+			coarse.Energy.resize(Series*coarse.Count);
+			Merge(unsigned(Levels.size() - 1), 0, coarse.Count - 1);
+		}
+	}
+
+	//Build() - DFTData
+	void DFTPyramid::Build(const DFTData &data, bool imaginary){
+		unsigned int intervals = data.DFTNumInterval(), dimensions = data.DFTDimension();
+		Start(intervals, dimensions, imaginary, data.DFTInterval());
+		Add(data, 0, intervals);
+		Finish();
+	}
+
+	//Build() - WaveFile
+	void DFTPyramid::Build(Wave::WaveFile &wave){
+		unsigned int channels = wave.NumChannels();
+		Start(wave.NumBlocks(), channels, false, wave.Interval());
+		vector<double> chunk(STREAM_BLOCKS*channels);
+		unsigned int index = 0, blocks;
+		wave.DataRewind();
+		while ((blocks = wave.DataNextBlocks(&chunk[0], STREAM_BLOCKS)) != 0){
+			for (unsigned int i = 0; i < blocks; i++, index++){
+				for (unsigned int c = 0; c < channels; c++){
+					Add(c, index, chunk[i*channels + c]);
+				}
+			}
+		}
+		Finish();
+	}
+
+	//Update()
+	void DFTPyramid::Update(const DFTData &data, unsigned int begin, unsigned int end){
+		if (begin > end || end > Samples || data.DFTNumInterval() != Samples || data.DFTDimension() != Dimensions){
+			throw Exception(EXCEPTION_RANGE, "Out of range access.");
+		}
+		if (begin == end){
+			return;
+		}
+		//Leaf buckets touched, from scratch
+		Level_T &leaf = Levels[0];
+		unsigned int first = begin/Leaf, last = (end - 1)/Leaf;
+		for (unsigned int s = 0; s < Series; s++){
+			for (unsigned int b = first; b <= last; b++){
+				unsigned int i = s*leaf.Count + b;
+				leaf.Min[i] = numeric_limits<double>::max();
+				leaf.Max[i] = -numeric_limits<double>::max();
+				leaf.Energy[i] = 0;
+			}
+		}
+		Add(data, first*Leaf, min(Samples, (last + 1)*Leaf));
+		//Then the buckets above them
+		for (unsigned int k = 1; k < Levels.size(); k++){
+			first /= 2;
+			last /= 2;
+			Merge(k, first, last);
+		}
+	}
+
+	//Query()
+	unsigned int DFTPyramid::Query(unsigned int series, unsigned int begin, unsigned int end, unsigned int width,
+		vector<double> &min, vector<double> &max, vector<double> &rms) const{
+		if (series >= Series || begin > end || end > Samples){
+			throw Exception(EXCEPTION_RANGE, "Out of range access.");
+		}
+		unsigned int span = end - begin;
+		unsigned int columns = std::min(width, (span + Leaf - 1)/Leaf);
+		min.resize(columns);
+		max.resize(columns);
+		rms.resize(columns);
+		if (!columns){
+			return 0;
+		}
+		//Coarsest level with buckets no wider than a column
+		double perColumn = double(span)/columns;
+		unsigned int k = 0;
+		while (k + 1 < Levels.size() && Levels[k+1].Bucket <= perColumn){
+			k++;
+		}
+		const Level_T &level = Levels[k];
+		unsigned int bucket = level.Bucket;
+		const double *levelMin = &level.Min[series*level.Count];
+		const double *levelMax = &level.Max[series*level.Count];
+		const double *levelEnergy = &level.Energy[series*level.Count];
+
+		for (unsigned int c = 0; c < columns; c++){
+			unsigned int first = begin + unsigned((unsigned long long)c*span/columns);
+			unsigned int last = begin + unsigned((unsigned long long)(c+1)*span/columns) - 1;
+			unsigned int b0 = first/bucket, b1 = last/bucket;
+			double low = levelMin[b0], high = levelMax[b0], energy = 0;
+			for (unsigned int b = b0; b <= b1; b++){
+				low = std::min(low, levelMin[b]);
+				high = std::max(high, levelMax[b]);
+				energy += levelEnergy[b];
+			}
+			unsigned int count = std::min(Samples, (b1 + 1)*bucket) - b0*bucket;
+			min[c] = low;
+			max[c] = high;
+			rms[c] = sqrt(energy/count);
+		}
+		return columns;
+	}
+
+	//Export()
+	void DFTPyramid::Export(const char *filename, unsigned int width) const{
+		ofstream file(filename, ios_base::out | ios_base::trunc);
+		if (!file){
+			throw Exception(EXCEPTION_FILE_CANNOT_OPEN_OUTPUT, "Unable to open file for writing.");
+		}
+		vector<vector<double> > min(Series), max(Series), rms(Series);
+		unsigned int columns = 0;
+		for (unsigned int s = 0; s < Series; s++){
+			columns = Query(s, 0, Samples, width, min[s], max[s], rms[s]);
+		}
+		for (unsigned int c = 0; c < columns; c++){
+			file << (c + 0.5)*Samples/columns*Interval;
+			for (unsigned int s = 0; s < Series; s++){
+				file << ',' << min[s][c] << ',' << max[s][c] << ',' << rms[s][c];
+			}
+			file << '\n';
+		}
+	}
+}
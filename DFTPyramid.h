@@ -0,0 +1,84 @@
+/*
+	DFTPyramid
+
+	Multi-resolution summary of a signal for plotting, like the mip-maps of a texture. Every level splits the
+	signal into buckets of a power of two samples and keeps the minimum, the maximum and the energy (sum of
+	squares) of each bucket. The finest level has buckets of Leaf samples, every following level merges pairs of
+	buckets of the previous one, up to a single bucket for the whole signal.
+
+	The data is read in one pass. After that, a request for a range of the signal drawn over a given number of
+	columns (pixels) picks the coarsest level whose buckets are no wider than a column and merges at most a couple
+	of buckets per column, so it costs O(width) whatever the length of the signal. The minimum and maximum are
+	exact for the buckets touched; the range is widened to bucket boundaries at its two ends.
+
+	Requests finer than Leaf samples per column return one column per leaf bucket, i.e. fewer columns than asked.
+
+	A pyramid holds one series per dimension of the data, plus one per dimension for the imaginary parts if asked.
+	Series s < NumDimensions() is the real part of dimension s, series NumDimensions() + s its imaginary part.
+
+	After an edit of the data, Update() redoes only the buckets covering the samples edited, at every level, e.g. with
+	the ranges from WaveFile::GetEdits().
+*/
+#pragma once
+#ifndef DFTPyramid_H
+#define DFTPyramid_H
+
+#include <vector>
+#include "DFTData.h"
+#include "WaveFile.h"
+
+namespace DFT{
+	class DFTPyramid{
+		struct Level_T{
+			unsigned int Bucket;				//Samples per bucket
+			unsigned int Count;					//Number of buckets
+			std::vector<double> Min;			//Series major, Count per series
+			std::vector<double> Max;
+			std::vector<double> Energy;			//Sum of squares
+		};
+
+		unsigned int Leaf;						//Samples per bucket of the finest level
+		unsigned int Samples;					//Number of samples per series
+		unsigned int Dimensions;				//Dimensions of the data
+		unsigned int Series;					//Number of series
+		double Interval;						//DFTInterval() of the data
+		std::vector<Level_T> Levels;			//Finest first
+
+	protected:
+		void Start(unsigned int samples, unsigned int dimensions, bool imaginary, double interval);	//Allocate the finest level
+		void Add(unsigned int series, unsigned int index, double value);	//Add a sample to the finest level
+		void Add(const DFTData &data, unsigned int begin, unsigned int end);	//Add intervals [begin, end) of data, in runs
+		void Finish();							//Build the coarser levels from the finest
+		void Merge(unsigned int level, unsigned int first, unsigned int last);	//Buckets [first, last] of a level from the level below
+
+	public:
+		//leaf is the number of samples per bucket of the finest level
+		explicit DFTPyramid(unsigned int leaf=64);
+
+		//Build from the data in one pass through DFTGet(). Set imaginary to keep the imaginary parts as well.
+		void Build(const DFTData &data, bool imaginary=false);
+		//Build from a wave file, streaming its data chunk so that it need not be loaded
+		void Build(Wave::WaveFile &wave);
+		//Redo samples [begin, end) from the data the pyramid was built from, after they were edited
+		void Update(const DFTData &data, unsigned int begin, unsigned int end);
+
+		//Summarise samples [begin, end) of a series in at most width columns. min, max and rms are resized to the number of
+		//columns, which is returned. Column c covers samples begin + c*(end-begin)/columns onwards.
+		unsigned int Query(unsigned int series, unsigned int begin, unsigned int end, unsigned int width,
+			std::vector<double> &min, std::vector<double> &max, std::vector<double> &rms) const;
+
+		//Write every series over the whole signal in width columns to a CSV file: the position of the column, followed by
+		//the minimum, maximum and rms of each series
+		void Export(const char *file, unsigned int width) const;
+
+		//Getters
+		unsigned int GetLeaf() const{ return Leaf; }
+		unsigned int NumSamples() const{ return Samples; }
+		unsigned int NumDimensions() const{ return Dimensions; }
+		unsigned int NumSeries() const{ return Series; }
+		unsigned int NumLevels() const{ return unsigned(Levels.size()); }
+		double GetInterval() const{ return Interval; }
+	};
+}
+
+#endif /*DFTPyramid_H*/
@@ -0,0 +1,171 @@
+/*
+	DFTReal
+
+	A time domain container for real signals, e.g. audio, that stores each value as a T, double or float, rather than
+	as a complex<double>: 8 or 4 bytes per sample instead of 16.
+	Use the typedefs DFTRealTime (double) and DFTRealTimeFloat (float).
+
+	Values are stored dimension after dimension, each dimension in a vector of its own, so that a transform of one
+	dimension reads unit stride data and dimensions can be added or dropped without moving the others.
+	DFTIsReal() returns true, for transform engines to take their real input path. The imaginary parts of the values
+	set are dropped, and values get rounded to float with DFTRealTimeFloat.
+
+	As with DFTGeneric, intervals past the end read as zeros and are created by DFTSet(). Reading changes nothing, so
+	that threads may read at once, while none writes.
+*/
+#pragma once
+#ifndef DFTReal_H
+#define DFTReal_H
+
+#include <vector>
+#include <algorithm>
+#include "DFTData.h"
+#include "DFTPool.h"
+#include "Exception.h"
+
+namespace DFT{
+	template<class T> class DFTReal: public DFTTime{
+		typedef std::vector<T, DFTPoolAllocator<T> > Values_T;
+
+		std::vector<Values_T> Values;			//Per dimension, from DFTPool
+		unsigned int Intervals;					//Number of intervals
+		double Interval;						//Interval between samples
+
+	protected:
+		//Make sure the interval exists
+		void CreateInterval(unsigned int intervalN){
+			if (intervalN >= Intervals){
+				DFTSetNumInterval(intervalN + 1);
+			}
+		}
+		void Check(unsigned int dimension) const{
+			if (dimension >= Values.size()){
+				throw Exception(EXCEPTION_RANGE, "Out of range access.");
+			}
+		}
+
+	public:
+		//n is the number of dimensions, size the number of intervals to allocate
+		DFTReal(unsigned int n=1, double interval=1.0, unsigned int size=0): Values(n), Intervals(0), Interval(interval){
+			if (!n || interval <= 0){
+				throw Exception(EXCEPTION_DATA_INVALID, "Dimension and/or interval cannot <= zero!");
+			}
+			for (unsigned int j = 0; j < n && size; j++){
+				Values[j].reserve(size);
+			}
+		}
+
+		//Properties Getter
+		unsigned int DFTDimension() const{ return unsigned(Values.size()); }
+		unsigned int DFTSample() const{ return Intervals*DFTDimension(); }
+		unsigned int DFTNumInterval() const{ return Intervals; }
+		double DFTInterval() const{ return Interval; }
+		bool DFTIsReal() const{ return true; }
+
+		//Properties Setter
+		void DFTSetInterval(double n){
+			if (n <= 0){
+				throw Exception(EXCEPTION_DATA_INVALID, "Interval cannot <= zero!");
+			}
+			Interval = n;
+		}
+		//Dimensions kept keep their values; new ones are zeros
+		void DFTSetDimension(unsigned int n){
+			if (!n){
+				throw Exception(EXCEPTION_DATA_INVALID, "Number cannot be zero!");
+			}
+			Values.resize(n, Values_T(Intervals, T(0)));
+		}
+		void DFTSetNumInterval(unsigned int n){
+			for (unsigned int j = 0; j < Values.size(); j++){
+				Values[j].resize(n, T(0));
+			}
+			Intervals = n;
+		}
+
+		//Samples getter and setter
+		std::complex<double> DFTGet(unsigned int intervalN, unsigned int dimension) const{
+			Check(dimension);
+			//Past the end reads as zero, without creating anything
+			return std::complex<double>((intervalN < Intervals) ? Values[dimension][intervalN] : T(0), 0);
+		}
+		void DFTSet(unsigned int intervalN, unsigned int dimension, const std::complex<double> &data){
+			Check(dimension);
+			CreateInterval(intervalN);
+			Values[dimension][intervalN] = T(data.real());
+		}
+
+		//Bulk access. Intervals past the end read as zeros and are created by the setters.
+		void DFTGetRange(unsigned int dimension, unsigned int first, unsigned int count, std::complex<double> *out) const{
+			Check(dimension);
+			unsigned int stored = (first < Intervals) ? std::min(count, Intervals - first) : 0;
+			const T *in = stored ? &Values[dimension][first] : NULL;
+			for (unsigned int i = 0; i < stored; i++){
+				out[i] = std::complex<double>(in[i], 0);
+			}
+			std::fill(out + stored, out + count, std::complex<double>(0, 0));
+		}
+		void DFTGetSplit(unsigned int dimension, unsigned int first, unsigned int count, double *real, double *imag) const{
+			Check(dimension);
+			unsigned int stored = (first < Intervals) ? std::min(count, Intervals - first) : 0;
+			if (stored){
+				std::copy(&Values[dimension][first], &Values[dimension][first] + stored, real);
+			}
+			std::fill(real + stored, real + count, 0.0);
+			if (imag){
+				std::fill(imag, imag + count, 0.0);
+			}
+		}
+		void DFTSetRange(unsigned int dimension, unsigned int first, unsigned int count, const std::complex<double> *in){
+			Check(dimension);
+			if (!count){
+				return;
+			}
+			CreateInterval(first + count - 1);
+			T *out = &Values[dimension][first];
+			for (unsigned int i = 0; i < count; i++){
+				out[i] = T(in[i].real());
+			}
+		}
+		void DFTSetSplit(unsigned int dimension, unsigned int first, unsigned int count, const double *real, const double *imag){
+			Check(dimension);
+			if (!count){
+				return;
+			}
+			CreateInterval(first + count - 1);
+			T *out = &Values[dimension][first];
+			for (unsigned int i = 0; i < count; i++){
+				out[i] = T(real[i]);
+			}
+		}
+
+		void DFTGetSplitFloat(unsigned int dimension, unsigned int first, unsigned int count, float *real, float *imag) const{
+			Check(dimension);
+			unsigned int stored = (first < Intervals) ? std::min(count, Intervals - first) : 0;
+			if (stored){
+				std::copy(&Values[dimension][first], &Values[dimension][first] + stored, real);
+			}
+			std::fill(real + stored, real + count, 0.0f);
+			if (imag){
+				std::fill(imag, imag + count, 0.0f);
+			}
+		}
+		void DFTSetSplitFloat(unsigned int dimension, unsigned int first, unsigned int count, const float *real, const float *imag){
+			Check(dimension);
+			if (!count){
+				return;
+			}
+			CreateInterval(first + count - 1);
+			std::copy(real, real + count, &Values[dimension][first]);
+		}
+
+		//The values of a dimension, DFTNumInterval() of them
+		T *GetValues(unsigned int dimension){ Check(dimension); return Intervals ? &Values[dimension][0] : NULL; }
+		const T *GetValues(unsigned int dimension) const{ Check(dimension); return Intervals ? &Values[dimension][0] : NULL; }
+	};
+
+	typedef DFTReal<double> DFTRealTime;
+	typedef DFTReal<float> DFTRealTimeFloat;
+}
+
+#endif /*DFTReal_H*/
@@ -0,0 +1,173 @@
+//DFTSTFT.cpp
+#include <algorithm>
+#include "DFTSTFT.h"
+#include "DFTPool.h"
+
+using namespace std;
+namespace DFT{
+	/************** DFTAnalysis ****************/
+	//Constructor
+	DFTAnalysis::DFTAnalysis(unsigned int frame, unsigned int hop, WindowType window)
+		: FrameSize(frame), Hop(hop), Channels(0), Plan(NULL), Filled(0), Frames(0){
+		if (frame < 2){
+			throw Exception(EXCEPTION_DATA_INVALID, "Frame must have at least two samples!");
+		}
+		if (!hop || hop > frame){
+			throw Exception(EXCEPTION_DATA_INVALID, "Hop must be between one and the frame length!");
+		}
+		MakeWindow(window, FrameSize, Window);
+		Plan = &DFTPlan::Get(FrameSize);
+		Windowed.resize(FrameSize);
+	}
+
+	//Reset()
+	void DFTAnalysis::Reset(unsigned int channels){
+		if (!channels){
+			throw Exception(EXCEPTION_DATA_INVALID, "Number of channels cannot be zero!");
+		}
+		Channels = channels;
+		Buffer.assign(Channels*FrameSize, 0);
+		Filled = 0;
+		Frames = 0;
+	}
+
+	//Push()
+	unsigned int DFTAnalysis::Push(const double *data, unsigned int blocks, vector<complex<double> > &spectra){
+		if (!Channels){
+			throw Exception(EXCEPTION_INITIALISATION, "Analyser has not been reset for a signal.");
+		}
+		unsigned int bins = Plan->GetRealSize();
+		//Every frame completed by these blocks
+		unsigned int count = (Filled + blocks >= FrameSize) ? (Filled + blocks - FrameSize)/Hop + 1 : 0;
+		spectra.resize(count*Channels*bins);
+		complex<double> *spectrum = count ? &spectra[0] : NULL;
+		while (blocks){
+			//Deinterleave as much as will fit into the current frame
+			unsigned int n = min(blocks, FrameSize - Filled);
+			for (unsigned int c = 0; c < Channels; c++){
+				double *frame = &Buffer[c*FrameSize + Filled];
+				for (unsigned int i = 0; i < n; i++){
+					frame[i] = data[i*Channels + c];
+				}
+			}
+			data += n*Channels;
+			blocks -= n;
+			Filled += n;
+
+			if (Filled == FrameSize){
+				for (unsigned int c = 0; c < Channels; c++){
+					double *frame = &Buffer[c*FrameSize];
+					for (unsigned int i = 0; i < FrameSize; i++){
+						Windowed[i] = frame[i]*Window[i];
+					}
+					Plan->ForwardReal(&Windowed[0], spectrum);
+					spectrum += bins;
+					//Keep the overlapping tail as the start of the next frame
+					copy(frame + Hop, frame + FrameSize, frame);
+				}
+				Filled = FrameSize - Hop;
+				Frames++;
+			}
+		}
+		return count;
+	}
+
+	/************** DFTSynthesis ****************/
+	//Constructor
+	DFTSynthesis::DFTSynthesis(unsigned int frame, unsigned int hop, unsigned int channels, WindowType window)
+		: FrameSize(frame), Hop(hop), Channels(channels), Plan(NULL), Sink(NULL), Frames(0){
+		if (frame < 2 || !channels){
+			throw Exception(EXCEPTION_DATA_INVALID, "Frame must have at least two samples and one channel!");
+		}
+		if (!hop || hop > frame){
+			throw Exception(EXCEPTION_DATA_INVALID, "Hop must be between one and the frame length!");
+		}
+		MakeWindow(window, FrameSize, Window);
+		Plan = &DFTPlan::Get(FrameSize);
+		Output.assign(Channels*FrameSize, 0);
+		Weight.assign(FrameSize, 0);
+		Spectrum.resize(Plan->GetRealSize());
+		Frame.resize(FrameSize);
+	}
+
+	//SetSink()
+	void DFTSynthesis::SetSink(Wave::WaveWriter *sink){
+		if (sink && sink->NumChannels() != Channels){
+			throw Exception(EXCEPTION_DATA_INVALID, "Output has a different number of channels.");
+		}
+		Sink = sink;
+		fill(Output.begin(), Output.end(), 0.0);
+		fill(Weight.begin(), Weight.end(), 0.0);
+		Frames = 0;
+	}
+
+	//Emit()
+	void DFTSynthesis::Emit(unsigned int n){
+		if (!n){
+			return;
+		}
+		if (Interleaved.size() < n*Channels){
+			Interleaved.resize(n*Channels);
+		}
+		for (unsigned int i = 0; i < n; i++){
+			//Positions no window ever covered stay silent
+			double scale = Weight[i] > 1e-10 ? 1.0/Weight[i] : 0.0;
+			for (unsigned int c = 0; c < Channels; c++){
+				Interleaved[i*Channels + c] = Output[c*FrameSize + i]*scale;
+			}
+		}
+		if (Sink){
+			Sink->Write(&Interleaved[0], n);
+		}
+		//Shift
+		for (unsigned int c = 0; c < Channels; c++){
+			double *output = &Output[c*FrameSize];
+			copy(output + n, output + FrameSize, output);
+			fill(output + FrameSize - n, output + FrameSize, 0.0);
+		}
+		copy(Weight.begin() + n, Weight.end(), Weight.begin());
+		fill(Weight.end() - n, Weight.end(), 0.0);
+	}
+
+	//Push()
+	void DFTSynthesis::Push(const complex<double> *spectrum){
+		unsigned int bins = Plan->GetRealSize();
+		for (unsigned int c = 0; c < Channels; c++){
+			copy(spectrum + c*bins, spectrum + (c+1)*bins, Spectrum.begin());
+			Plan->InverseReal(&Spectrum[0], &Frame[0]);
+			double *output = &Output[c*FrameSize];
+			for (unsigned int i = 0; i < FrameSize; i++){
+				output[i] += Frame[i]*Window[i];
+			}
+		}
+		for (unsigned int i = 0; i < FrameSize; i++){
+			Weight[i] += Window[i]*Window[i];
+		}
+		Frames++;
+		//The first hop is now complete: no later frame reaches back this far
+		Emit(Hop);
+	}
+
+	//Push() - DFTData
+	void DFTSynthesis::Push(const DFTData &frame){
+		unsigned int bins = Plan->GetRealSize();
+		if (frame.DFTDimension() != Channels || frame.DFTNumInterval() != bins){
+			throw Exception(EXCEPTION_DATA_INVALID, "Frame does not match the frame size or number of channels.");
+		}
+		vector<complex<double>, DFTPoolAllocator<complex<double> > > spectrum(Channels*bins);
+		for (unsigned int c = 0; c < Channels; c++){
+			frame.DFTGetRange(c, 0, bins, &spectrum[c*bins]);
+		}
+		Push(&spectrum[0]);
+	}
+
+	//Finish()
+	void DFTSynthesis::Finish(){
+		if (Frames){
+			Emit(FrameSize - Hop);
+		}
+		if (Sink){
+			Sink->Close();
+		}
+	}
+}
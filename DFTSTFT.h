@@ -0,0 +1,114 @@
+/*
+	Short Time Fourier Transform
+
+	DFTAnalysis
+	Forward STFT of a stream. Blocks of interleaved samples are pushed as they become available; every time a frame
+	of FrameSize samples is complete it is windowed and transformed, and the buffer moves on by one hop. Only whole
+	frames are produced: the first frame starts at the first sample and a tail shorter than a frame is left out.
+
+	DFTSynthesis
+	Weighted overlap-add inverse STFT. Spectral frames are pushed one at a time; each is inverse transformed,
+	multiplied by the synthesis window and added into an output buffer of one frame. As soon as a hop of samples
+	can no longer receive contributions from later frames it is normalised by the accumulated squared window and
+	written out, so memory stays at one frame per channel no matter how long the signal is.
+	cf http://en.wikipedia.org/wiki/Short-time_Fourier_transform#Inverse_STFT
+
+	Frames are one sided spectra of a real signal: FrameSize/2+1 bins per channel, the same layout as the
+	DFTGenericFrequency objects produced by DFTWelch, i.e. bins as intervals and channels as dimensions.
+*/
+#pragma once
+#ifndef DFTSTFT_H
+#define DFTSTFT_H
+
+#include <vector>
+#include <complex>
+#include "DFTData.h"
+#include "DFTPlan.h"
+#include "DFTUtility.h"
+#include "WaveWriter.h"
+
+namespace DFT{
+	/************** DFTAnalysis ****************/
+	class DFTAnalysis{
+		unsigned int FrameSize;					//Samples per frame
+		unsigned int Hop;						//Samples between the start of consecutive frames
+		unsigned int Channels;					//Number of channels
+		std::vector<double> Window;				//Analysis window
+		const DFTPlan *Plan;					//Cached transform plan
+
+		std::vector<double> Buffer;				//Samples of the current frame. Channel major, FrameSize per channel
+		unsigned int Filled;					//Number of samples per channel in Buffer
+		unsigned int Frames;					//Number of frames produced
+
+		std::vector<double> Windowed;			//Scratch space
+
+	public:
+		//Construct the analyser. hop must be non-zero and no longer than the frame.
+		DFTAnalysis(unsigned int frame=1024, unsigned int hop=512, WindowType window=WindowHann);
+
+		//Clear any buffered samples and get ready for a signal with the number of channels
+		void Reset(unsigned int channels);
+
+		//Add blocks of samples. data holds blocks*channels values interleaved by channel.
+		//The spectra of the frames completed by these blocks replace the content of spectra: frame after frame,
+		//each Channels*(FrameSize/2+1) bins, channel major, which is what DFTSynthesis::Push() takes.
+		//Returns the number of frames.
+		unsigned int Push(const double *data, unsigned int blocks, std::vector<std::complex<double> > &spectra);
+
+		//Getters
+		unsigned int GetFrameSize() const{ return FrameSize; }
+		unsigned int GetHop() const{ return Hop; }
+		unsigned int GetBins() const{ return Plan->GetRealSize(); }
+		unsigned int NumChannels() const{ return Channels; }
+		unsigned int NumFrames() const{ return Frames; }
+		const std::vector<double> &GetWindow() const{ return Window; }
+	};
+
+	/************** DFTSynthesis ****************/
+	class DFTSynthesis{
+		unsigned int FrameSize;					//Samples per frame
+		unsigned int Hop;						//Samples between the start of consecutive frames
+		unsigned int Channels;					//Number of channels
+		std::vector<double> Window;				//Synthesis window
+		const DFTPlan *Plan;					//Cached transform plan
+
+		std::vector<double> Output;				//Overlap-add buffer. Channel major, FrameSize per channel
+		std::vector<double> Weight;				//Sum of the squared synthesis window at each position of Output
+		Wave::WaveWriter *Sink;					//Where completed samples go
+		unsigned int Frames;					//Number of frames pushed
+
+		//Scratch space
+		std::vector<std::complex<double> > Spectrum;
+		std::vector<double> Frame;
+		std::vector<double> Interleaved;
+
+	protected:
+		void Emit(unsigned int n);				//Normalise, interleave and write the first n samples of Output, then shift the buffers by n
+
+	public:
+		//Construct the synthesiser. hop must be non-zero and no longer than the frame.
+		//The window should be the one used for analysis; with the squared window normalisation any window that
+		//overlaps without gaps gives perfect reconstruction of unmodified frames.
+		DFTSynthesis(unsigned int frame=1024, unsigned int hop=512, unsigned int channels=1, WindowType window=WindowHann);
+
+		//Set where the output goes. The writer must be open with the same number of channels.
+		//Clears any partially synthesised output.
+		void SetSink(Wave::WaveWriter *sink);
+
+		//Add the next frame. spectrum holds Channels*(FrameSize/2+1) bins, channel major.
+		void Push(const std::complex<double> *spectrum);
+		//DFTData overload. frame has FrameSize/2+1 intervals and Channels dimensions.
+		void Push(const DFTData &frame);
+
+		//Flush the tail of the last frame to the sink and close it. The sink then holds a complete Wave file.
+		void Finish();
+
+		//Getters
+		unsigned int GetFrameSize() const{ return FrameSize; }
+		unsigned int GetHop() const{ return Hop; }
+		unsigned int NumChannels() const{ return Channels; }
+		unsigned int NumFrames() const{ return Frames; }
+	};
+}
+
+#endif /*DFTSTFT_H*/
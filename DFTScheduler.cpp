@@ -0,0 +1,226 @@
+//DFTScheduler.cpp
+#include <thread>
+#include <new>
+#include <algorithm>
+#include "DFTScheduler.h"
+#include "WaveMisc.h"
+
+using namespace std;
+namespace DFT{
+	//Constructor
+	DFTScheduler::DFTScheduler(unsigned int frame, unsigned int hop, WindowType window, unsigned int threads, unsigned int rangeFrames)
+		: FrameSize(frame), Hop(hop), Window(window), Threads(threads), RangeFrames(rangeFrames), Source(NULL), Sink(NULL),
+		Frames(0), Ranges(0), Next(0), Delivering(false), Failed(false), ErrorCode(0){
+		if (!RangeFrames){
+			throw Exception(EXCEPTION_DATA_INVALID, "A range must hold at least one frame!");
+		}
+		if (!Threads){
+			Threads = max(1u, std::thread::hardware_concurrency());
+		}
+		Ahead = 4*Threads;
+		//Plans are resolved here, in one thread
+		Workers.resize(Threads);
+		try{
+			for (unsigned int w = 0; w < Threads; w++){
+				Workers[w].Analysis = new DFTAnalysis(FrameSize, Hop, Window);
+			}
+		}
+		catch(...){
+			for (unsigned int w = 0; w < Threads; w++){
+				delete Workers[w].Analysis;
+			}
+			throw;
+		}
+	}
+
+	//Destructor
+	DFTScheduler::~DFTScheduler(){
+		for (unsigned int w = 0; w < Workers.size(); w++){
+			delete Workers[w].Analysis;
+		}
+	}
+
+	//Run()
+	unsigned int DFTScheduler::Run(Wave::WaveFile &wave, DFTFrameSink &sink){
+		unsigned int blocks = wave.NumBlocks();
+		Source = &wave;
+		Sink = &sink;
+		Frames = (blocks >= FrameSize) ? (blocks - FrameSize)/Hop + 1 : 0;
+		Ranges = (Frames + RangeFrames - 1)/RangeFrames;
+		Finished.clear();
+		Next = 0;
+		Delivering = false;
+		Failed = false;
+		//Deal the ranges
+		for (unsigned int w = 0; w < Threads; w++){
+			Workers[w].Queue.clear();
+		}
+		for (unsigned int r = 0; r < Ranges; r++){
+			Workers[r % Threads].Queue.push_back(r);
+		}
+
+		//The calling thread is the last worker
+		vector<std::thread> threads;
+		try{
+			for (unsigned int w = 0; w + 1 < Threads; w++){
+				threads.push_back(std::thread(&DFTScheduler::WorkEntry, this, w));
+			}
+		}
+		catch(...){
+			unique_lock<mutex> lock(Lock);
+			Failed = true;
+			ErrorCode = EXCEPTION_INITIALISATION;
+			ErrorMessage = "Unable to start a worker thread.";
+			Progress.notify_all();
+		}
+		Work(Threads - 1);
+		for (unsigned int t = 0; t < threads.size(); t++){
+			threads[t].join();
+		}
+		Finished.clear();
+		if (Failed){
+			throw Exception(ErrorCode, ErrorMessage.c_str());
+		}
+		return Frames;
+	}
+
+	//WorkEntry()
+	void DFTScheduler::WorkEntry(DFTScheduler *scheduler, unsigned int worker){
+		scheduler->Work(worker);
+	}
+
+	//Work()
+	void DFTScheduler::Work(unsigned int worker){
+		int code = 0;
+		string message;
+		try{
+			vector<complex<double> > spectra;
+			unsigned int range;
+			while (Take(worker, range)){
+				Compute(Workers[worker], range, spectra);
+				Deliver(range, spectra);
+			}
+			return;
+		}
+		catch(Exception &e){
+			code = e.GetErrorCode();
+			message = e.GetErrorMessage();
+		}
+		catch(bad_alloc &){
+			code = EXCEPTION_MEMORY_ERROR;
+			message = "Out of memory.";
+		}
+		catch(...){
+			code = EXCEPTION_UNEXPECTED;
+			message = "Unexpected error in a worker thread.";
+		}
+		//Keep the first error and stop everyone
+		unique_lock<mutex> lock(Lock);
+		if (!Failed){
+			Failed = true;
+			ErrorCode = code;
+			ErrorMessage = message;
+		}
+		Progress.notify_all();
+	}
+
+	//Take()
+	bool DFTScheduler::Take(unsigned int worker, unsigned int &range){
+		unique_lock<mutex> lock(Lock);
+		while (!Failed){
+			unsigned int limit = Next + Ahead;
+			deque<unsigned int> &own = Workers[worker].Queue;
+			if (!own.empty() && own.front() < limit){
+				range = own.front();
+				own.pop_front();
+				return true;
+			}
+			//Steal the earliest range left
+			bool left = !own.empty();
+			unsigned int victim = Threads;
+			for (unsigned int w = 0; w < Threads; w++){
+				const deque<unsigned int> &queue = Workers[w].Queue;
+				if (w == worker || queue.empty()){
+					continue;
+				}
+				left = true;
+				if (queue.front() < limit && (victim == Threads || queue.front() < Workers[victim].Queue.front())){
+					victim = w;
+				}
+			}
+			if (victim != Threads){
+				range = Workers[victim].Queue.front();
+				Workers[victim].Queue.pop_front();
+				return true;
+			}
+			if (!left){
+				return false;
+			}
+			//Too far ahead of the sink; wait for it to catch up
+			Progress.wait(lock);
+		}
+		return false;
+	}
+
+	//Compute()
+	void DFTScheduler::Compute(Worker_T &worker, unsigned int range, vector<complex<double> > &spectra){
+		unsigned int channels = Source->NumChannels(), sampleBytes = Source->SampleSize()/8;
+		unsigned int first = range*RangeFrames;
+		unsigned int frames = min(RangeFrames, Frames - first);
+		unsigned int blocks = (frames - 1)*Hop + FrameSize;
+		worker.Raw.resize(blocks*channels*sampleBytes);
+		worker.Samples.resize(blocks*channels);
+		//Reading is the only step done one thread at a time
+		unsigned int read;
+		{
+			lock_guard<mutex> lock(ReadLock);
+			Source->DataSeek(first*Hop);
+			read = Source->DataNextRaw(&worker.Raw[0], blocks);
+		}
+		if (read != blocks){
+			throw Exception(EXCEPTION_PARSE_MISSING_DATA, "Wave file ended before the last frame!");
+		}
+		Wave::DecodeSamples(&worker.Raw[0], blocks*channels, sampleBytes, &worker.Samples[0]);
+		worker.Analysis->Reset(channels);
+		if (worker.Analysis->Push(&worker.Samples[0], blocks, spectra) != frames){
+			throw Exception(EXCEPTION_UNEXPECTED, "Range did not produce the expected frames!");
+		}
+	}
+
+	//Deliver()
+	void DFTScheduler::Deliver(unsigned int range, vector<complex<double> > &spectra){
+		unique_lock<mutex> lock(Lock);
+		Finished[range].swap(spectra);
+		if (Delivering){
+			//Whoever is delivering will get to it
+			return;
+		}
+		Delivering = true;
+		unsigned int frameValues = Source->NumChannels()*GetBins();
+		map<unsigned int, vector<complex<double> > >::iterator it;
+		while (!Failed && (it = Finished.find(Next)) != Finished.end()){
+			vector<complex<double> > ready;
+			ready.swap(it->second);
+			Finished.erase(it);
+			//The sink runs without the lock, so that the other workers carry on
+			lock.unlock();
+			try{
+				Sink->Consume((unsigned long long)(Next)*RangeFrames, unsigned(ready.size()/frameValues), &ready[0]);
+			}
+			catch(...){
+				//Work() records the error; no one is delivering any more
+				lock.lock();
+				Delivering = false;
+				throw;
+			}
+			lock.lock();
+			Next++;
+			Progress.notify_all();
+			//Give the buffer back for the next range
+			if (spectra.capacity() < ready.capacity()){
+				spectra.swap(ready);
+			}
+		}
+		Delivering = false;
+	}
+}
@@ -0,0 +1,112 @@
+/*
+	Parallel Frame Scheduler
+
+	DFTScheduler
+	Computes the short time Fourier transform of a Wave file on several threads and hands the frames to a sink in
+	order, so that the output is the same whatever the number of threads.
+
+	The frames of the file are split into ranges of RangeFrames frames. Every worker thread starts with its own queue
+	of ranges, dealt round robin so that the earliest ranges are spread over all workers. A worker takes the earliest
+	range of its own queue and, once it is empty or too far ahead, steals the earliest range left in the queues of the
+	other workers.
+	For a range, a worker reads the raw bytes of its samples, which is the only step done one thread at a time, then
+	decodes, windows and transforms them with its own DFTAnalysis, i.e. its own buffers and scratch space. Plans are
+	immutable and shared by all the workers.
+
+	Finished ranges are handed to the sink strictly in order. Whichever worker finishes the range the sink is waiting
+	for delivers it, and any later range that is waiting, one worker at a time. A worker does not start a range more
+	than Ahead ranges ahead of the sink, so the memory held by results waiting for delivery is bounded.
+
+	Frames follow DFTAnalysis: frame f starts at sample f*Hop, only whole frames are kept and spectra are laid out
+	frame after frame, each Channels*(FrameSize/2+1) bins, channel major. Samples are not scaled.
+
+	Exceptions thrown by a worker or the sink stop the other workers and are thrown again by Run().
+*/
+#pragma once
+#ifndef DFTScheduler_H
+#define DFTScheduler_H
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <complex>
+#include <mutex>
+#include <condition_variable>
+#include "DFTSTFT.h"
+#include "DFTUtility.h"
+#include "WaveFile.h"
+
+namespace DFT{
+	/************** DFTFrameSink ****************/
+	//Receives the frames of a DFTScheduler in order, from one thread at a time
+	class DFTFrameSink{
+	public:
+		virtual ~DFTFrameSink(){}
+		//frames spectra starting at frame first
+		virtual void Consume(unsigned long long first, unsigned int frames, const std::complex<double> *spectra) = 0;
+	};
+
+	/************** DFTScheduler ****************/
+	class DFTScheduler{
+		//What a worker owns
+		struct Worker_T{
+			std::deque<unsigned int> Queue;		//Ranges still to do, earliest first
+			DFTAnalysis *Analysis;				//Framing and transform
+			std::vector<char> Raw;				//Undecoded samples
+			std::vector<double> Samples;		//Decoded samples
+			Worker_T(): Analysis(NULL){}
+		};
+
+		unsigned int FrameSize;					//Samples per frame
+		unsigned int Hop;						//Samples between frames
+		WindowType Window;						//Analysis window
+		unsigned int Threads;					//Number of workers
+		unsigned int RangeFrames;				//Frames per range
+		unsigned int Ahead;						//Ranges a worker may run ahead of the sink
+
+		//State of a Run()
+		Wave::WaveFile *Source;
+		DFTFrameSink *Sink;
+		unsigned int Frames;					//Frames of the file
+		unsigned int Ranges;					//Ranges of the file
+		std::vector<Worker_T> Workers;
+		std::map<unsigned int, std::vector<std::complex<double> > > Finished;	//Ranges waiting for delivery
+		unsigned int Next;						//Range the sink is waiting for
+		bool Delivering;						//Whether a worker is delivering to the sink
+		bool Failed;							//Whether a worker has thrown
+		int ErrorCode;							//What it threw
+		std::string ErrorMessage;
+		std::mutex Lock;						//Guards the queues and the delivery state
+		std::condition_variable Progress;		//Signalled when Next moves or a worker fails
+		std::mutex ReadLock;					//Guards the file
+
+		//Not copyable
+		DFTScheduler(const DFTScheduler &);
+		DFTScheduler &operator=(const DFTScheduler &);
+
+	protected:
+		bool Take(unsigned int worker, unsigned int &range);	//Next range for a worker. False when there is none left.
+		void Compute(Worker_T &worker, unsigned int range, std::vector<std::complex<double> > &spectra);	//Transform a range
+		void Deliver(unsigned int range, std::vector<std::complex<double> > &spectra);	//Hand a range over, in order
+		void Work(unsigned int worker);			//Body of a worker thread
+		static void WorkEntry(DFTScheduler *scheduler, unsigned int worker);
+
+	public:
+		//threads defaults to the number of hardware threads. rangeFrames is the unit of work.
+		DFTScheduler(unsigned int frame=1024, unsigned int hop=512, WindowType window=WindowHann, unsigned int threads=0,
+			unsigned int rangeFrames=64);
+		~DFTScheduler();
+
+		//Transform the data chunk of the wave file into the sink. Returns the number of frames.
+		unsigned int Run(Wave::WaveFile &wave, DFTFrameSink &sink);
+
+		//Getters
+		unsigned int GetFrameSize() const{ return FrameSize; }
+		unsigned int GetHop() const{ return Hop; }
+		unsigned int GetBins() const{ return FrameSize/2 + 1; }
+		unsigned int NumThreads() const{ return Threads; }
+		unsigned int GetRangeFrames() const{ return RangeFrames; }
+	};
+}
+
+#endif /*DFTScheduler_H*/
@@ -0,0 +1,97 @@
+/*
+	DFTShared
+
+	A vector shared by reference count and copied on write: copying a DFTShared copies a pointer, and the values are
+	only copied when one of the sharers edits them. Handing samples between WaveFile objects, DFT containers and the
+	modules is then O(1) for as long as nobody writes.
+
+	Read through the const accessors: Get(), operator[] and Size(). Edit() returns the vector to write to, copied first
+	if it is shared; pointers obtained from Get() before Edit() are stale afterwards. Do not keep the reference from
+	Edit() across a copy of the object.
+	Counts are atomic, so sharers may live in different threads; a single DFTShared is not to be used by several
+	threads at once without a lock, as for std::vector.
+	Memory comes from DFTPool.
+*/
+#pragma once
+#ifndef DFTShared_H
+#define DFTShared_H
+
+#include <vector>
+#include <atomic>
+#include "DFTPool.h"
+
+namespace DFT{
+	template <typename T> class DFTShared{
+	public:
+		typedef std::vector<T, DFTPoolAllocator<T> > Vector_T;
+
+	private:
+		struct Block_T{
+			std::atomic<unsigned int> Count;		//Sharers
+			Vector_T Values;
+			Block_T(): Count(1){}
+			explicit Block_T(const Vector_T &values): Count(1), Values(values){}
+		};
+		Block_T *Block;								//NULL when empty and never edited
+
+		void Drop(){
+			if (Block && --Block->Count == 0){
+				delete Block;
+			}
+			Block = NULL;
+		}
+
+	public:
+		DFTShared(): Block(NULL){}
+		explicit DFTShared(size_t n, const T &value=T()): Block(new Block_T){
+			try{
+				Block->Values.assign(n, value);
+			}
+			catch(...){
+				delete Block;
+				throw;
+			}
+		}
+		DFTShared(const DFTShared &obj): Block(obj.Block){
+			if (Block){
+				Block->Count++;
+			}
+		}
+		DFTShared &operator=(const DFTShared &op){
+			if (Block != op.Block){
+				DFTShared copy(op);
+				Swap(copy);
+			}
+			return *this;
+		}
+		~DFTShared(){ Drop(); }
+
+		//Reading
+		size_t Size() const{ return Block ? Block->Values.size() : 0; }
+		bool IsEmpty() const{ return !Size(); }
+		const T *Get() const{ return Size() ? &Block->Values[0] : NULL; }
+		const T &operator[](size_t i) const{ return Block->Values[i]; }
+		bool IsShared() const{ return Block && Block->Count > 1; }
+
+		//Writing. The values are copied first when shared.
+		Vector_T &Edit(){
+			if (!Block){
+				Block = new Block_T;
+			}
+			else if (Block->Count > 1){
+				Block_T *own = new Block_T(Block->Values);
+				Drop();
+				Block = own;
+			}
+			return Block->Values;
+		}
+		void Clear(){ Drop(); }				//Let go of the values
+		void Swap(DFTShared &op){
+			Block_T *block = Block;
+			Block = op.Block;
+			op.Block = block;
+		}
+	};
+}
+
+#endif /*DFTShared_H*/
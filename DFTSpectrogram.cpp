@@ -0,0 +1,206 @@
+//DFTSpectrogram.cpp
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include "DFTSpectrogram.h"
+
+using namespace std;
+namespace DFT{
+	namespace{
+		const char CACHE_MAGIC[8] = {'W', 'D', 'F', 'T', 'S', 'P', 'E', 'C'};
+		const unsigned int CACHE_VERSION = 1;
+		const unsigned int CACHE_ALIGNMENT = 4096;		//Tiles start on a page
+
+		//FNV-1a
+		unsigned long long Hash(const void *data, size_t size, unsigned long long hash=14695981039346656037ULL){
+			const unsigned char *bytes = static_cast<const unsigned char*>(data);
+			for (size_t i = 0; i < size; i++){
+				hash = (hash ^ bytes[i])*1099511628211ULL;
+			}
+			return hash;
+		}
+	}
+
+	//Constructor
+	DFTSpectrogram::DFTSpectrogram(Wave::WaveFile &wave, const char *directory, unsigned int frame, unsigned int hop,
+		WindowType window, unsigned int tileFrames, unsigned int tileBins)
+		: Source(wave), Columns(0), Rows(0), TileBytes(0), Analysis(frame, hop, window), Normalisation(1.0),
+		Revision(wave.GetRevision()){
+		if (!tileFrames || !tileBins){
+			throw Exception(EXCEPTION_DATA_INVALID, "Tiles cannot be empty!");
+		}
+		const string &path = wave.GetPath();
+		memset(&Key, 0, sizeof(Key));
+		if (path.empty() || !Wave::MappedFile::Identify(path.c_str(), Key.SourceSize, Key.SourceTime)){
+			throw Exception(EXCEPTION_UNSUPPORTED, "The cache can only be keyed by a Wave file opened from a path.");
+		}
+		if (!wave.NumChannels()){
+			throw Exception(EXCEPTION_DATA_INVALID, "File has no channels.");
+		}
+		memcpy(Key.Magic, CACHE_MAGIC, sizeof(Key.Magic));
+		Key.Version = CACHE_VERSION;
+		Key.SourceHash = Hash(path.data(), path.size());
+		Key.SampleRate = wave.SampleRate();
+		Key.Channels = wave.NumChannels();
+		Key.Blocks = wave.NumBlocks();
+		Key.FrameSize = frame;
+		Key.Hop = hop;
+		Key.Window = window;
+		Key.Frames = (Key.Blocks >= frame) ? (Key.Blocks - frame)/hop + 1 : 0;
+		Key.Bins = Analysis.GetBins();
+		//Rows that split the bins evenly
+		Rows = (Key.Bins + tileBins - 1)/tileBins;
+		Key.TileBins = (Key.Bins + Rows - 1)/Rows;
+		Key.TileFrames = tileFrames;
+		Columns = (Key.Frames + tileFrames - 1)/tileFrames;
+		TileBytes = (unsigned long long) Key.Channels*Key.TileFrames*Key.TileBins*sizeof(float);
+		Key.DataOffset = unsigned((sizeof(Header_T) + Columns + CACHE_ALIGNMENT - 1)/CACHE_ALIGNMENT*CACHE_ALIGNMENT);
+
+		const vector<double> &coefficients = Analysis.GetWindow();
+		double sum = 0;
+		for (unsigned int i = 0; i < coefficients.size(); i++){
+			sum += coefficients[i];
+		}
+		Normalisation = 2/sum*ldexp(1.0, 1 - int(wave.SampleSize()));
+
+		Attach(directory);
+		//Tiles from the file on disk are of no use for samples edited in memory
+		if (wave.IsModified()){
+			Invalidate(true);
+		}
+	}
+
+	//Attach()
+	void DFTSpectrogram::Attach(const char *directory){
+		char name[32];
+		sprintf(name, "%016llx.spg", Hash(&Key, sizeof(Key)));
+		CacheFile = directory;
+		if (!CacheFile.empty() && CacheFile[CacheFile.size() - 1] != '/' && CacheFile[CacheFile.size() - 1] != '\\'){
+			CacheFile += '/';
+		}
+		CacheFile += name;
+
+		unsigned long long size = Key.DataOffset + Columns*(unsigned long long)Rows*TileBytes;
+		if (Cache.Open(CacheFile.c_str(), true) && Cache.GetSize() == size && !memcmp(Cache.Data(), &Key, sizeof(Key))){
+			return;
+		}
+		//Missing, stale or from another source that hashed the same: start afresh. The index starts cleared.
+		Cache.Create(CacheFile.c_str(), size);
+		memcpy(Cache.Data(), &Key, sizeof(Key));
+	}
+
+	//Compute()
+	void DFTSpectrogram::Compute(unsigned int column, unsigned int first, unsigned int frames){
+		unsigned int channels = Key.Channels, bins = Key.Bins;
+		unsigned int start = column*Key.TileFrames;
+		frames = min(frames, min(Key.TileFrames, Key.Frames - start) - first);
+		unsigned int blocks = (frames - 1)*Key.Hop + Key.FrameSize;
+
+		Samples.resize(blocks*channels);
+		Source.DataSeek((start + first)*Key.Hop);
+		if (Source.DataNextBlocks(&Samples[0], blocks) != blocks){
+			throw Exception(EXCEPTION_PARSE_MISSING_DATA, "Missing blocks in the file being analysed.");
+		}
+		Analysis.Reset(channels);
+		if (Analysis.Push(&Samples[0], blocks, Spectra) != frames){
+			throw Exception(EXCEPTION_UNEXPECTED, "Unexpected number of frames.");
+		}
+		for (unsigned int r = 0; r < Rows; r++){
+			float *tile = TileData(column, r);
+			unsigned int begin = r*Key.TileBins, end = min(bins, begin + Key.TileBins);
+			for (unsigned int c = 0; c < channels; c++){
+				for (unsigned int f = 0; f < frames; f++){
+					const complex<double> *spectrum = &Spectra[(f*channels + c)*bins];
+					float *out = tile + (c*Key.TileFrames + first + f)*Key.TileBins;
+					for (unsigned int k = begin; k < end; k++){
+						out[k - begin] = float(abs(spectrum[k])*Normalisation);
+					}
+				}
+			}
+		}
+		//Only once the tiles are in place
+		Cache.Data()[sizeof(Header_T) + column] = 1;
+	}
+
+	//Invalidate()
+	void DFTSpectrogram::Invalidate(bool all){
+		Header_T *header = reinterpret_cast<Header_T*>(Cache.Data());
+		if (header->SourceTime == Key.SourceTime){
+			header->SourceTime = ~Key.SourceTime;
+		}
+		if (all){
+			memset(Cache.Data() + sizeof(Header_T), 0, Columns);
+		}
+	}
+
+	//Refresh()
+	void DFTSpectrogram::Refresh(){
+		if (Source.GetRevision() == Revision){
+			return;
+		}
+		vector<pair<unsigned int, unsigned int> > edits;
+		bool known = Source.GetEdits(Revision, edits);
+		Revision = Source.GetRevision();
+		if (Source.NumBlocks() != Key.Blocks || Source.NumChannels() != Key.Channels){
+			throw Exception(EXCEPTION_DATA_INVALID, "The Wave file being analysed has changed shape.");
+		}
+		if (!known){
+			Invalidate(true);
+			return;
+		}
+		if (edits.empty()){
+			return;
+		}
+		Invalidate(false);
+		unsigned int tf = Key.TileFrames;
+		for (unsigned int i = 0; i < edits.size(); i++){
+			//Frame f covers blocks [f*Hop, f*Hop + FrameSize)
+			unsigned int begin = edits[i].first, end = edits[i].second;
+			unsigned int f0 = (begin >= Key.FrameSize) ? (begin - Key.FrameSize)/Key.Hop + 1 : 0;
+			unsigned int f1 = min(Key.Frames, (end - 1)/Key.Hop + 1);
+			for (unsigned int f = f0; f < f1; f = (f/tf + 1)*tf){
+				unsigned int column = f/tf;
+				//Columns not computed yet will be computed from the edited samples anyway
+				if (IsComputed(column)){
+					Compute(column, f - column*tf, min(f1, (column + 1)*tf) - f);
+				}
+			}
+		}
+	}
+
+	//GetTile()
+	const float *DFTSpectrogram::GetTile(unsigned int column, unsigned int row, unsigned int channel){
+		if (column >= Columns || row >= Rows || channel >= Key.Channels){
+			throw Exception(EXCEPTION_RANGE, "Out of range access.");
+		}
+		Refresh();
+		if (!IsComputed(column)){
+			Compute(column, 0, Key.TileFrames);
+		}
+		return TileData(column, row) + channel*Key.TileFrames*Key.TileBins;
+	}
+
+	//Get()
+	void DFTSpectrogram::Get(unsigned int channel, unsigned int firstFrame, unsigned int frames, unsigned int firstBin, unsigned int bins, float *out){
+		if (channel >= Key.Channels || firstFrame + frames > Key.Frames || firstBin + bins > Key.Bins){
+			throw Exception(EXCEPTION_RANGE, "Out of range access.");
+		}
+		if (!frames || !bins){
+			return;
+		}
+		unsigned int tf = Key.TileFrames, tb = Key.TileBins;
+		for (unsigned int column = firstFrame/tf; column <= (firstFrame + frames - 1)/tf; column++){
+			for (unsigned int row = firstBin/tb; row <= (firstBin + bins - 1)/tb; row++){
+				const float *tile = GetTile(column, row, channel);
+				//Part of the tile in the request
+				unsigned int f0 = max(firstFrame, column*tf), f1 = min(firstFrame + frames, (column + 1)*tf);
+				unsigned int b0 = max(firstBin, row*tb), b1 = min(firstBin + bins, (row + 1)*tb);
+				for (unsigned int f = f0; f < f1; f++){
+					const float *in = tile + (f - column*tf)*tb + (b0 - row*tb);
+					copy(in, in + (b1 - b0), out + (f - firstFrame)*bins + (b0 - firstBin));
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,129 @@
+/*
+	Spectrogram Cache
+
+	DFTSpectrogram
+	Magnitude spectrogram of a Wave file kept in a memory mapped cache file, so that panning and zooming around a
+	long recording does not transform it again, in this session or the next one.
+
+	The spectrogram is cut into tiles of TileFrames frames by TileBins bins. Tiles are computed a column (TileFrames
+	frames, all bins) at a time, the first time any of them is asked for: the samples of the column are read from
+	the file with DataSeek() and go through a DFTAnalysis. A view of the spectrogram therefore only costs transforms
+	for the columns never seen before; otherwise it only pages in the tiles it covers.
+
+	The cache file is named after a hash of its key, i.e. the path, size and modification time of the Wave file and the
+	STFT parameters, and starts with a header repeating the key. A cache file whose header does not match is
+	recreated. Then follows an index of one byte per column, set once the column has been computed, and the tiles.
+	Every tile has the same size in the file, padded with zeros at the edges of the spectrogram, and holds
+	TileFrames*TileBins floats per channel: channel major, then frame, then bin.
+
+	Frames follow DFTAnalysis: frame f starts at sample f*Hop and only whole frames are kept. Samples are scaled to
+	[-1, 1] and magnitudes by 2/sum(window), so that a full scale sinusoid peaks at one.
+
+	Edits to the samples of the Wave file, e.g. with DataEdit(), are picked up from its revision: the frames overlapping
+	the blocks edited since the cache last looked are transformed again, in the columns already computed, and nothing
+	else. As the cache then no longer matches the file on disk, its header is spoilt so that the next session starts
+	afresh; the same goes for a Wave file already modified when the cache is opened.
+
+	The Wave file must stay open for as long as columns may have to be computed.
+*/
+#pragma once
+#ifndef DFTSpectrogram_H
+#define DFTSpectrogram_H
+
+#include <vector>
+#include <string>
+#include "DFTSTFT.h"
+#include "DFTUtility.h"
+#include "WaveFile.h"
+#include "WaveMapping.h"
+
+namespace DFT{
+	class DFTSpectrogram{
+		//Start of the cache file
+		struct Header_T{
+			char Magic[8];						//CACHE_MAGIC
+			unsigned int Version;				//CACHE_VERSION
+			unsigned int DataOffset;			//Byte offset of the first tile
+			unsigned long long SourceHash;		//Hash of the path of the Wave file
+			unsigned long long SourceSize;		//Size of the Wave file in bytes
+			long long SourceTime;				//Last modification time of the Wave file
+			unsigned int SampleRate;
+			unsigned int Channels;
+			unsigned int Blocks;
+			unsigned int FrameSize;
+			unsigned int Hop;
+			unsigned int Window;				//WindowType
+			unsigned int TileFrames;
+			unsigned int TileBins;
+			unsigned int Frames;
+			unsigned int Bins;
+		};
+
+		Wave::WaveFile &Source;					//File analysed
+		Header_T Key;							//What the header of the cache file must be
+		unsigned int Columns;					//Tiles along time
+		unsigned int Rows;						//Tiles along frequency
+		unsigned long long TileBytes;			//Size of a tile in the file
+		std::string CacheFile;					//Path of the cache file
+		Wave::MappedFile Cache;					//The cache file
+		DFTAnalysis Analysis;					//Framing and transform
+		double Normalisation;					//Scales the magnitudes of the decoded samples so that a full scale sinusoid peaks at one
+		unsigned long long Revision;			//Revision of the Wave file the tiles are up to date with
+
+		//Scratch space
+		std::vector<double> Samples;
+		std::vector<std::complex<double> > Spectra;
+
+		//Not copyable
+		DFTSpectrogram(const DFTSpectrogram &);
+		DFTSpectrogram &operator=(const DFTSpectrogram &);
+
+	protected:
+		void Attach(const char *directory);		//Open the cache file matching Key, or create it
+		//Transform frames [first, first+frames) of a column, relative to the column and clipped to it, into its tiles
+		void Compute(unsigned int column, unsigned int first, unsigned int frames);
+		void Invalidate(bool all);				//The cache no longer matches the file on disk. Clear the index if all.
+		float *TileData(unsigned int column, unsigned int row){
+			return reinterpret_cast<float*>(Cache.Data() + Key.DataOffset + (column*(unsigned long long)Rows + row)*TileBytes);
+		}
+
+	public:
+		//Open or create the cache of the Wave file in directory. The Wave file must have been opened from a path.
+		//tileBins is rounded so that the rows of tiles split the bins evenly.
+		DFTSpectrogram(Wave::WaveFile &wave, const char *directory, unsigned int frame=2048, unsigned int hop=512,
+			WindowType window=WindowHann, unsigned int tileFrames=64, unsigned int tileBins=128);
+
+		//Whether a column has been computed
+		bool IsComputed(unsigned int column) const{ return Cache.Data()[sizeof(Header_T) + column] != 0; }
+
+		//Magnitudes of a tile of a channel: TileFrames rows of TileBins bins. Computes its column if needed.
+		//The pointer is into the cache file and stays valid for the life of the object.
+		const float *GetTile(unsigned int column, unsigned int row, unsigned int channel);
+
+		//Magnitudes of a channel over frames [firstFrame, firstFrame+frames) and bins [firstBin, firstBin+bins) into out,
+		//frame after frame, each bins values. Computes the columns needed.
+		void Get(unsigned int channel, unsigned int firstFrame, unsigned int frames, unsigned int firstBin, unsigned int bins, float *out);
+
+		//Transform again the frames overlapping the blocks of the Wave file edited since the last call. Called by GetTile().
+		void Refresh();
+
+		//Write the cached tiles to the file now rather than when the operating system gets to it
+		void Flush(){ Cache.Flush(); }
+
+		//Getters
+		unsigned int NumChannels() const{ return Key.Channels; }
+		unsigned int NumFrames() const{ return Key.Frames; }
+		unsigned int NumBins() const{ return Key.Bins; }
+		unsigned int NumColumns() const{ return Columns; }
+		unsigned int NumRows() const{ return Rows; }
+		unsigned int GetTileFrames() const{ return Key.TileFrames; }
+		unsigned int GetTileBins() const{ return Key.TileBins; }
+		unsigned int GetFrameSize() const{ return Key.FrameSize; }
+		unsigned int GetHop() const{ return Key.Hop; }
+		double GetFrameTime(unsigned int frame) const{ return (frame*double(Key.Hop) + Key.FrameSize/2)/Key.SampleRate; }	//Centre of a frame in seconds
+		double GetBinFrequency(unsigned int bin) const{ return bin*double(Key.SampleRate)/Key.FrameSize; }	//Frequency of a bin in Hz
+		const std::string &GetCacheFile() const{ return CacheFile; }
+	};
+}
+
+#endif /*DFTSpectrogram_H*/
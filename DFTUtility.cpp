@@ -1,8 +1,14 @@
 #include <fstream>
+#include <cmath>
+#include <algorithm>
 #include "Exception.h"
 #include "DFTUtility.h"
 
 namespace DFT{
+	namespace{
+		const unsigned int BULK_INTERVALS = 4096U;		//Intervals copied at a time
+	}
+
 	//Dump to CSV
 	void DumpFile(const DFTData *data, const char *fileename, unsigned int buffer_size){
 		std::ofstream file(fileename, std::ios_base::out | std::ios_base::trunc);
@@ -26,19 +32,27 @@ namespace DFT{
 			unsigned intervalN = data->DFTNumInterval();
 			unsigned dimension = data->DFTDimension();
 
-			for (unsigned i = 0; i < intervalN; i++){
+			//Rows are intervals, so fetch a run of intervals of every dimension at a time
+			std::vector<std::complex<double> > values(BULK_INTERVALS*dimension);
+			for (unsigned first = 0; first < intervalN; first += BULK_INTERVALS){
+				unsigned count = std::min(BULK_INTERVALS, intervalN - first);
 				for (unsigned j = 0; j < dimension; j++){
-					std::complex<double> num = data->DFTGet(i,j);
-					file << num.real();
-					if (num.imag()){
-						if (num.imag() > 0){
-							file << '+';
+					data->DFTGetRange(j, first, count, &values[j*BULK_INTERVALS]);
+				}
+				for (unsigned i = 0; i < count; i++){
+					for (unsigned j = 0; j < dimension; j++){
+						std::complex<double> num = values[j*BULK_INTERVALS + i];
+						file << num.real();
+						if (num.imag()){
+							if (num.imag() > 0){
+								file << '+';
+							}
+							file << num.imag() << 'i';
 						}
-						file << num.imag() << 'i';
+						file << ',';
 					}
-					file << ',';
+					file << '\n';
 				}
-				file << '\n';
 			}
 		}
 		catch(...){
@@ -49,4 +63,62 @@ namespace DFT{
 		delete buffer;
 		file.close();
 	}
+
+	//CopyData()
+	void CopyData(const DFTData &in, DFTData &out){
+		unsigned int intervals = in.DFTNumInterval(), dimensions = in.DFTDimension();
+		if (dimensions != out.DFTDimension()){
+			out.DFTSetDimension(dimensions);
+		}
+		if (intervals != out.DFTNumInterval()){
+			out.DFTSetNumInterval(intervals);
+		}
+		//The upper half of a Hermitian out is its lower half mirrored
+		unsigned int stored = (out.DFTIsHermitian() && intervals) ? intervals/2 + 1 : intervals;
+		std::vector<std::complex<double> > values(std::min(stored, BULK_INTERVALS));
+		for (unsigned int j = 0; j < dimensions; j++){
+			for (unsigned int first = 0; first < stored; first += BULK_INTERVALS){
+				unsigned int count = std::min(BULK_INTERVALS, stored - first);
+				in.DFTGetRange(j, first, count, &values[0]);
+				out.DFTSetRange(j, first, count, &values[0]);
+			}
+		}
+	}
+
+	//Window functions
+	void MakeWindow(WindowType type, unsigned int n, std::vector<double> &window, bool periodic){
+		window.resize(n);
+		if (!n){
+			return;
+		}
+		if (type == WindowSine){
+			for (unsigned int i = 0; i < n; i++){
+				window[i] = sin(PI*(i + 0.5)/n);
+			}
+			return;
+		}
+		//Periodic windows are the symmetric window of length n+1 with the last point dropped
+		double length = periodic ? n : n - 1;
+		if (length == 0){
+			window[0] = 1.0;
+			return;
+		}
+		for (unsigned int i = 0; i < n; i++){
+			double x = 2*PI*i/length;
+			switch (type){
+			case WindowHann:
+				window[i] = 0.5 - 0.5*cos(x);
+				break;
+			case WindowHamming:
+				window[i] = 0.54 - 0.46*cos(x);
+				break;
+			case WindowBlackman:
+				window[i] = 0.42 - 0.5*cos(x) + 0.08*cos(2*x);
+				break;
+			default:
+				window[i] = 1.0;
+				break;
+			}
+		}
+	}
 }
\ No newline at end of file
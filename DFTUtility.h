@@ -5,14 +5,32 @@
 #ifndef DFTUtility_H
 #define DFTUtility_H
 
+#include <vector>
 #include "DFTData.h"
 
 namespace DFT{
+	/* Constants */
+	const double PI = 3.14159265358979323846;
+
 	/* File Functions */
 	//Write the values of the samples into a CSV file. Beware of exceptions thrown!
 	//Data is a pointer to the data object, file is a C string of the file name 
 	//Set buffer to a non-zero size to allow for a larger buffer rather than the default buffer
 	void DumpFile(const DFTData *data, const char *file, unsigned int buffer=0);
+
+	/* Data Functions */
+	//Copy the values of in into out, resized where it supports it, a run of intervals of a dimension at a time.
+	//Only the lower half is copied into a Hermitian out.
+	void CopyData(const DFTData &in, DFTData &out);
+
+	/* Window Functions */
+	enum WindowType { WindowRectangular, WindowHann, WindowHamming, WindowBlackman, WindowSine };
+
+	//Fill window with the n coefficients of the window type.
+	//Periodic windows are the ones to use for spectral estimation and overlap-add. Set periodic to false for the symmetric
+	//version used in filter design.
+	//The sine window, sin(pi (i+1/2)/n), is the MDCT window and ignores periodic.
+	void MakeWindow(WindowType type, unsigned int n, std::vector<double> &window, bool periodic=true);
 }
 
 #endif /*DFTUtility_H*/
\ No newline at end of file
@@ -0,0 +1,123 @@
+//DFTWelch.cpp
+#include <algorithm>
+#include "DFTWelch.h"
+#include "DFTPool.h"
+
+using namespace std;
+namespace DFT{
+	//Constructor
+	DFTWelch::DFTWelch(unsigned int segment, unsigned int overlap, WindowType window)
+		: SegmentSize(segment), Overlap(overlap), WindowPower(0), Plan(NULL),
+		Channels(0), SampleInterval(1.0), Filled(0), Segments(0){
+		if (segment < 2){
+			throw Exception(EXCEPTION_DATA_INVALID, "Segment must have at least two samples!");
+		}
+		if (overlap >= segment){
+			throw Exception(EXCEPTION_DATA_INVALID, "Overlap must be less than the segment length!");
+		}
+		MakeWindow(window, SegmentSize, Window);
+		for (unsigned int i = 0; i < SegmentSize; i++){
+			WindowPower += Window[i]*Window[i];
+		}
+		Plan = &DFTPlan::Get(SegmentSize);
+		Windowed.resize(SegmentSize);
+		Spectrum.resize(Plan->GetRealSize());
+	}
+
+	//Reset()
+	void DFTWelch::Reset(unsigned int channels, double interval){
+		if (!channels || interval <= 0){
+			throw Exception(EXCEPTION_DATA_INVALID, "Channels and/or interval cannot <= zero!");
+		}
+		Channels = channels;
+		SampleInterval = interval;
+		Buffer.assign(Channels*SegmentSize, 0);
+		Accumulator.assign(Channels*Plan->GetRealSize(), 0);
+		Filled = 0;
+		Segments = 0;
+	}
+
+	//Accumulate()
+	void DFTWelch::Accumulate(){
+		unsigned int bins = Plan->GetRealSize();
+		for (unsigned int c = 0; c < Channels; c++){
+			const double *segment = &Buffer[c*SegmentSize];
+			for (unsigned int i = 0; i < SegmentSize; i++){
+				Windowed[i] = segment[i]*Window[i];
+			}
+			Plan->ForwardReal(&Windowed[0], &Spectrum[0]);
+			double *sum = &Accumulator[c*bins];
+			for (unsigned int k = 0; k < bins; k++){
+				sum[k] += Spectrum[k].real()*Spectrum[k].real() + Spectrum[k].imag()*Spectrum[k].imag();
+			}
+		}
+		Segments++;
+	}
+
+	//Push()
+	void DFTWelch::Push(const double *data, unsigned int blocks){
+		if (!Channels){
+			throw Exception(EXCEPTION_INITIALISATION, "Estimator has not been reset for a signal.");
+		}
+		unsigned int hop = SegmentSize - Overlap;
+		while (blocks){
+			//Deinterleave as much as will fit into the current segment
+			unsigned int count = min(blocks, SegmentSize - Filled);
+			for (unsigned int c = 0; c < Channels; c++){
+				double *segment = &Buffer[c*SegmentSize + Filled];
+				for (unsigned int i = 0; i < count; i++){
+					segment[i] = data[i*Channels + c];
+				}
+			}
+			data += count*Channels;
+			blocks -= count;
+			Filled += count;
+
+			if (Filled == SegmentSize){
+				Accumulate();
+				//Keep the overlapping tail as the start of the next segment
+				for (unsigned int c = 0; c < Channels; c++){
+					double *segment = &Buffer[c*SegmentSize];
+					copy(segment + hop, segment + SegmentSize, segment);
+				}
+				Filled = Overlap;
+			}
+		}
+	}
+
+	//Finish()
+	void DFTWelch::Finish(DFTGenericFrequency &result) const{
+		if (!Segments){
+			throw Exception(EXCEPTION_DATA_ERROR, "Not enough data for a single segment.");
+		}
+		unsigned int bins = Plan->GetRealSize();
+		//Density scaling: divide by the sampling rate and the window power, average over the segments
+		double scale = SampleInterval/(WindowPower*Segments);
+
+		result.DFTSetDimension(Channels);
+		result.DFTSetNumInterval(bins);
+		result.DFTSetInterval(1.0/(SampleInterval*SegmentSize));
+		for (unsigned int c = 0; c < Channels; c++){
+			const double *sum = &Accumulator[c*bins];
+			for (unsigned int k = 0; k < bins; k++){
+				//One sided. Fold in the negative frequencies except for DC and, for even lengths, Nyquist
+				bool single = (k == 0) || (SegmentSize % 2 == 0 && k == bins - 1);
+				result.DFTSet(k, c, complex<double>(sum[k]*scale*(single ? 1 : 2), 0));
+			}
+		}
+	}
+
+	//Estimate()
+	void DFTWelch::Estimate(Wave::WaveFile &wave, DFTGenericFrequency &result){
+		Reset(wave.NumChannels(), wave.Interval());
+		//Read one hop at a time
+		unsigned int hop = SegmentSize - Overlap;
+		vector<double, DFTPoolAllocator<double> > chunk(hop*Channels);
+		wave.DataRewind();
+		unsigned int blocks;
+		while ((blocks = wave.DataNextBlocks(&chunk[0], hop)) != 0){
+			Push(&chunk[0], blocks);
+		}
+		Finish(result);
+	}
+}
@@ -0,0 +1,78 @@
+/*
+	DFTWelch
+
+	Welch's method of power spectral density estimation.
+	cf http://en.wikipedia.org/wiki/Welch%27s_method
+
+	The signal is split into overlapping segments, each segment is windowed and transformed, and the
+	periodograms of all the segments are averaged. Unlike a full length transform, the estimator is fed
+	segment by segment so memory stays proportional to the segment length regardless of the length of the signal.
+
+	Usage:
+		- Construct with the segment length, overlap and window
+		- Either call Estimate() with a WaveFile to stream through its data chunk,
+		  or call Reset() and then Push() blocks of interleaved samples as they become available
+		- Finish() writes the averaged one sided PSD into a DFTGenericFrequency object
+
+	The result has SegmentSize/2+1 intervals (DC up to the Nyquist frequency) and one dimension per channel.
+	Its DFTInterval() is the frequency spacing SampleRate/SegmentSize and values are real, in units^2/Hz.
+*/
+#pragma once
+#ifndef DFTWelch_H
+#define DFTWelch_H
+
+#include <vector>
+#include <complex>
+#include "DFTGeneric.h"
+#include "DFTPlan.h"
+#include "DFTUtility.h"
+#include "WaveFile.h"
+
+namespace DFT{
+	class DFTWelch{
+		unsigned int SegmentSize;				//Samples per segment
+		unsigned int Overlap;					//Samples shared by consecutive segments
+		std::vector<double> Window;				//Window coefficients
+		double WindowPower;						//Sum of the squared window coefficients
+		const DFTPlan *Plan;					//Cached transform plan
+
+		unsigned int Channels;					//Number of channels being estimated
+		double SampleInterval;					//Time between samples
+		std::vector<double> Buffer;				//Samples of the current segment. Channel major, SegmentSize per channel
+		unsigned int Filled;					//Number of samples per channel in Buffer
+		std::vector<double> Accumulator;		//Sum of the periodograms. Channel major, SegmentSize/2+1 per channel
+		unsigned int Segments;					//Number of segments accumulated
+
+		//Scratch space for one segment
+		std::vector<double> Windowed;
+		std::vector<std::complex<double> > Spectrum;
+
+	protected:
+		void Accumulate();				//Transform the full segment in Buffer and add it to the Accumulator
+
+	public:
+		//Construct the estimator.
+		//overlap must be less than segment. Half a segment with a Hann window is the usual choice.
+		DFTWelch(unsigned int segment=1024, unsigned int overlap=512, WindowType window=WindowHann);
+
+		//Clear any accumulated data and get ready for a signal with the number of channels and sampling interval
+		void Reset(unsigned int channels, double interval);
+
+		//Add blocks of samples. data holds blocks*channels values interleaved by channel.
+		void Push(const double *data, unsigned int blocks);
+
+		//Averaged periodogram so far. Throws if not even a single segment has been accumulated.
+		void Finish(DFTGenericFrequency &result) const;
+
+		//Stream the whole data chunk of the wave file through the estimator and write the result.
+		//The data is read from the file if it is not loaded, so the file need not fit in memory.
+		void Estimate(Wave::WaveFile &wave, DFTGenericFrequency &result);
+
+		//Getters
+		unsigned int GetSegmentSize() const{ return SegmentSize; }
+		unsigned int GetOverlap() const{ return Overlap; }
+		unsigned int NumSegments() const{ return Segments; }			//Number of segments averaged so far
+	};
+}
+
+#endif /*DFTWelch_H*/
@@ -7,6 +7,8 @@
 #include "DFTGeneric.h"
 #include "WaveFile.h"
 #include "UiWave.h"
+#include "DFTPyramid.h"
+#include "DFTMemo.h"
 
 using namespace std;
 
@@ -24,6 +26,9 @@ namespace Ui{
 	//Declare "SubModule"
 	map<string, MatlabModule_T> MatMods; 
 
+	//Transforms already done, kept across sessions of the module
+	DFT::DFTMemo Memo;
+
 	//Initialise
 	void MatlabInit(MatlabData_T &MatlabData){
 		static bool init = false;
@@ -48,9 +53,11 @@ namespace Ui{
 			//Close
 			MatMods["close"] = MatlabModule_T("close", "Close Matlab Command Window","", &MatlabClose);
 			//Plot
-			MatMods["plot"] = MatlabModule_T("plot", "Plot Responses","Plot the frequency and time domain responses of the variables in Matlab for a particular dimension.\nUsage\n\tplot dimension\nwhere dimension is the dimension to plot data for.", &MatlabPlot);
+			MatMods["plot"] = MatlabModule_T("plot", "Plot Responses","Plot the frequency and time domain responses of the variables in Matlab for a particular dimension.\nEach response is drawn as the minimum, maximum (blue) and rms (red) of the samples under each of width columns, so long signals plot quickly.\nUsage\n\tplot dimension width\nwhere dimension is the dimension to plot data for and width is the number of columns (default 1024).", &MatlabPlot);
 			//Wave
 			MatMods["wave"] = MatlabModule_T("wave", "Copy Data to Wave Module","Based on the data in T, create a wave file object and launch the Wave tool.\nNote: Any modification you make in Wave WILL NOT be saved in Matlab.", &MatlabWave);
+			//Memo
+			MatMods["memo"] = MatlabModule_T("memo", "Transform Memo","Transforms are remembered by the content of their input, so transforming the same data again, e.g. the same audio under another name, does not go through Matlab.\nUsage\n\tmemo directory\nwhere directory is where to keep the results on disk as well, so that they are reused by later runs, or 'off' to keep them in memory only.\nWithout a directory, shows what the memo holds.", &MatlabMemo);
 			init = true;
 		}
 
@@ -63,8 +70,9 @@ namespace Ui{
 			
 		}
 		else{
-			MatlabData.T = new DFT::DFTGenericTime();
-			MatlabData.F = new DFT::DFTGenericFrequency();
+			//Split storage is what Matlab matrices are, so moving data to and from Matlab is a copy per column
+			MatlabData.T = new DFT::DFTGenericTime(1, 1, 0, DFT::DFTGeneric<>::Split);
+			MatlabData.F = new DFT::DFTGenericFrequency(1, 1, 0, DFT::DFTGeneric<>::Split);
 		}
 	}
 	//Intialise DFT Object
@@ -232,15 +240,9 @@ namespace Ui{
 		//Pointer to the "imaginary array" of M
 		double *TIm = mxGetPi(M);
 
-		//Populate M
+		//Populate M, a column at a time
 		for (unsigned j = 0; j < dimension; j++){
-			for (unsigned i = 0; i < intervaln; i++){
-				complex<double> num = data->DFTGet(i, j);
-				//std::cout << i << " " << j << " " << num.real() << endl;
-				//engPutVariable(Matlab, "T", T);
-				*(TReal + j*intervaln+i) = num.real();
-				*(TIm + j*intervaln+i) = num.imag();
-			}
+			data->DFTGetSplit(j, 0, intervaln, TReal + j*intervaln, TIm + j*intervaln);
 		}
 		cout << "Transferring to Matlab Workspace... \n";
 		//Put variable in workspace
@@ -283,6 +285,8 @@ namespace Ui{
 			return;
 		}
 
+		MatlabData.Changed(data);					//Even a partial update invalidates the plot summary
+
 		unsigned intervaln = mxGetM(M);				//Get the number of rows
 		unsigned dimension = mxGetN(M);				//Get number of columns
 
@@ -325,14 +329,8 @@ namespace Ui{
 		double *TIm = mxGetPi(M);
 		//Populate data
 		for (unsigned j = 0; j < dimension; j++){
-			for (unsigned i = 0; i < intervaln; i++){
-				complex<double> num(*(TReal + j*intervaln+i),0);
-				//Imaginary can be zero
-				if (TIm){
-					num.imag(*(TIm + j*intervaln+i));
-				}
-				data->DFTSet(i,j,num);
-			}
+			//Imaginary can be missing
+			data->DFTSetSplit(j, 0, intervaln, TReal + j*intervaln, TIm ? TIm + j*intervaln : NULL);
 		}
 		mxDestroyArray(M);			//Delete matrix and free memory
 		cout << "Done.\n";
@@ -342,7 +340,14 @@ namespace Ui{
 		//Initialise
 		MatlabInitMat(MatlabData);
 		cout << "Performing FFT...";
-		MatlabData.M->DiscreteFourierTransform();
+		DFT::DFTMemoised Transform(*MatlabData.M, Memo, "matlab:fftn");
+		Transform.DiscreteFourierTransform();
+		if (Transform.WasHit()){
+			//Matlab did not run, so leave in the workspace what it would have
+			MatlabData.M->PutVariable("T", *MatlabData.T);
+			MatlabData.M->PutVariable("F", *MatlabData.F);
+		}
+		MatlabData.Changed(MatlabData.F);
 		cout << "Done\n";
 	}
 	//IFFT
@@ -350,7 +355,13 @@ namespace Ui{
 		//Initialise
 		MatlabInitMat(MatlabData);
 		cout << "Performing Inverse FFT...";
-		MatlabData.M->InverseDiscreteFourierTransform();
+		DFT::DFTMemoised Transform(*MatlabData.M, Memo, "matlab:fftn");
+		Transform.InverseDiscreteFourierTransform();
+		if (Transform.WasHit()){
+			MatlabData.M->PutVariable("F", *MatlabData.F);
+			MatlabData.M->PutVariable("T", *MatlabData.T);
+		}
+		MatlabData.Changed(MatlabData.T);
 		cout << "Done\n";
 	}
 
@@ -363,45 +374,125 @@ namespace Ui{
 	void MatlabClose(std::string arg, MatlabData_T &MatlabData){
 		Matlab.MakeInvisible();
 	}
+
+	//Memo
+	void MatlabMemo(std::string arg, MatlabData_T &MatlabData){
+		stringstream cmd(arg);
+		string directory;
+		cmd >> directory;
+		if (directory == "off"){
+			Memo.SetDirectory("");
+		}
+		else if (!directory.empty()){
+			Memo.SetDirectory(directory);
+		}
+		OutputLine();
+		cout << "Transform Memo\n";
+		cout << "\tResults in memory: " << Memo.NumEntries() << " (" << Memo.GetSize() << " of " << Memo.GetCapacity() << " bytes)\n";
+		cout << "\tDisk directory: " << (Memo.GetDirectory().empty() ? string("None") : Memo.GetDirectory()) << "\n";
+		cout << "\tServed from memory: " << Memo.NumHits() << "\n";
+		cout << "\tServed from disk: " << Memo.NumDiskHits() << "\n";
+		cout << "\tComputed: " << Memo.NumMisses() << "\n";
+		OutputLine();
+	}
 	//Plot()
+	//Send one series of a pyramid to Matlab as a min/max envelope and an rms line, and plot it in the current axes.
+	//x of column c is (begin + c + 1/2 column)*scale + offset
+	void MatlabPlotSeries(const DFT::DFTPyramid &pyramid, unsigned int series, unsigned int begin, unsigned int end, unsigned int width,
+		double scale, double offset){
+		vector<double> Min, Max, RMS;
+		unsigned int columns = pyramid.Query(series, begin, end, width, Min, Max, RMS);
+		if (!columns){
+			return;
+		}
+		//The envelope is a single line going from the minimum to the maximum of each column in turn
+		mxArray *X = mxCreateDoubleMatrix(2*columns, 1, mxREAL);
+		mxArray *Y = mxCreateDoubleMatrix(2*columns, 1, mxREAL);
+		mxArray *RX = mxCreateDoubleMatrix(columns, 1, mxREAL);
+		mxArray *R = mxCreateDoubleMatrix(columns, 1, mxREAL);
+		if (!X || !Y || !RX || !R){
+			mxDestroyArray(X);
+			mxDestroyArray(Y);
+			mxDestroyArray(RX);
+			mxDestroyArray(R);
+			cout << "Error: Unable to allocate memory to create Matlab Matrix.\n";
+			return;
+		}
+		double *x = mxGetPr(X), *y = mxGetPr(Y), *rx = mxGetPr(RX), *r = mxGetPr(R);
+		double perColumn = double(end - begin)/columns;
+		for (unsigned int c = 0; c < columns; c++){
+			double position = (begin + (c + 0.5)*perColumn)*scale + offset;
+			x[2*c] = x[2*c+1] = rx[c] = position;
+			y[2*c] = Min[c];
+			y[2*c+1] = Max[c];
+			r[c] = RMS[c];
+		}
+		engPutVariable(Matlab(), "PlotX", X);
+		engPutVariable(Matlab(), "PlotY", Y);
+		engPutVariable(Matlab(), "PlotRX", RX);
+		engPutVariable(Matlab(), "PlotR", R);
+		mxDestroyArray(X);
+		mxDestroyArray(Y);
+		mxDestroyArray(RX);
+		mxDestroyArray(R);
+
+		string _cmd = "plot(PlotX, PlotY, 'b', PlotRX, PlotR, 'r')";
+		cout << "\t" << _cmd << "\n";
+		engEvalString(Matlab(),_cmd.c_str());
+	}
 	void MatlabPlot(std::string arg, MatlabData_T &MatlabData){
 		stringstream cmd = stringstream(arg);
 		//Get Dimension
 		unsigned int dimension = 0;
 		cmd >> dimension;
+		//Get width
+		unsigned int width = 1024;
+		cmd >> width;
 
-		if (!dimension || dimension > MatlabData.T ->DFTDimension()){
+		if (!dimension || dimension > MatlabData.T ->DFTDimension() || dimension > MatlabData.F->DFTDimension()){
 			cout << "Invalid dimension. Please see help for more information. \n";
 			return;
 		}
-		
-		//Create subplot
-		engEvalString(Matlab(),"subplot(2,2,1)");
+		if (!width){
+			cout << "Invalid width. Please see help for more information. \n";
+			return;
+		}
+
+		//Summaries are built once and reused until the data changes
+		try{
+			if (!MatlabData.TPyramid){
+				cout << "Summarising Time Domain data...\n";
+				MatlabData.TPyramid = new DFT::DFTPyramid();
+				MatlabData.TPyramid->Build(*MatlabData.T, true);
+			}
+			if (!MatlabData.FPyramid){
+				cout << "Summarising Frequency Domain data...\n";
+				MatlabData.FPyramid = new DFT::DFTPyramid();
+				MatlabData.FPyramid->Build(*MatlabData.F, true);
+			}
+		}
+		catch (bad_alloc){
+			cout << "Error: Unable to allocate memory to summarise the data.\n";
+			return;
+		}
+		const DFT::DFTPyramid &TPyramid = *MatlabData.TPyramid, &FPyramid = *MatlabData.FPyramid;
+		unsigned int real = dimension - 1;
+
 		cout << "Creating graph... (see Matlab Commands below)\n";
-		cout << "\t" << "subplot(2,2,1)" << "\n";
 
 		stringstream _dimension;				//Dimension
 		_dimension << dimension;
 
-		stringstream _interval;
-		_interval << MatlabData.T->DFTInterval();
-
-		stringstream _endTime;
-		_endTime << MatlabData.T->DFTInterval()*MatlabData.T->DFTNumInterval()-MatlabData.T->DFTInterval();
-
-		MatlabSend("f FData",MatlabData);
-		MatlabSend("t TData", MatlabData);
-
 		string _cmd;
+		double interval = MatlabData.T->DFTInterval();
+		unsigned int samples = TPyramid.NumSamples();
 
 		//Time Domain Real
-		_cmd = "DataX = 0:" + _interval.str() + ":" + _endTime.str();			//X-Axis
+		_cmd = "subplot(2,2,1)";
 		cout << "\t" << _cmd << "\n";
 		engEvalString(Matlab(),_cmd.c_str());
 
-		_cmd = "stairs(DataX, real(TData(:," + _dimension.str() + ")))";
-		cout << "\t" << _cmd << "\n";
-		engEvalString(Matlab(),_cmd.c_str());
+		MatlabPlotSeries(TPyramid, real, 0, samples, width, interval, 0);
 
 		_cmd = "title('Time Domain Dimension " + _dimension.str() + " (Real)', 'FontWeight', 'bold')";	//Title
 		cout << "\t" << _cmd << "\n";
@@ -416,13 +507,7 @@ namespace Ui{
 		cout << "\t" << _cmd << "\n";
 		engEvalString(Matlab(),_cmd.c_str());
 
-		_cmd = "DataX = 0:" + _interval.str() + ":" + _endTime.str();			//X-Axis
-		cout << "\t" << _cmd << "\n";
-		engEvalString(Matlab(),_cmd.c_str());
-
-		_cmd = "stairs(DataX, imag(TData(:," + _dimension.str() + ")))";
-		cout << "\t" << _cmd << "\n";
-		engEvalString(Matlab(),_cmd.c_str());
+		MatlabPlotSeries(TPyramid, TPyramid.NumDimensions() + real, 0, samples, width, interval, 0);
 
 		_cmd = "title('Time Domain Dimension " + _dimension.str() + " (Imaginary)', 'FontWeight', 'bold')";	//Title
 		cout << "\t" << _cmd << "\n";
@@ -433,20 +518,14 @@ namespace Ui{
 		engEvalString(Matlab(),_cmd.c_str());
 
 		//Plot Freq - Real
-		_cmd = "subplot(2,2,3)";
-		cout << "\t" << _cmd << "\n";
-		engEvalString(Matlab(),_cmd.c_str());
+		//From zero to Nyquist frequency (one-half the sampling rate) i.e. N/2. Frequency samples are numbered from one
+		unsigned int bins = FPyramid.NumSamples()/2;
 
-		stringstream _freqInterval;
-		_freqInterval << unsigned(MatlabData.F->DFTNumInterval()/2);			//From zero to Nyquist frequency (one-half the sampling rate) i.e. N/2
-
-		_cmd = "FreqX = 1:1:" + _freqInterval.str();			//X-Axis
+		_cmd = "subplot(2,2,3)";
 		cout << "\t" << _cmd << "\n";
 		engEvalString(Matlab(),_cmd.c_str());
 
-		_cmd = "stairs(FreqX, real(FData(1:" + _freqInterval.str() +"," + _dimension.str() + ")))";
-		cout << "\t" << _cmd << "\n";
-		engEvalString(Matlab(),_cmd.c_str());
+		MatlabPlotSeries(FPyramid, real, 0, bins, width, 1, 1);
 
 		_cmd = "title('Frequency Domain Dimension " + _dimension.str() + " (Real)', 'FontWeight', 'bold')";	//Title
 		cout << "\t" << _cmd << "\n";
@@ -461,9 +540,7 @@ namespace Ui{
 		cout << "\t" << _cmd << "\n";
 		engEvalString(Matlab(),_cmd.c_str());
 
-		_cmd = "stairs(FreqX, imag(FData(1:" + _freqInterval.str() +"," + _dimension.str() + ")))";
-		cout << "\t" << _cmd << "\n";
-		engEvalString(Matlab(),_cmd.c_str());
+		MatlabPlotSeries(FPyramid, FPyramid.NumDimensions() + real, 0, bins, width, 1, 1);
 
 		_cmd = "title('Frequency Domain Dimension " + _dimension.str() + " (Imaginary)', 'FontWeight', 'bold')";	//Title
 		cout << "\t" << _cmd << "\n";
@@ -502,8 +579,10 @@ namespace Ui{
 		
 		//Channel
 		unsigned channels = MatlabData.T->DFTDimension();
-		//Build Data
-		vector<char> data;
+		//Build Data, straight into the buffer the wave object will hold
+		DFT::DFTShared<char> shared;
+		DFT::DFTShared<char>::Vector_T &data = shared.Edit();
+		data.reserve(size_t(MatlabData.T->DFTNumInterval())*channels*(BitRate/8));
 		for (unsigned i = 0; i < MatlabData.T->DFTNumInterval(); i++){
 			for (unsigned j = 0; j < channels; j++){
 				int num = MatlabData.T->DFTGet(i, j).real();
@@ -516,7 +595,7 @@ namespace Ui{
 		cout << "Creating object...";
 
 		try{
-			Wave::WaveFile WaveObj = Wave::WaveFile::CreateObject(channels, SampleRate, BitRate, data);
+			Wave::WaveFile WaveObj = Wave::WaveFile::CreateObject(channels, SampleRate, BitRate, shared);
 			DFT::DFTGenericFrequency FreqObj;
 
 			PresetWave = &WaveObj;
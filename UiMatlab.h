@@ -9,6 +9,7 @@
 #include <string>
 #include "DFTMatlab.h"
 #include "DFTData.h"
+#include "DFTPyramid.h"
 
 namespace Ui{
 	//Data Structure
@@ -18,14 +19,29 @@ namespace Ui{
 		DFT::DFTMatlab *M;				//Ptr to matlab transform obj
 		bool IsPreset;					//Is Preset?
 		bool ListCmd;
+		DFT::DFTPyramid *TPyramid;		//Plot summary of T. NULL until needed
+		DFT::DFTPyramid *FPyramid;		//Plot summary of F. NULL until needed
 
-		MatlabData_T(): T(NULL), F(NULL), M(NULL), IsPreset(false), ListCmd(true) {}
+		MatlabData_T(): T(NULL), F(NULL), M(NULL), IsPreset(false), ListCmd(true), TPyramid(NULL), FPyramid(NULL) {}
 		~MatlabData_T(){
 			if (!IsPreset){
 				delete T;
 				delete F;
 			}
 			delete M;
+			delete TPyramid;
+			delete FPyramid;
+		}
+		//Call when the data of T or F has been modified so that its plot summary is rebuilt
+		void Changed(const DFT::DFTData *data){
+			if (data == T){
+				delete TPyramid;
+				TPyramid = NULL;
+			}
+			if (data == F){
+				delete FPyramid;
+				FPyramid = NULL;
+			}
 		}
 	};
 
@@ -58,6 +74,7 @@ namespace Ui{
 	void MatlabStatus(std::string arg, MatlabData_T &MatlabData);	//Status of T & F variables
 	void MatlabWave(std::string arg, MatlabData_T &MatlabData);		//Create a Wave object and launch the Wave module
 	void MatlabPlot(std::string arg, MatlabData_T &MatlabData);		//Plot data
+	void MatlabMemo(std::string arg, MatlabData_T &MatlabData);		//Transform memo settings and statistics
 
 	//Overload Launch Module
 	void LaunchModule(void (*method)(std::string arg, MatlabData_T &MatlabData), std::string arg, MatlabData_T &MatlabData, std::string ID);
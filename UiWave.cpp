@@ -2,7 +2,22 @@
 #include "Ui.h"
 #include "UiWave.h"
 #include "UiMatlab.h"
+#include "DFTWelch.h"
+#include "WaveResampler.h"
+#include "DFTFeatures.h"
+#include "DFTPitch.h"
+#include "DFTOnset.h"
+#include "DFTPyramid.h"
+#include "DFTSpectrogram.h"
+#include "DFTHilbert.h"
+#include "DFTFilterbank.h"
+#include "DFTSTFT.h"
+#include "DFTCQT.h"
+#include "DFTScheduler.h"
+#include "DFTReal.h"
 #include <iostream>
+#include <cmath>
+#include <algorithm>
 #include <vector>
 #include <map>
 #include <new>
@@ -50,6 +65,28 @@ namespace Ui{
 			WaveMods["unload"] = WaveModule_T("unload", "Unload Data", "Unload any data in memory. This CLEARS all data in memory and if they were not saved, they will be lost", &WaveLoad);
 			//Write
 			WaveMods["write"] = WaveModule_T("write", "Write Wave File", "Based on the data contained in memory, write to a wave file.\nUsage\n\twrite file\nwhere file is the path to the file to write.", &WaveWrite);
+			//Welch
+			WaveMods["welch"] = WaveModule_T("welch", "Power Spectral Density", "Estimate the power spectral density of every channel using Welch's method and store it as the Frequency Domain data.\nThe file is streamed segment by segment so it does not have to be loaded into memory.\nUsage:\n\twelch segment overlap\nwhere segment is the number of samples per segment (default 1024) and overlap is the number of samples shared by consecutive segments (default half a segment).", &WaveWelch);
+			//Resample
+			WaveMods["resample"] = WaveModule_T("resample", "Resample", "Convert the Wave file to another sample rate with a polyphase filter and write the result to a new file.\nThe file is streamed so it does not have to be loaded into memory.\nUsage:\n\tresample rate file bits\nwhere rate is the new sample rate, file is the path to the file to write and bits is the sample size of the new file (default: same as the current file).", &WaveResample);
+			//Features
+			WaveMods["features"] = WaveModule_T("features", "Spectral Features", "Compute the spectral centroid, bandwidth, rolloff, flatness, flux and peaks of every frame of every channel and write them to a CSV file.\nThe file is streamed so it does not have to be loaded into memory.\nUsage:\n\tfeatures file frame hop peaks\nwhere file is the path to the CSV file to write, frame is the number of samples per frame (default 2048), hop is the number of samples between frames (default a quarter of a frame) and peaks is the number of peaks per frame (default 5).", &WaveFeatures);
+			//Pitch
+			WaveMods["pitch"] = WaveModule_T("pitch", "Pitch Tracking", "Estimate the fundamental frequency and its confidence for every frame of every channel with the YIN algorithm and write them to a CSV file.\nThe file is streamed so it does not have to be loaded into memory.\nUsage:\n\tpitch file minimum maximum\nwhere file is the path to the CSV file to write and minimum and maximum are the frequency range to track in Hz (default 60 to 800).", &WavePitch);
+			//Onsets
+			WaveMods["onsets"] = WaveModule_T("onsets", "Onset Detection", "Detect note onsets with the spectral flux and write their times in seconds to a file, one per line.\nThe file is streamed hop by hop so memory does not depend on its length.\nUsage:\n\tonsets file delta\nwhere file is the path to the file to write and delta is the detection threshold (default 0.01).", &WaveOnsets);
+			//Overview
+			WaveMods["overview"] = WaveModule_T("overview", "Waveform Overview", "Write the minimum, maximum and rms of every channel over width columns to a CSV file, e.g. to draw the waveform.\nThe file is read once in a single pass.\nUsage:\n\toverview file width\nwhere file is the path to the file to write and width is the number of columns (default 1024).", &WaveOverview);
+			//Spectrogram
+			WaveMods["spectrogram"] = WaveModule_T("spectrogram", "Cached Spectrogram", "Write the magnitude spectrogram of a range of the file to a CSV file: the time of the frame, the channel and the magnitude of each bin per row.\nThe spectrogram is computed lazily into a cache file which later calls and sessions reuse, so revisiting a range costs no transforms.\nUsage:\n\tspectrogram cache file start duration\nwhere cache is the directory of the cache files, file is the path to the file to write and start and duration are in seconds (default 0 and 10).", &WaveSpectrogram);
+			//Envelope
+			WaveMods["envelope"] = WaveModule_T("envelope", "Amplitude Envelope", "Write the amplitude envelope of every channel, i.e. the magnitude of its analytic signal, to a new Wave file.\nThe file is streamed in overlapping blocks so memory does not depend on its length.\nUsage:\n\tenvelope file bits\nwhere file is the path to the file to write and bits is its sample size (default that of this file).", &WaveEnvelope);
+			//MFCC
+			WaveMods["mfcc"] = WaveModule_T("mfcc", "Mel Frequency Cepstral Coefficients", "Write the MFCC of every frame and channel to a CSV file: the time of the frame, the channel and the coefficients per row.\nUsage:\n\tmfcc file bands coefficients frame hop\nwhere file is the path to the file to write, bands the number of mel filters (default 40), coefficients the number kept (default 13), frame the frame size (default 2048) and hop the samples between frames (default a quarter frame).", &WaveMFCC);
+			//CQT
+			WaveMods["cqt"] = WaveModule_T("cqt", "Constant-Q Transform", "Write the constant-Q magnitudes of every frame and channel to a CSV file: the time of the frame, the channel and the magnitude of each bin per row.\nThe first row holds the frequencies of the bins.\nUsage:\n\tcqt file bins minimum\nwhere file is the path to the file to write, bins the number of bins per octave (default 12) and minimum the frequency of the first bin in Hz (default 55).", &WaveCQT);
+			//STFT
+			WaveMods["stft"] = WaveModule_T("stft", "Parallel STFT", "Write the magnitude spectrogram of the whole file to a CSV file: the time of the frame, the channel and the magnitude of each bin per row.\nFrames are transformed on several threads and written in order.\nUsage:\n\tstft file frame hop threads\nwhere file is the path to the file to write, frame the frame size (default 1024), hop the samples between frames (default half a frame) and threads the number of threads (default one per hardware thread).", &WaveSTFT);
 			init = true;
 		}
 		if(PresetWave && PresetFreq){
@@ -285,7 +322,8 @@ namespace Ui{
 	void WaveCopy(std::string arg, WaveData_T &WaveData){
 		cout << "Copying data...\n";
 		//Create objects
-		DFT::DFTGenericTime *T = new(nothrow) DFT::DFTGenericTime(WaveData.Wav->DFTDimension(), WaveData.Wav->DFTInterval(), WaveData.Wav->DFTNumInterval());
+		//Audio is real, so the time domain holds real values only
+		DFT::DFTRealTime *T = new(nothrow) DFT::DFTRealTime(WaveData.Wav->DFTDimension(), WaveData.Wav->DFTInterval(), WaveData.Wav->DFTNumInterval());
 		if (!T){
 			cout << "Error: Could not copy Wave data.\n";
 			return;
@@ -293,10 +331,11 @@ namespace Ui{
 		//Create object
 		DFT::DFTGenericFrequency *F = NULL;
 		if (WaveData.Freq){
-			 F = new(nothrow) DFT::DFTGenericFrequency(WaveData.Freq->DFTDimension(), WaveData.Freq->DFTInterval(), WaveData.Freq->DFTNumInterval());
+			 F = new(nothrow) DFT::DFTGenericFrequency(WaveData.Freq->DFTDimension(), WaveData.Freq->DFTInterval(), WaveData.Freq->DFTSample(),
+				DFT::DFTGeneric<>::Split);
 		}
 		else{
-			F = new(nothrow) DFT::DFTGenericFrequency(); 
+			F = new(nothrow) DFT::DFTGenericFrequency(1, 1, 0, DFT::DFTGeneric<>::Split);
 		}
 
 		if (!F){
@@ -306,22 +345,10 @@ namespace Ui{
 
 		try{
 			//Populate time data
-			unsigned intervalN = WaveData.Wav->DFTNumInterval();
-			unsigned dimension = WaveData.Wav->DFTDimension();
-			for (unsigned i = 0; i < intervalN; i++){
-				for (unsigned j = 0; j < dimension; j++){
-					T->DFTSet(i,j, WaveData.Wav->DFTGet(i,j));
-				}
-			}
+			DFT::CopyData(*WaveData.Wav, *T);
 			//Populate freq data
 			if (WaveData.Freq){
-				intervalN = WaveData.Freq->DFTNumInterval();
-				dimension = WaveData.Freq->DFTDimension();
-				for (unsigned i = 0; i < intervalN; i++){
-					for (unsigned j = 0; j < dimension; j++){
-						F->DFTSet(i,j, WaveData.Freq->DFTGet(i,j));
-					}
-				}
+				DFT::CopyData(*WaveData.Freq, *F);
 			}
 			//Dynamic cast to allow for use in Matlab module
 			PresetT = dynamic_cast<DFT::DFTTime*>(T);
@@ -388,4 +415,389 @@ namespace Ui{
 			cout << "An error has occurred: " << e.GetErrorMessage() << "\n";
 		}
 	}
+	//Welch
+	void WaveWelch(std::string arg, WaveData_T &WaveData){
+		stringstream cmd(arg);
+		unsigned int segment = 1024;
+		cmd >> segment;
+		unsigned int overlap = segment/2;
+		cmd >> overlap;
+
+		if (!WaveData.Freq){
+			WaveData.Freq = new (nothrow) DFT::DFTGenericFrequency();
+			if (!WaveData.Freq){
+				cout << "Error, could not allocate memory to store Frequency Domain data\n";
+				return;
+			}
+		}
+		try{
+			cout << "Estimating power spectral density... ";
+			DFT::DFTWelch Welch(segment, overlap);
+			Welch.Estimate(*WaveData.Wav, *WaveData.Freq);
+			cout << "Done. " << Welch.NumSegments() << " segments averaged.\n";
+		}
+		catch(Exception &e){
+			cout << "An error has occurred: " << e.GetErrorMessage() << "\n";
+		}
+	}
+	//Resample
+	void WaveResample(std::string arg, WaveData_T &WaveData){
+		stringstream cmd(arg);
+		unsigned int rate = 0, bits = 0;
+		string file;
+		cmd >> rate >> file >> bits;
+		if (!rate || file.empty()){
+			return LaunchModule(&WaveHelp, "resample", WaveData, "help");
+		}
+		try{
+			cout << "Resampling... ";
+			Wave::WaveResampler Resampler(WaveData.Wav->SampleRate(), rate);
+			Resampler.Process(*WaveData.Wav, file.c_str(), bits);
+			cout << "Done. " << Resampler.GetUp() << "/" << Resampler.GetDown() << " conversion written.\n";
+		}
+		catch(Exception &e){
+			cout << "An error has occurred: " << e.GetErrorMessage() << "\n";
+		}
+	}
+	//Features
+	void WaveFeatures(std::string arg, WaveData_T &WaveData){
+		stringstream cmd(arg);
+		string file;
+		cmd >> file;
+		if (file.empty()){
+			return LaunchModule(&WaveHelp, "features", WaveData, "help");
+		}
+		unsigned int frame = 2048;
+		cmd >> frame;
+		unsigned int hop = frame/4, peaks = 5;
+		cmd >> hop >> peaks;
+		try{
+			cout << "Computing spectral features... ";
+			DFT::DFTFeatureTable Table;
+			DFT::DFTFeatures::Extract(*WaveData.Wav, Table, frame, hop, peaks);
+			Table.Write(file.c_str());
+			cout << "Done. " << Table.NumFrames() << " frames written.\n";
+		}
+		catch(Exception &e){
+			cout << "An error has occurred: " << e.GetErrorMessage() << "\n";
+		}
+	}
+	//Pitch
+	void WavePitch(std::string arg, WaveData_T &WaveData){
+		stringstream cmd(arg);
+		string file;
+		cmd >> file;
+		if (file.empty()){
+			return LaunchModule(&WaveHelp, "pitch", WaveData, "help");
+		}
+		double minimum = 60, maximum = 800;
+		cmd >> minimum >> maximum;
+		try{
+			cout << "Tracking pitch... ";
+			DFT::DFTPitch Pitch(WaveData.Wav->SampleRate(), minimum, maximum);
+			DFT::DFTPitchTrack Track;
+			Pitch.Track(*WaveData.Wav, Track);
+			ofstream csv(file.c_str(), ios_base::out | ios_base::trunc);
+			if (!csv){
+				throw Exception(EXCEPTION_FILE_CANNOT_OPEN_OUTPUT, "Unable to open file for writing.");
+			}
+			csv << "time,channel,frequency,confidence\n";
+			for (unsigned int i = 0; i < Track.Frequency.size(); i++){
+				csv << Track.GetFrameTime(i/Track.Channels) << ',' << i % Track.Channels << ',' << Track.Frequency[i] << ',' << Track.Confidence[i] << '\n';
+			}
+			cout << "Done. " << Track.NumFrames() << " frames written.\n";
+		}
+		catch(Exception &e){
+			cout << "An error has occurred: " << e.GetErrorMessage() << "\n";
+		}
+	}
+	//Onsets
+	void WaveOnsets(std::string arg, WaveData_T &WaveData){
+		stringstream cmd(arg);
+		string file;
+		cmd >> file;
+		if (file.empty()){
+			return LaunchModule(&WaveHelp, "onsets", WaveData, "help");
+		}
+		double delta = 0.01;
+		cmd >> delta;
+		try{
+			cout << "Detecting onsets... ";
+			DFT::DFTOnset Onset(2048, 441, delta);
+			vector<double> Onsets;
+			Onset.Detect(*WaveData.Wav, Onsets);
+			ofstream out(file.c_str(), ios_base::out | ios_base::trunc);
+			if (!out){
+				throw Exception(EXCEPTION_FILE_CANNOT_OPEN_OUTPUT, "Unable to open file for writing.");
+			}
+			for (unsigned int i = 0; i < Onsets.size(); i++){
+				out << Onsets[i] << '\n';
+			}
+			cout << "Done. " << Onsets.size() << " onsets written.\n";
+		}
+		catch(Exception &e){
+			cout << "An error has occurred: " << e.GetErrorMessage() << "\n";
+		}
+	}
+	//Overview
+	void WaveOverview(std::string arg, WaveData_T &WaveData){
+		stringstream cmd(arg);
+		string file;
+		cmd >> file;
+		if (file.empty()){
+			return LaunchModule(&WaveHelp, "overview", WaveData, "help");
+		}
+		unsigned int width = 1024;
+		cmd >> width;
+		try{
+			cout << "Summarising... ";
+			DFT::DFTPyramid Pyramid;
+			Pyramid.Build(*WaveData.Wav);
+			Pyramid.Export(file.c_str(), width);
+			cout << "Done.\n";
+		}
+		catch(Exception &e){
+			cout << "An error has occurred: " << e.GetErrorMessage() << "\n";
+		}
+	}
+	//Spectrogram
+	void WaveSpectrogram(std::string arg, WaveData_T &WaveData){
+		stringstream cmd(arg);
+		string cache, file;
+		cmd >> cache >> file;
+		if (cache.empty() || file.empty()){
+			return LaunchModule(&WaveHelp, "spectrogram", WaveData, "help");
+		}
+		double start = 0, duration = 10;
+		cmd >> start >> duration;
+		try{
+			DFT::DFTSpectrogram Spectrogram(*WaveData.Wav, cache.c_str());
+			//Frames whose centre is in the range
+			double frameTime = Spectrogram.GetFrameTime(1) - Spectrogram.GetFrameTime(0);
+			double first = ceil((start - Spectrogram.GetFrameTime(0))/frameTime);
+			double last = ceil((start + duration - Spectrogram.GetFrameTime(0))/frameTime);
+			unsigned int begin = unsigned(min(double(Spectrogram.NumFrames()), max(0.0, first)));
+			unsigned int end = unsigned(min(double(Spectrogram.NumFrames()), max(0.0, last)));
+			unsigned int bins = Spectrogram.NumBins(), channels = Spectrogram.NumChannels();
+
+			ofstream out(file.c_str(), ios_base::out | ios_base::trunc);
+			if (!out){
+				throw Exception(EXCEPTION_FILE_CANNOT_OPEN_OUTPUT, "Unable to open file for writing.");
+			}
+			cout << "Reading spectrogram... ";
+			vector<float> Magnitudes(bins);
+			for (unsigned int f = begin; f < end; f++){
+				for (unsigned int c = 0; c < channels; c++){
+					Spectrogram.Get(c, f, 1, 0, bins, &Magnitudes[0]);
+					out << Spectrogram.GetFrameTime(f) << ',' << c;
+					for (unsigned int k = 0; k < bins; k++){
+						out << ',' << Magnitudes[k];
+					}
+					out << '\n';
+				}
+			}
+			cout << "Done. " << end - begin << " frames written.\n";
+		}
+		catch(Exception &e){
+			cout << "An error has occurred: " << e.GetErrorMessage() << "\n";
+		}
+	}
+	//Envelope
+	void WaveEnvelope(std::string arg, WaveData_T &WaveData){
+		stringstream cmd(arg);
+		string file;
+		cmd >> file;
+		if (file.empty()){
+			return LaunchModule(&WaveHelp, "envelope", WaveData, "help");
+		}
+		unsigned int bits = WaveData.Wav->SampleSize();
+		cmd >> bits;
+		try{
+			cout << "Computing envelope... ";
+			DFT::DFTHilbert Hilbert;
+			Wave::WaveWriter Writer(file.c_str(), WaveData.Wav->NumChannels(), WaveData.Wav->SampleRate(), bits);
+			Hilbert.Envelope(*WaveData.Wav, Writer);
+			Writer.Close();
+			cout << "Done. " << Hilbert.NumSamples() << " blocks written.\n";
+		}
+		catch(Exception &e){
+			cout << "An error has occurred: " << e.GetErrorMessage() << "\n";
+		}
+	}
+	//MFCC
+	void WaveMFCC(std::string arg, WaveData_T &WaveData){
+		stringstream cmd(arg);
+		string file;
+		cmd >> file;
+		if (file.empty()){
+			return LaunchModule(&WaveHelp, "mfcc", WaveData, "help");
+		}
+		unsigned int bands = 40, coefficients = 13, frame = 2048;
+		cmd >> bands >> coefficients >> frame;
+		unsigned int hop = frame/4;
+		cmd >> hop;
+		try{
+			cout << "Computing MFCC... ";
+			Wave::WaveFile &Wav = *WaveData.Wav;
+			const DFT::DFTFilterbank &Filterbank = DFT::DFTFilterbank::Get(DFT::DFTFilterbank::Mel, Wav.SampleRate(), frame, bands);
+			DFT::DFTAnalysis Analysis(frame, hop);
+			unsigned int channels = Wav.NumChannels(), bins = Analysis.GetBins();
+			Analysis.Reset(channels);
+			if (coefficients > bands){
+				throw Exception(EXCEPTION_DATA_INVALID, "Cannot have more coefficients than bands!");
+			}
+			ofstream out(file.c_str(), ios_base::out | ios_base::trunc);
+			if (!out){
+				throw Exception(EXCEPTION_FILE_CANNOT_OPEN_OUTPUT, "Unable to open file for writing.");
+			}
+			//Full scale to [-1, 1]
+			double scale = ldexp(1.0, 1 - int(Wav.SampleSize()));
+			vector<double> chunk(hop*channels), power, cepstrum;
+			vector<complex<double> > spectra;
+			unsigned int blocks, frames = 0;
+			Wav.DataRewind();
+			while ((blocks = Wav.DataNextBlocks(&chunk[0], hop)) != 0){
+				for (unsigned int i = 0; i < blocks*channels; i++){
+					chunk[i] *= scale;
+				}
+				unsigned int n = Analysis.Push(&chunk[0], blocks, spectra);
+				if (!n){
+					continue;
+				}
+				//One row per frame and channel
+				power.resize(n*channels*bins);
+				for (unsigned int i = 0; i < power.size(); i++){
+					power[i] = norm(spectra[i]);
+				}
+				cepstrum.resize(n*channels*coefficients);
+				Filterbank.Cepstrum(&power[0], n*channels, bins, coefficients, &cepstrum[0]);
+				for (unsigned int r = 0; r < n*channels; r++){
+					out << ((frames + r/channels)*double(hop) + frame/2)*Wav.Interval() << ',' << r % channels;
+					for (unsigned int k = 0; k < coefficients; k++){
+						out << ',' << cepstrum[r*coefficients + k];
+					}
+					out << '\n';
+				}
+				frames += n;
+			}
+			cout << "Done. " << frames << " frames written.\n";
+		}
+		catch(Exception &e){
+			cout << "An error has occurred: " << e.GetErrorMessage() << "\n";
+		}
+	}
+	//CQT
+	void WaveCQT(std::string arg, WaveData_T &WaveData){
+		stringstream cmd(arg);
+		string file;
+		cmd >> file;
+		if (file.empty()){
+			return LaunchModule(&WaveHelp, "cqt", WaveData, "help");
+		}
+		unsigned int binsPerOctave = 12;
+		double minimum = 55;
+		cmd >> binsPerOctave >> minimum;
+		try{
+			cout << "Computing constant-Q transform... ";
+			Wave::WaveFile &Wav = *WaveData.Wav;
+			DFT::DFTCQT CQT(Wav.SampleRate(), binsPerOctave, minimum);
+			unsigned int channels = Wav.NumChannels(), bins = CQT.NumBins();
+			CQT.Reset(channels);
+			ofstream out(file.c_str(), ios_base::out | ios_base::trunc);
+			if (!out){
+				throw Exception(EXCEPTION_FILE_CANNOT_OPEN_OUTPUT, "Unable to open file for writing.");
+			}
+			//Header of bin frequencies
+			out << "time,channel";
+			for (unsigned int k = 0; k < bins; k++){
+				out << ',' << CQT.GetFrequency(k);
+			}
+			out << '\n';
+			//Full scale to [-1, 1]
+			double scale = ldexp(1.0, 1 - int(Wav.SampleSize()));
+			unsigned int read = 8*CQT.GetHop();
+			vector<double> chunk(read*channels);
+			vector<complex<double> > coefficients;
+			unsigned long long frames = 0;
+			unsigned int blocks, n;
+			bool end = false;
+			Wav.DataRewind();
+			while (!end){
+				if ((blocks = Wav.DataNextBlocks(&chunk[0], read)) != 0){
+					for (unsigned int i = 0; i < blocks*channels; i++){
+						chunk[i] *= scale;
+					}
+					n = CQT.Push(&chunk[0], blocks, coefficients);
+				}
+				else{
+					n = CQT.Flush(coefficients);
+					end = true;
+				}
+				//One row per frame and channel
+				for (unsigned int r = 0; r < n*channels; r++){
+					out << CQT.GetFrameTime(frames + r/channels) << ',' << r % channels;
+					for (unsigned int k = 0; k < bins; k++){
+						out << ',' << abs(coefficients[r*bins + k]);
+					}
+					out << '\n';
+				}
+				frames += n;
+			}
+			cout << "Done. " << frames << " frames written.\n";
+		}
+		catch(Exception &e){
+			cout << "An error has occurred: " << e.GetErrorMessage() << "\n";
+		}
+	}
+	namespace{
+		//Writes the magnitudes of the frames of a DFTScheduler, one row per frame and channel
+		class MagnitudeSink: public DFT::DFTFrameSink{
+			ofstream &Out;
+			unsigned int Channels, Bins, Frame, Hop;
+			double Interval, Scale;
+			MagnitudeSink &operator=(const MagnitudeSink &);
+		public:
+			MagnitudeSink(ofstream &out, const Wave::WaveFile &wave, const DFT::DFTScheduler &scheduler)
+				: Out(out), Channels(wave.NumChannels()), Bins(scheduler.GetBins()), Frame(scheduler.GetFrameSize()),
+				Hop(scheduler.GetHop()), Interval(wave.Interval()), Scale(ldexp(1.0, 1 - int(wave.SampleSize()))){}
+			void Consume(unsigned long long first, unsigned int frames, const complex<double> *spectra){
+				for (unsigned int r = 0; r < frames*Channels; r++){
+					Out << ((first + r/Channels)*double(Hop) + Frame/2)*Interval << ',' << r % Channels;
+					for (unsigned int k = 0; k < Bins; k++){
+						Out << ',' << Scale*abs(spectra[r*Bins + k]);
+					}
+					Out << '\n';
+				}
+			}
+		};
+	}
+
+	void WaveSTFT(std::string arg, WaveData_T &WaveData){
+		stringstream cmd(arg);
+		string file;
+		cmd >> file;
+		if (file.empty()){
+			return LaunchModule(&WaveHelp, "stft", WaveData, "help");
+		}
+		unsigned int frame = 1024, hop = 0, threads = 0;
+		cmd >> frame >> hop >> threads;
+		if (!hop){
+			hop = frame/2;
+		}
+		try{
+			cout << "Computing STFT... ";
+			Wave::WaveFile &Wav = *WaveData.Wav;
+			DFT::DFTScheduler Scheduler(frame, hop, DFT::WindowHann, threads);
+			ofstream out(file.c_str(), ios_base::out | ios_base::trunc);
+			if (!out){
+				throw Exception(EXCEPTION_FILE_CANNOT_OPEN_OUTPUT, "Unable to open file for writing.");
+			}
+			MagnitudeSink sink(out, Wav, Scheduler);
+			unsigned int frames = Scheduler.Run(Wav, sink);
+			cout << "Done. " << frames << " frames written using " << Scheduler.NumThreads() << " threads.\n";
+		}
+		catch(Exception &e){
+			cout << "An error has occurred: " << e.GetErrorMessage() << "\n";
+		}
+	}
 }
\ No newline at end of file
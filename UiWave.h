@@ -52,6 +52,17 @@ namespace Ui{
 	void WaveDump(std::string arg, WaveData_T &WaveData);				//Dump wave file time domain
 	void WaveLoad(std::string arg, WaveData_T &WaveData);				//Load data into memory
 	void WaveUnload(std::string arg, WaveData_T &WaveData);				//Unload
+	void WaveWelch(std::string arg, WaveData_T &WaveData);				//Welch power spectral density estimate into the frequency domain data
+	void WaveResample(std::string arg, WaveData_T &WaveData);			//Sample rate conversion into a new file
+	void WaveFeatures(std::string arg, WaveData_T &WaveData);			//Spectral features into a CSV file
+	void WavePitch(std::string arg, WaveData_T &WaveData);				//Pitch track into a CSV file
+	void WaveOnsets(std::string arg, WaveData_T &WaveData);				//Onset times into a file
+	void WaveOverview(std::string arg, WaveData_T &WaveData);			//Min/max/rms waveform summary into a CSV file
+	void WaveSpectrogram(std::string arg, WaveData_T &WaveData);		//Range of the cached spectrogram into a CSV file
+	void WaveEnvelope(std::string arg, WaveData_T &WaveData);			//Amplitude envelope into a new Wave file
+	void WaveMFCC(std::string arg, WaveData_T &WaveData);				//Mel frequency cepstral coefficients into a CSV file
+	void WaveCQT(std::string arg, WaveData_T &WaveData);				//Constant-Q transform magnitudes into a CSV file
+	void WaveSTFT(std::string arg, WaveData_T &WaveData);				//STFT magnitudes into a CSV file, on several threads
 
 	//Overload Launch Module
 	void LaunchModule(void (*method)(std::string arg, WaveData_T &WaveData), std::string arg, WaveData_T &WaveData, std::string ID);
@@ -1,8 +1,18 @@
 #include "WaveFile.h"
 #include "Exception.h"
+#include "DFTPool.h"
 #include <new>
+#include <algorithm>
+#include <cstring>
 
 namespace Wave{
+	namespace{
+		const unsigned int MAX_EDITS = 1024U;		//Edits journaled before they are forgotten
+		const unsigned int BULK_SAMPLES = 1024U;	//Samples encoded at a time by the bulk setters
+		const unsigned int READ_BYTES = 65536U;		//Bytes read at a time by the const methods when the data is not loaded
+		const unsigned int STACK_BYTES = 1024U;		//Reads up to this size, e.g. of a single sample, go onto the stack
+	}
+
 	/**
 		Protected Methods
 	**/
@@ -36,6 +46,11 @@ namespace Wave{
 		}
 		return data;
 	}
+	//Forget()
+	void WaveFile::Forget(){
+		Edits.clear();
+		Forgotten = ++Revision;
+	}
 
 	/**
 		Public Methods
@@ -46,8 +61,9 @@ namespace Wave{
 			File->close();
 		}
 		delete File;
+		Reader.Close();
 		SubChunks.clear();
-		DataSubChunk.Data.clear();
+		DataSubChunk.Data.Clear();
 	}
 
 	//Open()
@@ -59,6 +75,8 @@ namespace Wave{
 		if (File->fail()){
 			throw Exception(EXCEPTION_FILE_CANNOT_OPEN, "Unable to open Wav File.");
 		}
+		Path = file;
+		Reader.Open(file);
 	}
 
 	//Parse()
@@ -69,6 +87,10 @@ namespace Wave{
 		File->clear();		//Clear the fail bits
 		File->seekg(0,ios_base::beg);
 
+		//Whatever was computed from the previous data is void
+		Forget();
+		Modified = false;
+
 		//Begin Parsing
 		SubChunks.clear();
 		unsigned int count = 0;			//Number of subchunks
@@ -251,7 +273,7 @@ namespace Wave{
 	*****************************/
 	//DataIsLoaded()
 	bool WaveFile::DataIsLoaded(){
-		DataSubChunk.IsLoaded = !DataSubChunk.Data.empty();
+		DataSubChunk.IsLoaded = !DataSubChunk.Data.IsEmpty();
 		return DataSubChunk.IsLoaded;
 	}
 	//DataUnload()
@@ -259,10 +281,14 @@ namespace Wave{
 		if (!File->is_open()){
 			throw Exception(EXCEPTION_FILE_NOT_OPEN, "File is not open. Cannot afford to unload data.");
 		}
-		DataSubChunk.Data.resize(1);		//Resize to return memory
-		DataSubChunk.Data.clear();			//Clear data
+		//Edits only live in memory
+		if (Modified){
+			Forget();
+			Modified = false;
+		}
+		DataSubChunk.Data.Clear();			//Let go of the data. Copies sharing it keep it.
 		DataIsLoaded();						//Set flags
-		DataSubChunk.Iterator = DataSubChunk.Data.begin();
+		DataSubChunk.Position = 0;
 	}
 	//DataLoad()
 	void WaveFile::DataLoad(){
@@ -271,18 +297,18 @@ namespace Wave{
 		}
 		//Clear any prior data
 		DataUnload();
-		//Reserve space
-		DataSubChunk.Data.reserve(DataSubChunk.Size);
-		DataSubChunk.Data.clear();			//After reserving, the vector will be of size 1 and have a zeroth element. We don't want this
 		File->clear();
 		File->seekg(DataSubChunk.Begin);
-		for (unsigned i = 0; i < DataSubChunk.Size && !File->eof(); i++){
-			char Byte = GetNextByte();
-			DataSubChunk.Data.push_back(Byte);
+		//In one read rather than byte by byte. A short file leaves what there was.
+		DFT::DFTShared<char>::Vector_T &data = DataSubChunk.Data.Edit();
+		data.resize(DataSubChunk.Size);
+		if (DataSubChunk.Size){
+			File->read(&data[0], DataSubChunk.Size);
+			data.resize(size_t(File->gcount()));
 		}
 
 		//Load iterator
-		DataSubChunk.Iterator = DataSubChunk.Data.begin();
+		DataSubChunk.Position = 0;
 	}
 
 	/****************************
@@ -291,7 +317,7 @@ namespace Wave{
 	//DataRewind()
 	void WaveFile::DataRewind(){
 		if (DataIsLoaded()){
-			DataSubChunk.Iterator = DataSubChunk.Data.begin();
+			DataSubChunk.Position = 0;
 		}
 		else{
 			if (!File->is_open()){
@@ -301,10 +327,26 @@ namespace Wave{
 			File->seekg(DataSubChunk.Begin);
 		}
 	}
+	//DataSeek()
+	void WaveFile::DataSeek(unsigned int block){
+		if (block > NumBlocks()){
+			throw Exception(EXCEPTION_RANGE, "Out of range access.");
+		}
+		if (DataIsLoaded()){
+			DataSubChunk.Position = size_t(block)*DataSubChunk.BlockSize;
+		}
+		else{
+			if (!File->is_open()){
+				throw Exception(EXCEPTION_FILE_NOT_OPEN, "File is not open for processing.");
+			}
+			File->clear();
+			File->seekg(DataSubChunk.Begin + streamoff(block)*DataSubChunk.BlockSize);
+		}
+	}
 	//DataEnd()
 	bool WaveFile::DataEnd(){
 		if (DataIsLoaded()){
-			return !(DataSubChunk.Iterator < DataSubChunk.Data.end());
+			return !(DataSubChunk.Position < DataSubChunk.Data.Size());
 		}
 		else{
 			if (!File->is_open()){
@@ -329,9 +371,9 @@ namespace Wave{
 		//Data to process
 		vector<char> Data;
 		if (DataIsLoaded()){
-			for (unsigned i = 0; i < DataSubChunk.BlockSize && DataSubChunk.Iterator < DataSubChunk.Data.end(); i++){
-				Data.push_back(*DataSubChunk.Iterator);
-				DataSubChunk.Iterator++;
+			for (unsigned i = 0; i < DataSubChunk.BlockSize && DataSubChunk.Position < DataSubChunk.Data.Size(); i++){
+				Data.push_back(DataSubChunk.Data[DataSubChunk.Position]);
+				DataSubChunk.Position++;
 			}
 		}
 		else{
@@ -350,7 +392,13 @@ namespace Wave{
 				//Note if the sample size is > 8 bits, the data is actually signed. 
 				Bytes[j] = Data[i*DataSubChunk.SampleSize/8+j];
 			}
-			Block.SetChannel(i, GetSignedInt(Bytes,DataSubChunk.SampleSize/8));
+			//8 bit samples are unsigned, centred on 128, as DataNextBlocks() decodes them
+			if (DataSubChunk.SampleSize == 8){
+				Block.SetChannel(i, int((unsigned char) Bytes[0]) - 128);
+			}
+			else{
+				Block.SetChannel(i, GetSignedInt(Bytes,DataSubChunk.SampleSize/8));
+			}
 		}
 		return Block;
 	}
@@ -366,9 +414,9 @@ namespace Wave{
 		//Data to process
 		vector<char> Data;
 		if (DataIsLoaded()){
-			for (unsigned i = 0; i < DataSubChunk.BlockSize && DataSubChunk.Iterator < DataSubChunk.Data.end(); i++){
-				Data.push_back(*DataSubChunk.Iterator);
-				DataSubChunk.Iterator++;
+			for (unsigned i = 0; i < DataSubChunk.BlockSize && DataSubChunk.Position < DataSubChunk.Data.Size(); i++){
+				Data.push_back(DataSubChunk.Data[DataSubChunk.Position]);
+				DataSubChunk.Position++;
 			}
 		}
 		else{
@@ -392,10 +440,77 @@ namespace Wave{
 		return Block;
 	}
 
+	//DataNextBlocks() - Bulk decoding
+	unsigned int WaveFile::DataNextBlocks(double *buffer, unsigned int n){
+		if (DataEnd() || !n || !DataSubChunk.BlockSize){
+			return 0;
+		}
+		unsigned int blockSize = DataSubChunk.BlockSize;
+		unsigned int count;
+		if (DataIsLoaded()){
+			unsigned int remaining = unsigned(DataSubChunk.Data.Size() - DataSubChunk.Position)/blockSize;
+			count = n < remaining ? n : remaining;
+			DecodeSamples(DataSubChunk.Data.Get() + DataSubChunk.Position, count*DataSubChunk.NumChannels, DataSubChunk.SampleSize/8, buffer);
+			DataSubChunk.Position += count*blockSize;
+		}
+		else{
+			if (!File->is_open()){
+				throw Exception(EXCEPTION_FILE_NOT_OPEN, "File is not open for processing.");
+			}
+			//Do not read past the data chunk
+			unsigned int remaining = unsigned(DataSubChunk.End - File->tellg())/blockSize;
+			count = n < remaining ? n : remaining;
+			if (!count){
+				return 0;
+			}
+			vector<char, DFT::DFTPoolAllocator<char> > Data(count*blockSize);
+			File->read(&Data[0], count*blockSize);
+			unsigned int read = unsigned(File->gcount());
+			if (read != count*blockSize){
+				throw Exception(EXCEPTION_PARSE_MISSING_DATA, "Missing bytes in the block being read.", WAVE_DATA_MISSING);
+			}
+			DecodeSamples(&Data[0], count*DataSubChunk.NumChannels, DataSubChunk.SampleSize/8, buffer);
+		}
+		return count;
+	}
+
+	//DataNextRaw() - Undecoded blocks
+	unsigned int WaveFile::DataNextRaw(char *buffer, unsigned int n){
+		if (DataEnd() || !n || !DataSubChunk.BlockSize){
+			return 0;
+		}
+		unsigned int blockSize = DataSubChunk.BlockSize;
+		unsigned int count;
+		if (DataIsLoaded()){
+			unsigned int remaining = unsigned(DataSubChunk.Data.Size() - DataSubChunk.Position)/blockSize;
+			count = n < remaining ? n : remaining;
+			const char *data = DataSubChunk.Data.Get() + DataSubChunk.Position;
+			copy(data, data + count*blockSize, buffer);
+			DataSubChunk.Position += count*blockSize;
+		}
+		else{
+			if (!File->is_open()){
+				throw Exception(EXCEPTION_FILE_NOT_OPEN, "File is not open for processing.");
+			}
+			//Do not read past the data chunk
+			unsigned int remaining = unsigned(DataSubChunk.End - File->tellg())/blockSize;
+			count = n < remaining ? n : remaining;
+			if (!count){
+				return 0;
+			}
+			File->read(buffer, count*blockSize);
+			if (unsigned(File->gcount()) != count*blockSize){
+				throw Exception(EXCEPTION_PARSE_MISSING_DATA, "Missing bytes in the block being read.", WAVE_DATA_MISSING);
+			}
+		}
+		return count;
+	}
+
 	//DataEdit() - Signed version
 	void WaveFile::DataEdit(unsigned int interval, unsigned int dimension, int data){
-		//A simple cast will do...
-		return DataEdit(interval, dimension, (unsigned) data);
+		//Signed values are those operator() reads, so encode as DFTSet() does
+		double value = data;
+		DataEncode(dimension, interval, 1, &value);
 	}
 	//Unsigned version
 	void WaveFile::DataEdit(unsigned int interval, unsigned int dimension, unsigned int data){
@@ -411,35 +526,76 @@ namespace Wave{
 		//unsigned j = dimension * DataSubChunk.SampleSize/8;	//Index of the byte of the dimension to read in the block
 		unsigned offset = (interval*DataSubChunk.BlockSize) + (dimension * DataSubChunk.SampleSize/8);		//See i+j
 		unsigned k = 0;	//Index
+		DFT::DFTShared<char>::Vector_T &bytes = DataSubChunk.Data.Edit();	//Copied here if shared
 		for (; k < TheWord.GetSize(); k++){
-			DataSubChunk.Data[offset+k] = TheWord[k];
+			bytes[offset+k] = TheWord[k];
 		}
 		for (; k < DataSubChunk.SampleSize/8; k++){
-			DataSubChunk.Data[offset+k] = 0x0;
+			bytes[offset+k] = 0x0;
+		}
+		MarkEdited(interval, interval + 1);
+	}
+
+	/*********************
+		Edit tracking
+	*********************/
+	//MarkEdited()
+	void WaveFile::MarkEdited(unsigned int begin, unsigned int end){
+		if (begin >= end){
+			return;
+		}
+		Modified = true;
+		Revision++;
+		//Edits sample after sample, e.g. through DFTSet(), make a single range
+		if (!Edits.empty() && begin <= Edits.back().End && end >= Edits.back().Begin){
+			Edit_T &last = Edits.back();
+			last.Begin = min(last.Begin, begin);
+			last.End = max(last.End, end);
+			last.Revision = Revision;
+			return;
+		}
+		if (Edits.size() >= MAX_EDITS){
+			Forget();
+			return;
+		}
+		Edit_T edit = {begin, end, Revision};
+		Edits.push_back(edit);
+	}
+
+	//GetEdits()
+	bool WaveFile::GetEdits(unsigned long long since, vector<pair<unsigned int, unsigned int> > &ranges) const{
+		ranges.clear();
+		if (since < Forgotten){
+			return false;
+		}
+		//Revisions increase along the journal
+		for (vector<Edit_T>::const_reverse_iterator it = Edits.rbegin(); it != Edits.rend() && it->Revision > since; it++){
+			ranges.push_back(make_pair(it->Begin, it->End));
+		}
+		sort(ranges.begin(), ranges.end());
+		//Merge
+		unsigned int n = 0;
+		for (unsigned int i = 0; i < ranges.size(); i++){
+			if (n && ranges[i].first <= ranges[n-1].second){
+				ranges[n-1].second = max(ranges[n-1].second, ranges[i].second);
+			}
+			else{
+				ranges[n++] = ranges[i];
+			}
 		}
-		//And we are done
+		ranges.resize(n);
+		return true;
 	}
 	//Operator()
 	int WaveFile::operator()(unsigned int interval, unsigned int dimension){
-		//Since we are getting a DFT data request, we MUST load the data into memory
+		//Single samples are read from all over the data, so we load it into memory
 		if (!DataIsLoaded()){
 			DataLoad();
 		}
-		//unsigned i = interval*DataSubChunk.BlockSize;			//The index of first byte of the block
-		//unsigned j = dimension * DataSubChunk.SampleSize/8;	//Index of the byte of the dimension to read in the block
-		unsigned offset = (interval*DataSubChunk.BlockSize) + (dimension * DataSubChunk.SampleSize/8);		//See i+j
-
-		if ( (offset +  DataSubChunk.SampleSize/8-1) > DataSubChunk.Data.size()){
-			throw Exception(EXCEPTION_RANGE,"Out of range access.");
-		}
-
-		//Construct the data
-		char Bytes[MAX_SAMPLE_SIZE/8];					//Maximum Sample Size
-		for (unsigned k = 0; k < (unsigned) DataSubChunk.SampleSize/8; k++){
-			Bytes[k] = DataSubChunk.Data[offset+k];
-		}
-		//Convert
-		return GetSignedInt(Bytes,DataSubChunk.SampleSize/8);
+		//Decoded as DFTGet() does, so that 8 bit samples are less 128 here too
+		double value;
+		DataDecode(dimension, interval, 1, &value);
+		return int(value);
 	}
 
 	//DataGet()
@@ -449,14 +605,8 @@ namespace Wave{
 	}
 
 	//Operator[]
-	char &WaveFile::operator[](unsigned int n){
-		if (n > DataSubChunk.Data.size()){
-			throw Exception(EXCEPTION_RANGE,"Out of range access.");
-		}
-		return DataSubChunk.Data[n];
-	}
 	char WaveFile::operator[](unsigned int n) const{
-		if (n > DataSubChunk.Data.size()){
+		if (n >= DataSubChunk.Data.Size()){
 			throw Exception(EXCEPTION_RANGE,"Out of range access.");
 		}
 		return DataSubChunk.Data[n];
@@ -465,6 +615,18 @@ namespace Wave{
 	char WaveFile::DataGetByte(unsigned int n) const{
 		return operator[](n);
 	}
+	//DataEditByte()
+	void WaveFile::DataEditByte(unsigned int n, char data){
+		if (!DataIsLoaded()){
+			DataLoad();
+		}
+		if (n >= DataSubChunk.Data.Size()){
+			throw Exception(EXCEPTION_RANGE,"Out of range access.");
+		}
+		DataSubChunk.Data.Edit()[n] = data;		//Copied here if shared
+		unsigned int block = n/DataSubChunk.BlockSize;
+		MarkEdited(block, block + 1);
+	}
 	//EditDataChunk() - use with care
 	//void WaveFile::EditDataChunk(const WaveChunk<vector<char> > &data){
 	//	if (data.GetID() != Word("data")){
@@ -478,12 +640,137 @@ namespace Wave{
 		Methods inherited from DFT::DFTData
 	**********************/
 	complex<double> WaveFile::DFTGet(unsigned int interval, unsigned int dimension) const{
-		WaveFile *Self = const_cast<WaveFile*>(this);
-		return complex<double>(Self->operator()(interval,dimension));
+		double value;
+		DataDecode(dimension, interval, 1, &value);
+		return complex<double>(value);
 	}
 
 	void WaveFile::DFTSet(unsigned int intervalN, unsigned int dimension, const std::complex<double> &data){
-		return DataEdit(intervalN, dimension, (int) data.real());
+		//As the bulk setters, so that a value set reads back the same whichever way it went
+		double value = data.real();
+		DataEncode(dimension, intervalN, 1, &value);
+	}
+
+	//DataDecode()
+	void WaveFile::DataDecode(unsigned int dimension, unsigned int first, unsigned int count, double *out) const{
+		if (dimension >= NumChannels() || first > NumBlocks() || count > NumBlocks() - first){
+			throw Exception(EXCEPTION_RANGE, "Out of range access.");
+		}
+		if (!count){
+			return;
+		}
+		unsigned int sampleBytes = DataSubChunk.SampleSize/8, blockSize = DataSubChunk.BlockSize;
+		if (!DataSubChunk.Data.IsEmpty()){
+			size_t offset = size_t(first)*blockSize + dimension*sampleBytes;
+			if (offset + size_t(count - 1)*blockSize + sampleBytes > DataSubChunk.Data.Size()){
+				throw Exception(EXCEPTION_PARSE_MISSING_DATA, "Missing bytes in the block being read.", WAVE_DATA_MISSING);
+			}
+			const char *data = DataSubChunk.Data.Get() + offset;
+			if (NumChannels() == 1){
+				DecodeSamples(data, count, sampleBytes, out);
+			}
+			else{
+				DecodeSamples(data, count, sampleBytes, blockSize, out);
+			}
+			return;
+		}
+		//Not loaded: read the blocks from the file, a run at a time, without loading or seeking anything
+		if (!Reader.IsOpen()){
+			throw Exception(EXCEPTION_FILE_NOT_OPEN, "File is not open for processing.");
+		}
+		unsigned int run = max(1U, unsigned(READ_BYTES/blockSize));
+		char small[STACK_BYTES];
+		char *bytes = small;
+		DFT::DFTShared<char>::Vector_T buffer;
+		if (size_t(min(run, count))*blockSize > STACK_BYTES){
+			buffer.resize(size_t(min(run, count))*blockSize);
+			bytes = &buffer[0];
+		}
+		unsigned long long begin = (unsigned long long)(streamoff) DataSubChunk.Begin;
+		for (unsigned int done = 0; done < count; ){
+			unsigned int n = min(count - done, run);
+			size_t wanted = size_t(n - 1)*blockSize + (dimension + 1)*sampleBytes;		//Up to the last sample read
+			if (Reader.Read(begin + (unsigned long long)(first + done)*blockSize, wanted, bytes) != wanted){
+				throw Exception(EXCEPTION_PARSE_MISSING_DATA, "Missing bytes in the block being read.", WAVE_DATA_MISSING);
+			}
+			const char *data = &bytes[dimension*sampleBytes];
+			if (NumChannels() == 1){
+				DecodeSamples(data, n, sampleBytes, out + done);
+			}
+			else{
+				DecodeSamples(data, n, sampleBytes, blockSize, out + done);
+			}
+			done += n;
+		}
+	}
+
+	//DataEncode()
+	void WaveFile::DataEncode(unsigned int dimension, unsigned int first, unsigned int count, const double *in){
+		if (dimension >= NumChannels() || first > NumBlocks() || count > NumBlocks() - first){
+			throw Exception(EXCEPTION_RANGE, "Out of range access.");
+		}
+		if (!count){
+			return;
+		}
+		if (!DataIsLoaded()){
+			DataLoad();
+		}
+		unsigned int sampleBytes = DataSubChunk.SampleSize/8, blockSize = DataSubChunk.BlockSize;
+		//A short data chunk loads fewer blocks than its header says
+		size_t offset = size_t(first)*blockSize + dimension*sampleBytes;
+		if (offset + size_t(count - 1)*blockSize + sampleBytes > DataSubChunk.Data.Size()){
+			throw Exception(EXCEPTION_PARSE_MISSING_DATA, "Missing bytes in the block being written.", WAVE_DATA_MISSING);
+		}
+		char *data = &DataSubChunk.Data.Edit()[offset];
+		if (NumChannels() == 1){
+			EncodeSamples(in, count, sampleBytes, data);
+		}
+		else{
+			//Encode a run, then spread it over the blocks
+			char packed[BULK_SAMPLES*4];
+			for (unsigned int done = 0; done < count; ){
+				unsigned int n = min(count - done, BULK_SAMPLES);
+				EncodeSamples(in + done, n, sampleBytes, packed);
+				for (unsigned int i = 0; i < n; i++, data += blockSize){
+					memcpy(data, packed + i*sampleBytes, sampleBytes);
+				}
+				done += n;
+			}
+		}
+		MarkEdited(first, first + count);
+	}
+
+	//DFTGetRange()
+	void WaveFile::DFTGetRange(unsigned int dimension, unsigned int first, unsigned int count, std::complex<double> *out) const{
+		//Decode into the real parts, then spread them from the back so as not to overwrite what is still to be read
+		double *real = reinterpret_cast<double*>(out);
+		DataDecode(dimension, first, count, real);
+		for (unsigned int i = count; i-- > 0; ){
+			out[i] = complex<double>(real[i], 0);
+		}
+	}
+	//DFTGetSplit()
+	void WaveFile::DFTGetSplit(unsigned int dimension, unsigned int first, unsigned int count, double *real, double *imag) const{
+		DataDecode(dimension, first, count, real);
+		if (imag){
+			fill(imag, imag + count, 0.0);
+		}
+	}
+	//DFTSetRange()
+	void WaveFile::DFTSetRange(unsigned int dimension, unsigned int first, unsigned int count, const std::complex<double> *in){
+		double real[BULK_SAMPLES];
+		for (unsigned int done = 0; done < count; ){
+			unsigned int n = min(count - done, BULK_SAMPLES);
+			for (unsigned int i = 0; i < n; i++){
+				real[i] = in[done + i].real();
+			}
+			DataEncode(dimension, first + done, n, real);
+			done += n;
+		}
+	}
+	//DFTSetSplit()
+	void WaveFile::DFTSetSplit(unsigned int dimension, unsigned int first, unsigned int count, const double *real, const double *imag){
+		DataEncode(dimension, first, count, real);
 	}
 
 
@@ -496,7 +783,8 @@ namespace Wave{
 		if (!File->is_open()){
 			throw Exception(EXCEPTION_FILE_NOT_OPEN, "File is not open!");
 		}
-		return WriteFile(*File);
+		WriteFile(*File);
+		Modified = false;
 	}
 	void WaveFile::WriteFile(const char* filename){
 		//Invoke the other oveloaded version
@@ -524,7 +812,7 @@ namespace Wave{
 		file.write("RIFF", 4);		//RIFF Header
 		
 		//Get chunk size
-		unsigned _ChunkSize = DataSubChunk.Data.size() + 36;
+		unsigned _ChunkSize = unsigned(DataSubChunk.Data.Size()) + 36;
 
 		Word ChunkSize = GetBytesFromUnsigned(_ChunkSize);
 		ChunkSize.PadBytes();
@@ -569,19 +857,14 @@ namespace Wave{
 		Word bits = GetBytesFromUnsigned(DataSubChunk.SampleSize);
 		file.write(bits.GetPointer(), 2);
 
-		//Data Sub chunk
-		WaveChunk<vector<char> > _data = CreateDataChunk(DataSubChunk.Data);
+		//Data Sub chunk, written straight from the samples without copying them
 		file.write("data", WORD_SIZE);
-		vector<char> data = _data.GetData();
-		_ChunkSize = data.size();
+		_ChunkSize = unsigned(DataSubChunk.Data.Size());
 		ChunkSize = GetBytesFromUnsigned(_ChunkSize);
 		ChunkSize.PadBytes();
 		file.write(ChunkSize.GetPointer(), WORD_SIZE);
-
-		vector<char>::iterator it2;
-		
-		for (it2 = data.begin(); it2 < data.end(); it2++){
-			file.put(*it2);
+		if (_ChunkSize){
+			file.write(DataSubChunk.Data.Get(), _ChunkSize);
 		}
 		//Done
 	}
@@ -591,6 +874,11 @@ namespace Wave{
 	*****************/
 	//CreatObject - Object Factory
 	WaveFile WaveFile::CreateObject(unsigned _channels, unsigned _sampleRate, unsigned _sampleSize, const vector<char> &data){
+		DFT::DFTShared<char> shared;
+		shared.Edit().assign(data.begin(), data.end());
+		return CreateObject(_channels, _sampleRate, _sampleSize, shared);
+	}
+	WaveFile WaveFile::CreateObject(unsigned _channels, unsigned _sampleRate, unsigned _sampleSize, const DFT::DFTShared<char> &data){
 		WaveFile file;
 		//Set Data
 		file.DataSubChunk.BlockSize = _channels*_sampleSize/8;
@@ -600,9 +888,9 @@ namespace Wave{
 		file.DataSubChunk.NumChannels = _channels;
 		file.DataSubChunk.SampleRate = _sampleRate;
 		file.DataSubChunk.SampleSize = _sampleSize;
-		file.DataSubChunk.Size = data.size();
+		file.DataSubChunk.Size = unsigned(data.Size());
 
-		//Populate data
+		//Populate data. Shared, not copied.
 		file.DataSubChunk.Data = data;
 
 		return file;
@@ -29,6 +29,8 @@ using namespace std;
 #include "WaveWord.h"
 #include "WaveChunk.h"
 #include "DFTData.h"
+#include "DFTShared.h"
+#include "WaveReader.h"
 
 namespace Wave{
 	/******************
@@ -39,6 +41,11 @@ namespace Wave{
 
 		Most methods will check if there is any data in the vector and then call for a load data if there is none.
 		Obviously, if there is no file, an exception will be thrown. Be aware.
+
+		The const methods, the DFTGet() family, never load the data: they read from memory if it is loaded and
+		otherwise straight from the file at the offset of the samples, through a WaveReader. Any number of threads may
+		then read the same object at once, e.g. a channel or a range each, so long as none edits it or moves its stream.
+		Load the data first, with DataLoad(), when reading single samples from all over the file.
 	*******************/
 
 	class WaveFile: public DFT::DFTTime{
@@ -46,6 +53,19 @@ namespace Wave{
 		map<Word, WaveChunk<> > SubChunks;		//Map to all the SubChunks except for the "data" SubChunk
 		unsigned int ChunkSize;			//ChunkSize in bytes. Basically equal to File Size minus eight bytes.
 		fstream *File;			//File Object for the Wave File. For input and output purposes.	
+		string Path;			//Path of the file opened, empty if none
+		WaveReader Reader;		//Reads the samples of the file for the const methods, without moving File
+
+		//Edits to the samples, so that analyses caching results recompute only what an edit covers
+		struct Edit_T{
+			unsigned int Begin;				//First block edited
+			unsigned int End;				//Block after the last one edited
+			unsigned long long Revision;	//Revision of the latest edit within the range
+		};
+		vector<Edit_T> Edits;				//Edits since Forgotten, oldest first. Overlapping edits in a row are merged.
+		unsigned long long Revision;		//Bumped by every change to the samples
+		unsigned long long Forgotten;		//Edits up to this revision are no longer known
+		bool Modified;						//Whether the samples differ from those in the file
 		
 	protected:
 		/*************************
@@ -60,7 +80,7 @@ namespace Wave{
 			bool IsLastChunk;			//Whether the data chunk is the last chunk of the whole file
 			bool IsExtended;			//Set if Wave file is WAVE_FORMAT_EXTENSIBLE	
 			bool IsLoaded;				//See if data is loaded or not
-			vector<char>::iterator Iterator;			//Internal iterator for use during the case of reading from memory
+			size_t Position;			//Internal offset into Data for use during the case of reading from memory
 
 			//Can be retrieved by public
 			unsigned short FormatCode;	//Format Code
@@ -70,11 +90,11 @@ namespace Wave{
 			unsigned int ByteRate;		//Bytes per second = SampleRate * NumChannels * BitsPerSample/8
 			unsigned short BlockSize;	//Bytes per block = NumChannels * BitsPerSample/8
 			unsigned short SampleSize;	//Bits per sample
-			vector<char> Data;		//The data proper to be loaded into memory. Loaded by byte
+			DFT::DFTShared<char> Data;		//The data proper to be loaded into memory. Shared with copies of the object until edited
 
 			//"Construct data. Sets everything to zero
 			DataSubChunk_T():
-				Begin(0), End(0), IsLastChunk(false), IsExtended(false), IsLoaded(false),
+				Begin(0), End(0), IsLastChunk(false), IsExtended(false), IsLoaded(false), Position(0),
 				FormatCode(0), Size(0), NumChannels(0), SampleRate(0), ByteRate(0),
 				BlockSize(0), SampleSize(0)
 				{}
@@ -91,23 +111,35 @@ namespace Wave{
 		//Check list length for confirmation or use File.eof() directly.
 		vector<char> GetBytes(unsigned int n);	
 
+		void Forget();					//Drop the journal of edits: whatever came before is to be redone
+
+		//Decode or encode count samples of a channel from block first, straight from and to the loaded data
+		void DataDecode(unsigned int dimension, unsigned int first, unsigned int count, double *out) const;
+		void DataEncode(unsigned int dimension, unsigned int first, unsigned int count, const double *in);
+
 	public:	
 		/*************************
 		**	    Constructor		**
 		**************************/
-		WaveFile():File(new fstream){
+		WaveFile():File(new fstream), Revision(0), Forgotten(0), Modified(false){
 			//Does nothing. Creates an empty file.
 		}
-		WaveFile(char *file):File(new fstream){
+		WaveFile(char *file):File(new fstream), Revision(0), Forgotten(0), Modified(false){
 			Open(file);	
 		};
 
 		//Copy Constructor
 		WaveFile(const WaveFile &obj){
-			//Copy data
+			//Copy data. The file is not open in the copy, but its samples can still be read through the shared reader.
 			DataSubChunk = obj.DataSubChunk;
 			SubChunks = obj.SubChunks;		
 			ChunkSize = obj.ChunkSize;	
+			Path = obj.Path;
+			Edits = obj.Edits;
+			Revision = obj.Revision;
+			Forgotten = obj.Forgotten;
+			Modified = obj.Modified;
+			Reader = obj.Reader;
 			File = new fstream;
 		}
 		//Assignment Operator
@@ -116,6 +148,12 @@ namespace Wave{
 			DataSubChunk = op.DataSubChunk;
 			SubChunks = op.SubChunks;		
 			ChunkSize = op.ChunkSize;	
+			Path = op.Path;
+			Edits = op.Edits;
+			Revision = op.Revision;
+			Forgotten = op.Forgotten;
+			Modified = op.Modified;
+			Reader = op.Reader;
 			File = new fstream;
 			return *this;
 		}
@@ -129,7 +167,8 @@ namespace Wave{
 		//Open the file for reading and writing
 		void Open(const char *file);
 		bool IsOpen(){ return File->is_open(); }				//Check if a file is open
-		void Close(){ File->close(); }						//Close file
+		void Close(){ File->close(); Reader.Close(); }		//Close file
+		const string &GetPath() const{ return Path; }		//Path of the file opened, empty if the object was not opened from a file
 
 		//Parses the file and populate the SubChunks. If data already exist, they will be destroyed.
 		//Return the number of subchunks discovered.
@@ -138,6 +177,7 @@ namespace Wave{
 
 		//Methods that return Data Chunk properties
 		unsigned int DataChunkSize() const { return DataSubChunk.Size; }			//Get size of data chunk
+		unsigned long long DataOffset() const{ return (unsigned long long)(streamoff) DataSubChunk.Begin; }	//Offset of the first byte of data in the file
 		unsigned int NumChannels() const {	return DataSubChunk.NumChannels; }		//Get number of channels
 		unsigned int SampleRate() const{ return DataSubChunk.SampleRate; }		//Get Sample rate
 		unsigned int ByteRate() const{ return DataSubChunk.ByteRate; }			//Bytes per second
@@ -162,15 +202,25 @@ namespace Wave{
 		//Dangerous methods - no need to put them under protected since... the original data is protected
 		//vector<char> &DataGet(){ return DataSubChunk.Data; }		//Get a reference to the direct data for manipulation purposes
 		//vector<char> DataGet() const{ return DataSubChunk.Data;}	//Get a copy of the data
+		//The loaded data, to share with other objects. Copying it is O(1); editing either copy leaves the other alone.
+		const DFT::DFTShared<char> &DataShared() const{ return DataSubChunk.Data; }
 
 		/****************************
 		** "Iterator" Methods for reading Stream Data
 		** If data was already loaded into memory, we will "read" from there instead. So much faster!
 		*****************************/
 		void DataRewind();						//Set the file pointer to point to the start of the data sub chunk
-		WaveBlock<int> DataNextBlock();		//Get the next block of data as signed data
+		void DataSeek(unsigned int block);		//Set the file pointer to point to a block of the data sub chunk, for random access
+		WaveBlock<int> DataNextBlock();		//Get the next block of data as signed data. 8 bit samples are less 128.
 		WaveBlock<unsigned int> DataNextBlockUnsigned();	//Get the next block of data as unsigned data (use for Bitrate < 8)
 		bool DataEnd();							//Check if end of Data has been reached. If file pointer is not within the  data chunk range, will also return true.
+		//Read up to n blocks from the current position and decode them into buffer, which must hold n*NumChannels() values.
+		//Samples are interleaved by channel as in the file. Returns the number of whole blocks read.
+		//Use this instead of DataNextBlock() to stream through large files.
+		unsigned int DataNextBlocks(double *buffer, unsigned int n);
+		//Read up to n blocks from the current position into buffer as they are in the file, without decoding them.
+		//buffer must hold n*BlockSize() bytes. Returns the number of whole blocks read. Decode with Wave::DecodeSamples().
+		unsigned int DataNextRaw(char *buffer, unsigned int n);
 
 		/*********************
 			Get and edit Audio Data
@@ -178,6 +228,8 @@ namespace Wave{
 
 			 NOTE: Conversion between signed and unsigned do not change the bit pattern. So only one version,
 			 that is the signed version, of the methods are provided for the getters
+			 The signed methods read and write the values of DFTGet() and DFTSet(): 8 bit samples, stored unsigned,
+			 are less 128, and values out of range are clipped. The unsigned DataEdit() writes the bit pattern as is.
 		*********************/
 		int operator()(unsigned int interval, unsigned int dimension);	//Get sample at a specific interval and specific dimension
 		int DataGet(unsigned int interval, unsigned int dimension);		//Alias for above  
@@ -185,9 +237,23 @@ namespace Wave{
 		void DataEdit(unsigned int interval, unsigned int dimension, int data);			//Edit a specific sample
 		void DataEdit(unsigned int interval, unsigned int dimension, unsigned data);		//Edit a specific sample
 
-		char &operator[](unsigned int n);								//Get the nth byte from the data chunk
 		char operator[](unsigned int n) const;							//Get the nth byte from the data chunk
 		char DataGetByte(unsigned int n) const;								//Alias
+		void DataEditByte(unsigned int n, char data);						//Edit the nth byte of the data chunk
+
+		/*********************
+			Edit tracking
+			 - Every change to the samples bumps the revision. An analysis that caches its results remembers the revision
+			   it last saw and asks for the blocks edited since, to recompute only the frames overlapping them.
+			 - DataEdit(), DataEditByte() and DFTSet() record their edits. Edits made otherwise, e.g. by a derived class,
+			   must be recorded with MarkEdited().
+		*********************/
+		unsigned long long GetRevision() const{ return Revision; }
+		//Sorted, disjoint ranges of blocks [first, second) edited after revision since, into ranges.
+		//Returns false when these edits are no longer known, e.g. the data was parsed again: everything is to be redone.
+		bool GetEdits(unsigned long long since, vector<pair<unsigned int, unsigned int> > &ranges) const;
+		void MarkEdited(unsigned int begin, unsigned int end);		//Record an edit of blocks [begin, end)
+		bool IsModified() const{ return Modified; }			//Whether the samples differ from those in the file
 
 		//Replace the entire data sub chunk. Call this with the vector created by CreateDataChunk
 		//Use with care. Does not change the fmt subchunk.
@@ -210,18 +276,33 @@ namespace Wave{
 		unsigned int DFTSample() const{ return NumSamples(); }			//Returns the number of discrete samples
 		double DFTInterval() const{ return Interval(); }		//The time interval between samples
 		unsigned int DFTNumInterval() const{ return NumBlocks(); }					//Number of intervals
+		bool DFTIsReal() const{ return true; }									//Samples are real
 
 		//Alias for () operator
 		//Our sound signal is, obviously, always real. 
+		//Decodes one sample per call; for transforms reading at random, a WaveView decodes a tile at a time.
+		//Unlike operator(), never loads the data: unloaded, each call is a read of the file. Read runs through the bulk
+		//getters below, or DataLoad() first.
 		complex<double> DFTGet(unsigned int interval, unsigned int dimension) const;
 
+		//Rounds and clips as EncodeSamples(), as the bulk setters do
 		void DFTSet(unsigned int intervalN, unsigned int dimension, const std::complex<double> &data);
 
+		//Bulk access, decoding and encoding a channel in one pass. The setters round and clip as EncodeSamples() and
+		//ignore imaginary parts. Values are those of DFTGet() and DFTSet(): 8 bit samples are unsigned, centred on 128,
+		//and read and written as signed values less 128.
+		void DFTGetRange(unsigned int dimension, unsigned int first, unsigned int count, std::complex<double> *out) const;
+		void DFTGetSplit(unsigned int dimension, unsigned int first, unsigned int count, double *real, double *imag) const;
+		void DFTSetRange(unsigned int dimension, unsigned int first, unsigned int count, const std::complex<double> *in);
+		void DFTSetSplit(unsigned int dimension, unsigned int first, unsigned int count, const double *real, const double *imag);
+
 		/**********************
 			Static Methods
 		***********************/
 		//Based on the data provided, construct a WaveFile Object
 		static WaveFile CreateObject(unsigned _channels, unsigned _sampleRate, unsigned _sampleSize, const vector<char> &data);
+		//As above, sharing the data rather than copying it
+		static WaveFile CreateObject(unsigned _channels, unsigned _sampleRate, unsigned _sampleSize, const DFT::DFTShared<char> &data);
 		//Create a format chunk based on parameters - SAMPLE SIZE IS IN BITS
 		static WaveChunk<> CreateFmtChunk(unsigned channels, unsigned sampleRate, unsigned sampleSize);
 		//Create data chunk
@@ -0,0 +1,225 @@
+//WaveMapping.cpp
+#include "Exception.h"
+#include "WaveMapping.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <windows.h>
+#include <winioctl.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+namespace Wave{
+	//Constructor
+#ifdef _WIN32
+	MappedFile::MappedFile(): Handle(INVALID_HANDLE_VALUE), Mapping(NULL), View(NULL), Size(0), Writable(false), Advice(Normal){}
+#else
+	MappedFile::MappedFile(): Handle(-1), View(NULL), Size(0), Writable(false), Advice(Normal){}
+#endif
+
+	//Destructor
+	MappedFile::~MappedFile(){
+		Close();
+	}
+
+	//Map()
+	void MappedFile::Map(){
+		if ((unsigned long long) size_t(Size) != Size){
+			Close();
+			throw Exception(EXCEPTION_MEMORY_ERROR, "File is too large to be mapped in this process.");
+		}
+		if (!Size){
+			//Nothing to map
+			return;
+		}
+#ifdef _WIN32
+		Mapping = CreateFileMappingA(Handle, NULL, Writable ? PAGE_READWRITE : PAGE_READONLY, DWORD(Size >> 32), DWORD(Size), NULL);
+		if (Mapping){
+			View = static_cast<char*>(MapViewOfFile(Mapping, Writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0));
+		}
+		if (!View){
+			Close();
+			throw Exception(EXCEPTION_MEMORY_ERROR, "Unable to map the file into memory.");
+		}
+#else
+		void *view = mmap(NULL, size_t(Size), Writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, Handle, 0);
+		if (view == MAP_FAILED){
+			Close();
+			throw Exception(EXCEPTION_MEMORY_ERROR, "Unable to map the file into memory.");
+		}
+		View = static_cast<char*>(view);
+#endif
+		if (Advice != Normal){
+			Advise(Advice);
+		}
+	}
+
+	//Unmap()
+	void MappedFile::Unmap(){
+#ifdef _WIN32
+		if (View){
+			UnmapViewOfFile(View);
+		}
+		if (Mapping){
+			CloseHandle(Mapping);
+		}
+		Mapping = NULL;
+#else
+		if (View){
+			munmap(View, size_t(Size));
+		}
+#endif
+		View = NULL;
+	}
+
+	//Open()
+	bool MappedFile::Open(const char *file, bool writable){
+		Close();
+		Writable = writable;
+		Advice = Normal;
+#ifdef _WIN32
+		//A read only mapping shares the file with a stream that has it open, e.g. the WaveFile it was parsed by
+		Handle = CreateFileA(file, writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+			writable ? FILE_SHARE_READ : FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		LARGE_INTEGER size;
+		if (Handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(Handle, &size)){
+			Close();
+			return false;
+		}
+		Size = (unsigned long long) size.QuadPart;
+#else
+		Handle = open(file, writable ? O_RDWR : O_RDONLY);
+		struct stat status;
+		if (Handle < 0 || fstat(Handle, &status)){
+			Close();
+			return false;
+		}
+		Size = (unsigned long long) status.st_size;
+#endif
+		Map();
+		return true;
+	}
+
+	//Create()
+	void MappedFile::Create(const char *file, unsigned long long size){
+		Close();
+		Writable = true;
+		Advice = Normal;
+#ifdef _WIN32
+		Handle = CreateFileA(file, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (Handle == INVALID_HANDLE_VALUE){
+			Close();
+			throw Exception(EXCEPTION_FILE_CANNOT_OPEN_OUTPUT, "Unable to create file.");
+		}
+		//Sparse where the file system allows, NTFS. The mapping then extends the file to its size.
+		DWORD returned;
+		DeviceIoControl(Handle, FSCTL_SET_SPARSE, NULL, 0, NULL, 0, &returned, NULL);
+#else
+		Handle = open(file, O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if (Handle < 0){
+			Close();
+			throw Exception(EXCEPTION_FILE_CANNOT_OPEN_OUTPUT, "Unable to create file.");
+		}
+		//Sparse where the file system allows: pages not written take no space
+		if (ftruncate(Handle, off_t(size))){
+			Close();
+			throw Exception(EXCEPTION_FILE_CANNOT_OPEN_OUTPUT, "Unable to size file.");
+		}
+#endif
+		Size = size;
+		Map();
+	}
+
+	//Close()
+	void MappedFile::Close(){
+		Unmap();
+#ifdef _WIN32
+		if (Handle != INVALID_HANDLE_VALUE){
+			CloseHandle(Handle);
+		}
+		Handle = INVALID_HANDLE_VALUE;
+#else
+		if (Handle >= 0){
+			close(Handle);
+		}
+		Handle = -1;
+#endif
+		Size = 0;
+	}
+
+	//Resize()
+	void MappedFile::Resize(unsigned long long size){
+		if (!Writable){
+			throw Exception(EXCEPTION_UNSUPPORTED, "File is mapped read only.");
+		}
+		if (size == Size){
+			return;
+		}
+		Unmap();
+		//Grown sparse, as when created
+#ifdef _WIN32
+		LARGE_INTEGER end;
+		end.QuadPart = (LONGLONG) size;
+		bool sized = Handle != INVALID_HANDLE_VALUE && SetFilePointerEx(Handle, end, NULL, FILE_BEGIN) && SetEndOfFile(Handle);
+#else
+		bool sized = Handle >= 0 && !ftruncate(Handle, off_t(size));
+#endif
+		if (!sized){
+			Close();
+			throw Exception(EXCEPTION_FILE_CANNOT_OPEN_OUTPUT, "Unable to size file.");
+		}
+		Size = size;
+		Map();
+	}
+
+	//Advise()
+	void MappedFile::Advise(Access access){
+		Advice = access;
+#ifndef _WIN32
+		if (View){
+			madvise(View, size_t(Size), (access == Sequential) ? MADV_SEQUENTIAL : (access == Random) ? MADV_RANDOM : MADV_NORMAL);
+		}
+#endif
+		//Windows has no such advice for views: the system reads ahead as it sees fit
+	}
+
+	//Flush()
+	void MappedFile::Flush(unsigned long long offset, unsigned long long length){
+		if (!View || !Writable || offset >= Size){
+			return;
+		}
+		if (length > Size - offset){
+			length = Size - offset;
+		}
+#ifdef _WIN32
+		FlushViewOfFile(View + offset, size_t(length));
+#else
+		//msync() wants a page aligned address
+		unsigned long long page = (unsigned long long) sysconf(_SC_PAGESIZE);
+		unsigned long long begin = offset/page*page;
+		msync(View + begin, size_t(offset + length - begin), MS_SYNC);
+#endif
+	}
+
+	//Identify()
+	bool MappedFile::Identify(const char *file, unsigned long long &size, long long &time){
+#ifdef _WIN32
+		struct _stat64 status;
+		if (_stat64(file, &status)){
+			return false;
+		}
+#else
+		struct stat status;
+		if (stat(file, &status)){
+			return false;
+		}
+#endif
+		size = (unsigned long long) status.st_size;
+		time = (long long) status.st_mtime;
+		return true;
+	}
+}
@@ -0,0 +1,80 @@
+/*
+	MappedFile
+
+	A file mapped into memory, for caches and stores that are larger than we want to read or keep in memory at once.
+	Pages are read in by the operating system when they are first touched, and changes to a writable mapping are
+	written back to the file by the operating system as well, so that the file can be reopened in a later session.
+
+	Uses CreateFileMapping()/MapViewOfFile() on Windows and mmap() elsewhere.
+	The whole file is mapped in one view, so its size is limited by the address space of the process.
+	Files are created sparse where the file system allows, so that pages never written take no disk space.
+	Advise() tells the system how the mapping will be read, for it to read ahead or not: madvise(), where there is one.
+
+	In the case of errors, throws exceptions
+*/
+#pragma once
+#ifndef WaveMapping_H
+#define WaveMapping_H
+
+#include <string>
+using namespace std;
+#include "WaveMisc.h"
+
+namespace Wave{
+	class MappedFile{
+	public:
+		enum Access { Normal, Sequential, Random };
+
+	private:
+#ifdef _WIN32
+		void *Handle;						//File handle
+		void *Mapping;						//File mapping object
+#else
+		int Handle;							//File descriptor
+#endif
+		char *View;							//Start of the mapping
+		unsigned long long Size;			//Size of the file in bytes
+		bool Writable;						//Mapped for writing
+		Access Advice;						//As last advised, kept across Resize()
+
+		//Not copyable
+		MappedFile(const MappedFile &);
+		MappedFile &operator=(const MappedFile &);
+
+	protected:
+		void Map();							//Map the whole of the open file
+		void Unmap();						//Unmap, keeping the file open
+
+	public:
+		MappedFile();
+		//Destructor. Unmaps and closes the file.
+		~MappedFile();
+
+		//Map an existing file. Returns false if the file does not exist or cannot be opened.
+		bool Open(const char *file, bool writable=false);
+		//Create the file, or truncate it if it exists, with size zero bytes and map it for writing
+		void Create(const char *file, unsigned long long size);
+		//Unmap and close
+		void Close();
+		//Grow or shrink the file of a writable mapping to size bytes and map it again. Data() moves.
+		//Bytes past the old end read as zeros.
+		void Resize(unsigned long long size);
+		//How the mapping will be read from now on
+		void Advise(Access access);
+
+		//Ask for the changes in [offset, offset+length) to be written to the file now. Returns once they are.
+		void Flush(unsigned long long offset, unsigned long long length);
+		void Flush(){ Flush(0, Size); }
+
+		//Getters
+		bool IsOpen() const{ return View != NULL; }
+		bool IsWritable() const{ return Writable; }
+		unsigned long long GetSize() const{ return Size; }
+		char *Data(){ return View; }
+		const char *Data() const{ return View; }
+
+		//Size and last modification time of a file, to tell whether it has changed. Returns false if it does not exist.
+		static bool Identify(const char *file, unsigned long long &size, long long &time);
+	};
+}
+#endif /* WaveMapping_H */
@@ -1,6 +1,22 @@
+#include <cmath>
 #include "WaveMisc.h"
 
+#ifdef WAVE_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace Wave{
+	namespace{
+		//Round to the nearest integer, halves to even, as SSE2 conversions do in the default rounding mode
+		inline double RoundEven(double x){
+			double r = floor(x + 0.5);
+			if (r - x == 0.5 && fmod(r, 2.0) != 0){
+				r -= 1;
+			}
+			return r;
+		}
+	}
+
 	/*
 		Utility Functions
 	*/
@@ -65,7 +81,7 @@ namespace Wave{
 		}
 		if (isNegative){
 			//result -= pow(2.0, (double) length*8-1 );
-			result -= 2U << (length*8-1);
+			result -= 1U << (length*8-1);
 		}
 		return result;
 	}
@@ -147,4 +163,112 @@ namespace Wave{
 		}
 		return GetUnsignedInt(data.c_str(),length, endian);
 	}
+
+	//Decode PCM samples in bulk. Equivalent to calling GetSignedInt on every sample but without the per call overhead
+	void DecodeSamples(const char *data, unsigned int count, unsigned int sampleBytes, double *out){
+		const unsigned char *bytes = reinterpret_cast<const unsigned char*>(data);
+		switch (sampleBytes){
+		case 1:
+			for (unsigned int i = 0; i < count; i++){
+				out[i] = int(bytes[i]) - 128;
+			}
+			break;
+		case 2:
+			for (unsigned int i = 0; i < count; i++, bytes += 2){
+				out[i] = short(bytes[0] | (bytes[1] << 8));
+			}
+			break;
+		case 3:
+			for (unsigned int i = 0; i < count; i++, bytes += 3){
+				//Shift into the top of the word and back down to sign extend
+				out[i] = int((unsigned int)(bytes[0] << 8 | bytes[1] << 16 | bytes[2] << 24)) >> 8;
+			}
+			break;
+		case 4:
+			for (unsigned int i = 0; i < count; i++, bytes += 4){
+				out[i] = int((unsigned int)(bytes[0] | bytes[1] << 8 | bytes[2] << 16) | (unsigned int)bytes[3] << 24);
+			}
+			break;
+		default:
+			for (unsigned int i = 0; i < count; i++){
+				out[i] = 0;
+			}
+			break;
+		}
+	}
+
+	//DecodeSamples() - strided
+	void DecodeSamples(const char *data, unsigned int count, unsigned int sampleBytes, unsigned int stride, double *out){
+		const unsigned char *bytes = reinterpret_cast<const unsigned char*>(data);
+		switch (sampleBytes){
+		case 1:
+			for (unsigned int i = 0; i < count; i++, bytes += stride){
+				out[i] = int(bytes[0]) - 128;
+			}
+			break;
+		case 2:
+			for (unsigned int i = 0; i < count; i++, bytes += stride){
+				out[i] = short(bytes[0] | (bytes[1] << 8));
+			}
+			break;
+		case 3:
+			for (unsigned int i = 0; i < count; i++, bytes += stride){
+				out[i] = int((unsigned int)(bytes[0] << 8 | bytes[1] << 16 | bytes[2] << 24)) >> 8;
+			}
+			break;
+		case 4:
+			for (unsigned int i = 0; i < count; i++, bytes += stride){
+				out[i] = int((unsigned int)(bytes[0] | bytes[1] << 8 | bytes[2] << 16) | (unsigned int)bytes[3] << 24);
+			}
+			break;
+		default:
+			for (unsigned int i = 0; i < count; i++){
+				out[i] = 0;
+			}
+			break;
+		}
+	}
+
+	//Encode PCM samples in bulk. Rounding, clipping and packing happen in one pass.
+	void EncodeSamples(const double *in, unsigned int count, unsigned int sampleBytes, char *out){
+		if (sampleBytes < 1 || sampleBytes > 4){
+			return;
+		}
+		unsigned char *bytes = reinterpret_cast<unsigned char*>(out);
+		//Range of the sample size. 8 bit samples are stored with an offset of 128
+		double high = double((1U << (sampleBytes*8-1)) - 1);
+		double low = -high - 1;
+		int offset = (sampleBytes == 1) ? 128 : 0;
+
+		//Convert to clipped integers two at a time, then pack
+		int value[2];
+		unsigned int i = 0;
+		while (i < count){
+			unsigned int n = (count - i) < 2 ? 1 : 2;
+#ifdef WAVE_SSE2
+			__m128d x = (n == 2) ? _mm_loadu_pd(in + i) : _mm_load_sd(in + i);
+			x = _mm_and_pd(x, _mm_cmpord_pd(x, x));		//NaN to zero
+			x = _mm_min_pd(_mm_max_pd(x, _mm_set1_pd(low)), _mm_set1_pd(high));
+			__m128i r = _mm_cvtpd_epi32(x);			//Round to nearest, halves to even
+			value[0] = _mm_cvtsi128_si32(r);
+			value[1] = _mm_cvtsi128_si32(_mm_srli_si128(r, 4));
+#else
+			for (unsigned int j = 0; j < n; j++){
+				double x = in[i+j];
+				if (x != x){
+					x = 0;			//NaN
+				}
+				x = x < low ? low : (x > high ? high : x);
+				value[j] = int(RoundEven(x));
+			}
+#endif
+			for (unsigned int j = 0; j < n; j++){
+				unsigned int v = unsigned(value[j] + offset);
+				for (unsigned int k = 0; k < sampleBytes; k++){
+					*bytes++ = (unsigned char)(v >> (k*8));
+				}
+			}
+			i += n;
+		}
+	}
 }
@@ -8,6 +8,11 @@
 #include <string>
 using namespace std;
 
+//SSE2 is always available on x64 and on x86 compiled with /arch:SSE2
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WAVE_SSE2
+#endif
+
 namespace Wave{
 	//Constants Definition
 	const unsigned int WORD_SIZE = 4U;				//Definition of the number of Bytes/Chars in a Word
@@ -59,5 +64,15 @@ namespace Wave{
 	unsigned int GetUnsignedInt(string data, Endianess endian=Little);	//String overloaded version for... "convenience sakes"
 	unsigned int GetUnsignedInt(const char *data, unsigned int length=WORD_SIZE, Endianess endian=Little);
 
+	//Decode count little endian PCM samples of sampleBytes bytes each from data into out.
+	//Samples wider than 8 bits are signed. 8 bit samples are unsigned in the WAVE format and are re-centred around zero.
+	void DecodeSamples(const char *data, unsigned int count, unsigned int sampleBytes, double *out);
+	//Same, for samples stride bytes apart, e.g. one channel of interleaved blocks
+	void DecodeSamples(const char *data, unsigned int count, unsigned int sampleBytes, unsigned int stride, double *out);
+
+	//Encode count samples from in as little endian PCM of sampleBytes bytes each into out. The reverse of DecodeSamples().
+	//Values are rounded to the nearest integer, halves to even, and clipped to the range of the sample size. NaN is zero.
+	void EncodeSamples(const double *in, unsigned int count, unsigned int sampleBytes, char *out);
+
 }
 #endif /* WaveMisc_H */
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "WaveReader.h"
+#include "Exception.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace Wave{
+	//Constructor
+	WaveReader::WaveReader(const char *file): Shared(NULL){
+		Open(file);
+	}
+
+	//Copy Constructor
+	WaveReader::WaveReader(const WaveReader &obj): Shared(obj.Shared){
+		if (Shared){
+			Shared->Count++;
+		}
+	}
+
+	//Assignment Operator
+	WaveReader &WaveReader::operator=(const WaveReader &op){
+		if (Shared != op.Shared){
+			//Take the new share before dropping the old one
+			if (op.Shared){
+				op.Shared->Count++;
+			}
+			Close();
+			Shared = op.Shared;
+		}
+		return *this;
+	}
+
+	//Destructor
+	WaveReader::~WaveReader(){
+		Close();
+	}
+
+	//Open()
+	void WaveReader::Open(const char *file){
+		Close();
+		File_T *opened = new File_T;
+		opened->Count = 1;
+#ifdef _WIN32
+		opened->Handle = CreateFileA(file, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		bool failed = (opened->Handle == INVALID_HANDLE_VALUE);
+#else
+		opened->Descriptor = open(file, O_RDONLY);
+		bool failed = (opened->Descriptor < 0);
+#endif
+		if (failed){
+			delete opened;
+			throw Exception(EXCEPTION_FILE_CANNOT_OPEN_INPUT, "Unable to open file for reading.");
+		}
+		Shared = opened;
+	}
+
+	//Close()
+	void WaveReader::Close(){
+		//The last sharer closes the file
+		if (Shared && --Shared->Count == 0){
+#ifdef _WIN32
+			CloseHandle(Shared->Handle);
+#else
+			close(Shared->Descriptor);
+#endif
+			delete Shared;
+		}
+		Shared = NULL;
+	}
+
+	//Read()
+	size_t WaveReader::Read(unsigned long long offset, size_t n, char *buffer) const{
+		if (!IsOpen()){
+			throw Exception(EXCEPTION_FILE_NOT_OPEN, "File is not open for processing.");
+		}
+		size_t done = 0;
+		while (done < n){
+#ifdef _WIN32
+			//With an offset, a synchronous handle reads there whatever other threads do with it
+			OVERLAPPED at = OVERLAPPED();
+			at.Offset = DWORD(offset + done);
+			at.OffsetHigh = DWORD((offset + done) >> 32);
+			DWORD chunk = DWORD((n - done < 0x40000000) ? n - done : 0x40000000), got = 0;
+			if (!ReadFile(Shared->Handle, buffer + done, chunk, &got, &at)){
+				if (GetLastError() == ERROR_HANDLE_EOF){
+					break;
+				}
+				throw Exception(EXCEPTION_DATA_ERROR, "Unable to read file.");
+			}
+#else
+			ssize_t got = pread(Shared->Descriptor, buffer + done, n - done, off_t(offset + done));
+			if (got < 0){
+				if (errno == EINTR){
+					continue;
+				}
+				throw Exception(EXCEPTION_DATA_ERROR, "Unable to read file.");
+			}
+#endif
+			if (!got){
+				break;
+			}
+			done += size_t(got);
+		}
+		return done;
+	}
+}
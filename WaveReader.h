@@ -0,0 +1,49 @@
+/*
+	WaveReader
+
+	Reads bytes of a file at given offsets. Unlike an fstream there is no file position to seek, so that any number
+	of threads may read one reader at once: pread() on POSIX systems, ReadFile() with an offset on Windows.
+	WaveFile reads the samples of a file not loaded into memory through one, so that its const methods read the file
+	without touching the stream that Parse() and the "Iterator" methods move.
+
+	The file is opened read only. Copies of a reader share the file opened by reference count, as DFTShared shares its
+	values: copying opens nothing and cannot fail, and the file is closed with the last reader sharing it. Counts are
+	atomic, so sharers may live in different threads.
+	In the case of errors, throws exceptions
+*/
+#pragma once
+#ifndef WaveReader_H
+#define WaveReader_H
+
+#include <cstddef>
+#include <atomic>
+
+namespace Wave{
+	class WaveReader{
+		//The file opened, shared by copies of the reader
+		struct File_T{
+			std::atomic<unsigned int> Count;		//Sharers
+#ifdef _WIN32
+			void *Handle;							//HANDLE
+#else
+			int Descriptor;
+#endif
+		};
+		File_T *Shared;								//NULL when closed
+
+	public:
+		WaveReader(): Shared(NULL){}
+		explicit WaveReader(const char *file);
+		WaveReader(const WaveReader &obj);			//Shares the file of obj
+		WaveReader &operator=(const WaveReader &op);
+		~WaveReader();
+
+		void Open(const char *file);		//Closes the file open, if any
+		void Close();
+		bool IsOpen() const{ return Shared != NULL; }
+
+		//Read up to n bytes from offset into buffer. Returns the number of bytes read, short at the end of the file.
+		size_t Read(unsigned long long offset, size_t n, char *buffer) const;
+	};
+}
+#endif /* WaveReader_H */
@@ -0,0 +1,301 @@
+#include "WaveResampler.h"
+#include "Exception.h"
+#include <cmath>
+#include <algorithm>
+#ifdef WAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace Wave{
+	namespace{
+		const unsigned int STREAM_BLOCKS = 4096U;		//Blocks read from the file at a time
+		const double KAISER_BETA = 8.0;					//About 80dB of stop band attenuation
+		const unsigned int MAX_COEFFICIENTS = 1U << 22;	//Limit on the size of the filter bank
+
+		unsigned int GreatestCommonDivisor(unsigned int a, unsigned int b){
+			while (b){
+				unsigned int r = a % b;
+				a = b;
+				b = r;
+			}
+			return a;
+		}
+
+		//Modified Bessel function of the first kind, order zero
+		double BesselI0(double x){
+			double sum = 1, term = 1, half = x/2;
+			for (unsigned int k = 1; k < 64 && term > sum*1e-17; k++){
+				term *= (half/k)*(half/k);
+				sum += term;
+			}
+			return sum;
+		}
+
+		//Dot products of the n coefficients with the samples of two channels. n is even.
+		inline void MultiplyAccumulate(const double *taps, const double *a, const double *b, unsigned int n, double &ra, double &rb){
+#ifdef WAVE_SSE2
+			__m128d accA = _mm_setzero_pd(), accB = _mm_setzero_pd();
+			for (unsigned int i = 0; i < n; i += 2){
+				__m128d t = _mm_loadu_pd(taps + i);
+				accA = _mm_add_pd(accA, _mm_mul_pd(t, _mm_loadu_pd(a + i)));
+				accB = _mm_add_pd(accB, _mm_mul_pd(t, _mm_loadu_pd(b + i)));
+			}
+			accA = _mm_add_sd(accA, _mm_unpackhi_pd(accA, accA));
+			accB = _mm_add_sd(accB, _mm_unpackhi_pd(accB, accB));
+			_mm_store_sd(&ra, accA);
+			_mm_store_sd(&rb, accB);
+#else
+			double sa0 = 0, sa1 = 0, sb0 = 0, sb1 = 0;
+			for (unsigned int i = 0; i < n; i += 2){
+				sa0 += taps[i]*a[i];
+				sa1 += taps[i+1]*a[i+1];
+				sb0 += taps[i]*b[i];
+				sb1 += taps[i+1]*b[i+1];
+			}
+			ra = sa0 + sa1;
+			rb = sb0 + sb1;
+#endif
+		}
+		//Single channel version
+		inline double MultiplyAccumulate(const double *taps, const double *a, unsigned int n){
+#ifdef WAVE_SSE2
+			__m128d acc = _mm_setzero_pd();
+			for (unsigned int i = 0; i < n; i += 2){
+				acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(taps + i), _mm_loadu_pd(a + i)));
+			}
+			acc = _mm_add_sd(acc, _mm_unpackhi_pd(acc, acc));
+			double result;
+			_mm_store_sd(&result, acc);
+			return result;
+#else
+			double s0 = 0, s1 = 0;
+			for (unsigned int i = 0; i < n; i += 2){
+				s0 += taps[i]*a[i];
+				s1 += taps[i+1]*a[i+1];
+			}
+			return s0 + s1;
+#endif
+		}
+	}
+
+	/**
+		Protected Methods
+	**/
+	//Design()
+	void WaveResampler::Design(double rolloff){
+		//Prototype of Taps*Up coefficients at the upsampled rate, centred on Taps*Up/2
+		unsigned int length = Taps*Up;
+		double centre = length/2.0;
+		double cutoff = rolloff*0.5/(Up > Down ? Up : Down);		//Cycles per upsampled sample
+		vector<double> prototype(length);
+		double sum = 0;
+		const double pi = 3.14159265358979323846;
+		for (unsigned int i = 0; i < length; i++){
+			double t = i - centre;
+			double x = 2*pi*cutoff*t;
+			double sinc = (t == 0) ? 1.0 : sin(x)/x;
+			double r = t/centre;
+			double window = BesselI0(KAISER_BETA*sqrt(max(0.0, 1 - r*r)))/BesselI0(KAISER_BETA);
+			prototype[i] = sinc*window;
+			sum += prototype[i];
+		}
+		//Unity gain at DC once the upsampling has spread the input over Up samples
+		double gain = Up/sum;
+		//Phase p holds prototype[p + t*Up] for t = 0..Taps-1, reversed so that the last tap meets the oldest sample
+		Phases.resize(length);
+		for (unsigned int p = 0; p < Up; p++){
+			for (unsigned int t = 0; t < Taps; t++){
+				Phases[p*Taps + Taps-1-t] = prototype[p + t*Up]*gain;
+			}
+		}
+	}
+
+	//Produce()
+	unsigned int WaveResampler::Produce(unsigned long long limit, vector<double> &out){
+		//Output m uses the inputs up to (m*Down + Delay)/Up
+		unsigned long long delay = (unsigned long long)Taps*Up/2;
+		long long available = Origin + Filled;
+		unsigned long long end = 0;
+		if (available > 0 && (unsigned long long)available*Up > delay){
+			end = ((unsigned long long)available*Up - delay + Down - 1)/Down;
+		}
+		if (end > limit){
+			end = limit;
+		}
+		unsigned int count = end > Next ? unsigned(end - Next) : 0;
+		out.resize(count*Channels);
+
+		for (unsigned int i = 0; i < count; i++, Next++){
+			unsigned long long position = Next*Down + delay;
+			unsigned int phase = unsigned(position % Up);
+			long long last = (long long)(position / Up);
+			const double *taps = &Phases[phase*Taps];
+			unsigned int start = unsigned(last - (Taps-1) - Origin);
+			double *block = &out[i*Channels];
+			unsigned int c = 0;
+			for (; c + 1 < Channels; c += 2){
+				MultiplyAccumulate(taps, &History[c*Capacity + start], &History[(c+1)*Capacity + start], Taps, block[c], block[c+1]);
+			}
+			if (c < Channels){
+				block[c] = MultiplyAccumulate(taps, &History[c*Capacity + start], Taps);
+			}
+		}
+
+		//Drop what the next output no longer needs
+		long long keep = (long long)((Next*Down + delay)/Up) - (Taps-1);
+		if (keep > Origin){
+			unsigned int drop = (unsigned int)min<long long>(keep - Origin, Filled);
+			for (unsigned int c = 0; c < Channels; c++){
+				double *history = &History[c*Capacity];
+				copy(history + drop, history + Filled, history);
+			}
+			Filled -= drop;
+			Origin += drop;
+		}
+		return count;
+	}
+
+	//Stream()
+	void WaveResampler::Stream(WaveFile &in, unsigned int sampleSize, WaveWriter *out, DFT::DFTShared<char>::Vector_T *bytes){
+		if (in.SampleRate() != InputRate){
+			throw Exception(EXCEPTION_DATA_INVALID, "Input sample rate does not match the converter.");
+		}
+		if (!in.NumChannels() || !in.SampleSize()){
+			throw Exception(EXCEPTION_DATA_INVALID, "Input has no channels or samples.");
+		}
+		Reset(in.NumChannels());
+		//Keep the full scale when the sample size changes
+		double scale = ldexp(1.0, int(sampleSize) - int(in.SampleSize()));
+		unsigned int sampleBytes = sampleSize/8;
+
+		vector<double> buffer(STREAM_BLOCKS*Channels), result;
+		vector<char> encoded;
+		bool done = false;
+		in.DataRewind();
+		while (!done){
+			unsigned int blocks = in.DataNextBlocks(&buffer[0], STREAM_BLOCKS);
+			unsigned int produced;
+			if (blocks){
+				produced = Push(&buffer[0], blocks, result);
+			}
+			else{
+				produced = Flush(result);
+				done = true;
+			}
+			if (!produced){
+				continue;
+			}
+			if (scale != 1.0){
+				for (unsigned int i = 0; i < produced*Channels; i++){
+					result[i] *= scale;
+				}
+			}
+			if (out){
+				out->Write(&result[0], produced);
+			}
+			else{
+				encoded.resize(produced*Channels*sampleBytes);
+				EncodeSamples(&result[0], produced*Channels, sampleBytes, &encoded[0]);
+				bytes->insert(bytes->end(), encoded.begin(), encoded.end());
+			}
+		}
+	}
+
+	/**
+		Public Methods
+	**/
+	//Constructor
+	WaveResampler::WaveResampler(unsigned int inputRate, unsigned int outputRate, unsigned int taps, double rolloff)
+		: InputRate(inputRate), OutputRate(outputRate), Up(0), Down(0), Taps(taps + taps % 2),
+		Channels(0), Capacity(0), Filled(0), Origin(0), Received(0), Next(0){
+		if (!inputRate || !outputRate){
+			throw Exception(EXCEPTION_DATA_INVALID, "Sample rates cannot be zero!");
+		}
+		if (!taps){
+			throw Exception(EXCEPTION_DATA_INVALID, "Filter must have at least one tap per phase!");
+		}
+		if (!(rolloff > 0 && rolloff <= 1)){
+			throw Exception(EXCEPTION_DATA_INVALID, "Rolloff must be within (0, 1]!");
+		}
+		unsigned int divisor = GreatestCommonDivisor(inputRate, outputRate);
+		Up = outputRate/divisor;
+		Down = inputRate/divisor;
+		if ((unsigned long long)Up*Taps > MAX_COEFFICIENTS){
+			throw Exception(EXCEPTION_UNSUPPORTED, "The ratio between the sample rates is too fine for a polyphase filter bank.");
+		}
+		Design(rolloff);
+	}
+
+	//Reset()
+	void WaveResampler::Reset(unsigned int channels){
+		if (!channels){
+			throw Exception(EXCEPTION_DATA_INVALID, "Number of channels cannot be zero!");
+		}
+		Channels = channels;
+		//Start with Taps-1 zeros before the first sample
+		Capacity = Taps + STREAM_BLOCKS;
+		History.assign(Channels*Capacity, 0);
+		Filled = Taps - 1;
+		Origin = -(long long)(Taps - 1);
+		Received = 0;
+		Next = 0;
+	}
+
+	//Append()
+	void WaveResampler::Append(const double *in, unsigned int blocks){
+		if (!Channels){
+			throw Exception(EXCEPTION_INITIALISATION, "Resampler has not been reset with a number of channels.");
+		}
+		if (Filled + blocks > Capacity){
+			unsigned int capacity = max(Filled + blocks, 2*Capacity);
+			vector<double> history(Channels*capacity);
+			for (unsigned int c = 0; c < Channels; c++){
+				copy(History.begin() + c*Capacity, History.begin() + c*Capacity + Filled, history.begin() + c*capacity);
+			}
+			History.swap(history);
+			Capacity = capacity;
+		}
+		//De-interleave
+		for (unsigned int c = 0; c < Channels; c++){
+			double *history = &History[c*Capacity + Filled];
+			for (unsigned int i = 0; i < blocks; i++){
+				history[i] = in ? in[i*Channels + c] : 0.0;
+			}
+		}
+		Filled += blocks;
+	}
+
+	//Push()
+	unsigned int WaveResampler::Push(const double *in, unsigned int blocks, vector<double> &out){
+		Append(in, blocks);
+		Received += blocks;
+		return Produce(~0ULL, out);
+	}
+
+	//Flush()
+	unsigned int WaveResampler::Flush(vector<double> &out){
+		//The last outputs reach at most Taps/2 samples past the end of the input: pad with zeros
+		Append(NULL, Taps);
+		return Produce(OutputBlocks(Received), out);
+	}
+
+	//Process()
+	void WaveResampler::Process(WaveFile &in, WaveWriter &out){
+		if (!out.IsOpen() || out.NumChannels() != in.NumChannels() || out.GetSampleRate() != OutputRate){
+			throw Exception(EXCEPTION_DATA_INVALID, "Output must be open with the same number of channels and the output sample rate.");
+		}
+		Stream(in, out.GetSampleSize(), &out, NULL);
+	}
+	void WaveResampler::Process(WaveFile &in, const char *file, unsigned int sampleSize){
+		WaveWriter writer(file, in.NumChannels(), OutputRate, sampleSize ? sampleSize : in.SampleSize());
+		Stream(in, writer.GetSampleSize(), &writer, NULL);
+		writer.Close();
+	}
+	WaveFile WaveResampler::Process(WaveFile &in){
+		//Encoded straight into the buffer the new object shares
+		DFT::DFTShared<char> data;
+		data.Edit().reserve(size_t(OutputBlocks(in.NumBlocks())*in.BlockSize()));
+		Stream(in, in.SampleSize(), NULL, &data.Edit());
+		return WaveFile::CreateObject(in.NumChannels(), OutputRate, in.SampleSize(), data);
+	}
+}
@@ -0,0 +1,102 @@
+/*
+	WaveResampler
+
+	Rational sample rate conversion with a polyphase FIR filter.
+
+	The conversion ratio is reduced to L/M (output rate/input rate divided by their greatest common divisor).
+	Conceptually the input is upsampled by L with zeros, low pass filtered and decimated by M. The polyphase form
+	only evaluates the filter taps that land on real input samples at the output instants: the prototype filter of
+	Taps*L coefficients is split into L phases of Taps coefficients each, computed once at construction, and every
+	output sample is a single dot product of one phase with the last Taps input samples.
+	cf https://ccrma.stanford.edu/~jos/resample/
+
+	The prototype is a Kaiser windowed sinc with its cutoff at rolloff times the lower of the two Nyquist frequencies.
+	More taps give a sharper transition band at a proportional cost.
+
+	Input is pushed in blocks of interleaved samples, which is what WaveFile::DataNextBlocks() produces, so a file can
+	be converted without loading it into memory. Samples are kept channel major internally so that the dot products
+	run over contiguous memory; channels are filtered in pairs that share the coefficient loads, with SSE2 multiply
+	accumulates when available.
+
+	The output is aligned with the input: the filter delay is compensated and the output holds ceil(N*L/M) blocks
+	for N input blocks.
+
+	In the case of errors, throws exceptions
+*/
+#pragma once
+#ifndef WaveResampler_H
+#define WaveResampler_H
+
+#include <vector>
+using namespace std;
+#include "WaveMisc.h"
+#include "WaveFile.h"
+#include "WaveWriter.h"
+
+namespace Wave{
+	class WaveResampler{
+		unsigned int InputRate;			//Input blocks per second
+		unsigned int OutputRate;		//Output blocks per second
+		unsigned int Up;				//L
+		unsigned int Down;				//M
+		unsigned int Taps;				//Coefficients per phase
+		vector<double> Phases;			//Up phases of Taps coefficients, each stored in reverse to line up with the history
+
+		unsigned int Channels;			//Number of channels
+		vector<double> History;			//Input samples still needed. Channel major, Capacity per channel
+		unsigned int Capacity;			//Samples per channel History can hold
+		unsigned int Filled;			//Samples per channel History holds
+		long long Origin;				//Input index of the first sample in History. Negative for the zero padding at the start
+		unsigned long long Received;	//Input blocks pushed
+		unsigned long long Next;		//Index of the next output block
+
+		//Not copyable
+		WaveResampler(const WaveResampler &);
+		WaveResampler &operator=(const WaveResampler &);
+
+	protected:
+		void Design(double rolloff);	//Build the polyphase filter bank
+		void Append(const double *in, unsigned int blocks);		//De-interleave blocks into History, growing it as needed. Zeros if in is NULL
+		//Compute the output blocks whose inputs are all in History, up to limit blocks in total, and store them interleaved in out.
+		//Then drop the input samples no later output needs. Returns the number of blocks produced.
+		unsigned int Produce(unsigned long long limit, vector<double> &out);
+		//Convert the whole of in to sampleSize bits and send the encoded blocks to out if not NULL, otherwise append them to bytes
+		void Stream(WaveFile &in, unsigned int sampleSize, WaveWriter *out, DFT::DFTShared<char>::Vector_T *bytes);
+
+	public:
+		/*************************
+		**	    Constructor		**
+		**************************/
+		//taps is the number of coefficients per phase and is rounded up to an even number.
+		//rolloff places the cutoff as a fraction of the lower Nyquist frequency and must be in (0, 1].
+		WaveResampler(unsigned int inputRate, unsigned int outputRate, unsigned int taps=32, double rolloff=0.95);
+
+		//Start a new stream of channels. Called by Process() too.
+		void Reset(unsigned int channels);
+
+		//Push blocks of interleaved input. The converted blocks available so far replace the content of out, interleaved.
+		//Returns the number of output blocks.
+		unsigned int Push(const double *in, unsigned int blocks, vector<double> &out);
+		//End of input. The remaining output blocks replace the content of out. Returns their number.
+		unsigned int Flush(vector<double> &out);
+
+		//Stream the whole of in through the converter into out, which must be open with the same number of channels
+		//and the output rate. Samples are rescaled when the sample sizes differ. out is left open.
+		void Process(WaveFile &in, WaveWriter &out);
+		//As above into a new file. A sampleSize of zero keeps the sample size of in.
+		void Process(WaveFile &in, const char *file, unsigned int sampleSize=0);
+		//As above into a new WaveFile object held in memory. BEWARE OF MEMORY CONSTRAINTS.
+		WaveFile Process(WaveFile &in);
+
+		//Getters
+		unsigned int GetInputRate() const{ return InputRate; }
+		unsigned int GetOutputRate() const{ return OutputRate; }
+		unsigned int GetUp() const{ return Up; }
+		unsigned int GetDown() const{ return Down; }
+		unsigned int NumTaps() const{ return Taps; }
+		unsigned int NumChannels() const{ return Channels; }
+		//Number of output blocks a stream of n input blocks converts to
+		unsigned long long OutputBlocks(unsigned long long n) const{ return (n*Up + Down - 1)/Down; }
+	};
+}
+#endif /* WaveResampler_H */
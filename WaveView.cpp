@@ -0,0 +1,218 @@
+//WaveView.cpp
+#include <algorithm>
+#include "WaveView.h"
+#include "WaveMisc.h"
+#include "Exception.h"
+
+using namespace std;
+namespace Wave{
+	namespace{
+		const unsigned int RUN = 256;		//Samples decoded at a time for float
+
+		//Decode count samples stride bytes apart. stride is sampleBytes for a single channel.
+		void DecodeInto(const char *data, unsigned int count, unsigned int sampleBytes, unsigned int stride, double *out){
+			if (stride == sampleBytes){
+				DecodeSamples(data, count, sampleBytes, out);
+			}
+			else{
+				DecodeSamples(data, count, sampleBytes, stride, out);
+			}
+		}
+		template <typename T> void DecodeInto(const char *data, unsigned int count, unsigned int sampleBytes, unsigned int stride, T *out){
+			double buffer[RUN];
+			for (unsigned int done = 0; done < count; done += RUN){
+				unsigned int n = min(count - done, RUN);
+				DecodeInto(data + size_t(done)*stride, n, sampleBytes, stride, buffer);
+				for (unsigned int i = 0; i < n; i++){
+					out[done + i] = T(buffer[i]);
+				}
+			}
+		}
+
+		//Readers for Walk()
+		template <typename T> struct RangeRead{
+			complex<double> *Out;
+			void operator()(const T *values, unsigned int offset, unsigned int n){
+				for (unsigned int i = 0; i < n; i++){
+					Out[offset + i] = complex<double>(double(values[i]), 0);
+				}
+			}
+		};
+		template <typename T, typename U> struct SplitRead{
+			U *Real;
+			U *Imag;
+			void operator()(const T *values, unsigned int offset, unsigned int n){
+				for (unsigned int i = 0; i < n; i++){
+					Real[offset + i] = U(values[i]);
+				}
+				if (Imag){
+					fill(Imag + offset, Imag + offset + n, U(0));
+				}
+			}
+		};
+	}
+
+	//Constructor
+	template <typename T> WaveView<T>::WaveView(WaveFile &wave, unsigned int tiles)
+		: Channels(wave.NumChannels()), SampleBytes(wave.SampleSize()/8), BlockSize(wave.BlockSize()), Blocks(wave.NumBlocks()),
+		Interval(wave.Interval()), Pcm(NULL), Last(0), Reads(0), Decoded(0), Capacity(tiles ? tiles : 1){
+		if (!Channels || !SampleBytes || SampleBytes > MAX_SAMPLE_SIZE/8 || BlockSize < Channels*SampleBytes){
+			throw Exception(EXCEPTION_DATA_INVALID, "Wave file has no samples to view.");
+		}
+		unsigned long long size = 0;
+		if (!wave.DataIsLoaded() && !wave.GetPath().empty() && Mapping.Open(wave.GetPath().c_str())){
+			unsigned long long offset = wave.DataOffset();
+			size = Mapping.GetSize() > offset ? min(Mapping.GetSize() - offset, (unsigned long long) wave.DataChunkSize()) : 0;
+			Pcm = size ? Mapping.Data() + offset : NULL;
+		}
+		else{
+			if (!wave.DataIsLoaded()){
+				wave.DataLoad();
+			}
+			Loaded = wave.DataShared();
+			size = Loaded.Size();
+			Pcm = Loaded.Get();
+		}
+		//A short data chunk has fewer blocks than its header says
+		Blocks = unsigned(min((unsigned long long) Blocks, size/BlockSize));
+		Tiles.reserve(Capacity);
+	}
+
+	//Check()
+	template <typename T> void WaveView<T>::Check(unsigned int dimension, unsigned int first, unsigned int count) const{
+		if (dimension >= Channels || first > Blocks || count > Blocks - first){
+			throw Exception(EXCEPTION_RANGE, "Out of range access.");
+		}
+	}
+
+	//Decode()
+	template <typename T> void WaveView<T>::Decode(unsigned int tile, Values_T &values) const{
+		unsigned int first = tile*TILE, n = min(unsigned(TILE), Blocks - first);
+		values.resize(size_t(TILE)*Channels);
+		const char *data = Pcm + size_t(first)*BlockSize;
+		for (unsigned int j = 0; j < Channels; j++){
+			DecodeInto(data + j*SampleBytes, n, SampleBytes, BlockSize, &values[size_t(j)*TILE]);
+		}
+	}
+
+	//Fetch()
+	template <typename T> DFT::DFTShared<T> WaveView<T>::Fetch(unsigned int tile) const{
+		{
+			lock_guard<mutex> lock(Lock);
+			Reads++;
+			if (Last < Tiles.size() && Tiles[Last].Index == tile){
+				Tiles[Last].Used = Reads;
+				return Tiles[Last].Values;
+			}
+			for (unsigned int i = 0; i < Tiles.size(); i++){
+				if (Tiles[i].Index == tile){
+					Last = i;
+					Tiles[i].Used = Reads;
+					return Tiles[i].Values;
+				}
+			}
+		}
+		//Decode without the lock, so that readers of other tiles carry on
+		DFT::DFTShared<T> values;
+		Decode(tile, values.Edit());
+		lock_guard<mutex> lock(Lock);
+		Decoded++;
+		//Few tiles are kept, so a scan finds the tile, if another reader kept it meanwhile, or else the least recently used
+		unsigned int victim = 0;
+		for (unsigned int i = 0; i < Tiles.size(); i++){
+			if (Tiles[i].Index == tile){
+				Last = i;
+				Tiles[i].Used = Reads;
+				return Tiles[i].Values;
+			}
+			if (Tiles[i].Used < Tiles[victim].Used){
+				victim = i;
+			}
+		}
+		if (Tiles.size() < Capacity){
+			Tiles.push_back(Tile_T());
+			victim = unsigned(Tiles.size() - 1);
+		}
+		//Readers of the tile dropped keep their reference to its values
+		Tile_T &slot = Tiles[victim];
+		slot.Index = tile;
+		slot.Used = Reads;
+		slot.Values = values;
+		Last = victim;
+		return values;
+	}
+
+	//Walk()
+	template <typename T> template <typename Read> void WaveView<T>::Walk(unsigned int dimension, unsigned int first, unsigned int count, Read &read) const{
+		Check(dimension, first, count);
+		for (unsigned int done = 0; done < count; ){
+			unsigned int interval = first + done, tile = interval/TILE, offset = interval%TILE;
+			unsigned int n = min(count - done, unsigned(TILE) - offset);
+			DFT::DFTShared<T> values = Fetch(tile);
+			read(values.Get() + size_t(dimension)*TILE + offset, done, n);
+			done += n;
+		}
+	}
+
+	//DFTGet()
+	template <typename T> complex<double> WaveView<T>::DFTGet(unsigned int intervalN, unsigned int dimension) const{
+		Check(dimension, intervalN, 1);
+		return complex<double>(double(Fetch(intervalN/TILE)[size_t(dimension)*TILE + intervalN%TILE]), 0);
+	}
+
+	//DFTSet()
+	template <typename T> void WaveView<T>::DFTSet(unsigned int, unsigned int, const complex<double> &){
+		throw Exception(EXCEPTION_UNSUPPORTED, "The view is read only.");
+	}
+
+	//DFTGetRange()
+	template <typename T> void WaveView<T>::DFTGetRange(unsigned int dimension, unsigned int first, unsigned int count, complex<double> *out) const{
+		RangeRead<T> read = { out };
+		Walk(dimension, first, count, read);
+	}
+
+	//DFTGetSplit()
+	template <typename T> void WaveView<T>::DFTGetSplit(unsigned int dimension, unsigned int first, unsigned int count, double *real, double *imag) const{
+		SplitRead<T, double> read = { real, imag };
+		Walk(dimension, first, count, read);
+	}
+
+	//DFTGetSplitFloat()
+	template <typename T> void WaveView<T>::DFTGetSplitFloat(unsigned int dimension, unsigned int first, unsigned int count, float *real, float *imag) const{
+		SplitRead<T, float> read = { real, imag };
+		Walk(dimension, first, count, read);
+	}
+
+	//SetCapacity()
+	template <typename T> void WaveView<T>::SetCapacity(unsigned int tiles){
+		lock_guard<mutex> lock(Lock);
+		Capacity = tiles ? tiles : 1;
+		while (Tiles.size() > Capacity){
+			unsigned int victim = 0;
+			for (unsigned int i = 1; i < Tiles.size(); i++){
+				if (Tiles[i].Used < Tiles[victim].Used){
+					victim = i;
+				}
+			}
+			Tiles.erase(Tiles.begin() + victim);
+		}
+		Last = 0;
+	}
+
+	//NumDecoded()
+	template <typename T> unsigned long long WaveView<T>::NumDecoded() const{
+		lock_guard<mutex> lock(Lock);
+		return Decoded;
+	}
+
+	//Trim()
+	template <typename T> void WaveView<T>::Trim(){
+		lock_guard<mutex> lock(Lock);
+		vector<Tile_T>().swap(Tiles);
+		Last = 0;
+	}
+
+	//Instantiations
+	template class WaveView<float>;
+	template class WaveView<double>;
+}
@@ -0,0 +1,105 @@
+/*
+	WaveView
+
+	A read only time domain view of the samples of a WaveFile. The view maps the PCM bytes of the file rather than
+	loading them, and decodes them a tile of TILE blocks at a time, to double or float, the first time a sample of the
+	tile is read. Decoded tiles are kept, up to a number set by SetCapacity(), and the least recently used one is
+	dropped to make room for another. Reading through a file decodes each tile once, in one pass per channel;
+	reading at random costs one tile decode per tile missed, rather than a call to the decoder per sample as
+	WaveFile::DFTGet() makes.
+	Nothing in the tool makes one, as its transforms read whole channels through the bulk getters; it is for callers
+	that read single samples at random, e.g. a transform of their own given the view as its time domain.
+	Use WaveView<> (double) or WaveViewFloat.
+
+	If the file was opened from a path and is not loaded, the view maps it read only and tiles decode from the
+	mapping, so the samples are never loaded as a whole; the file on disk must not be written while the view is
+	open. Otherwise the view shares the loaded bytes and is a snapshot: edits of the file after the view was made are
+	not seen, since its samples are then copied on write. Values are the integer sample values, as read from the
+	WaveFile. Setting values throws EXCEPTION_UNSUPPORTED.
+	Threads may share a view. The lock is held only to find a tile or to keep one decoded: values are read from a
+	reference to the tile rather than under the lock, and a tile missed is decoded without it, so readers do not wait
+	on each other's decodes. Two readers missing the same tile may both decode it; one copy is kept.
+*/
+#pragma once
+#ifndef WaveView_H
+#define WaveView_H
+
+#include <vector>
+#include <complex>
+#include <mutex>
+#include "DFTData.h"
+#include "DFTPool.h"
+#include "DFTShared.h"
+#include "WaveFile.h"
+#include "WaveMapping.h"
+
+namespace Wave{
+	template <typename T=double> class WaveView: public DFT::DFTTime{
+	public:
+		enum { TILE = 4096, TILES = 64 };			//Blocks per tile, tiles kept by default
+
+	private:
+		typedef typename DFT::DFTShared<T>::Vector_T Values_T;
+		struct Tile_T{
+			unsigned int Index;					//Number of the tile, TILE blocks each
+			unsigned long long Used;			//Read that last used the tile
+			DFT::DFTShared<T> Values;			//Channel after channel, TILE values each. Readers hold a reference
+		};
+
+		MappedFile Mapping;						//The file, unless it was loaded or not opened from a path
+		DFT::DFTShared<char> Loaded;			//Shared with the file otherwise
+		const char *Pcm;						//First byte of data, in one or the other
+		unsigned int Channels;
+		unsigned int SampleBytes;				//Bytes per sample
+		unsigned int BlockSize;					//Bytes per block
+		unsigned int Blocks;
+		double Interval;
+
+		mutable std::mutex Lock;				//Guards what follows
+		mutable std::vector<Tile_T> Tiles;		//Decoded tiles, at most Capacity
+		mutable unsigned int Last;				//Tile last read, checked first
+		mutable unsigned long long Reads;		//Reads so far, for the LRU order
+		mutable unsigned long long Decoded;		//Tiles decoded so far
+		unsigned int Capacity;
+
+		//Not copyable
+		WaveView(const WaveView &);
+		WaveView &operator=(const WaveView &);
+
+	protected:
+		void Check(unsigned int dimension, unsigned int first, unsigned int count) const;
+		//The decoded values of a tile, decoded first if it is not kept. Takes the lock only to find or keep it.
+		DFT::DFTShared<T> Fetch(unsigned int tile) const;
+		void Decode(unsigned int tile, Values_T &values) const;		//Decode a tile into values
+		//Call read(values, offset, n) over the tiles holding count values of dimension from first
+		template <typename Read> void Walk(unsigned int dimension, unsigned int first, unsigned int count, Read &read) const;
+
+	public:
+		//Maps the file if it is not loaded and was opened from a path. tiles is the number of tiles kept.
+		explicit WaveView(WaveFile &wave, unsigned int tiles=TILES);
+
+		//Properties Getter
+		unsigned int DFTDimension() const{ return Channels; }
+		unsigned int DFTSample() const{ return Blocks*Channels; }
+		unsigned int DFTNumInterval() const{ return Blocks; }
+		double DFTInterval() const{ return Interval; }
+		bool DFTIsReal() const{ return true; }
+
+		//Samples getter. The setter throws.
+		std::complex<double> DFTGet(unsigned int intervalN, unsigned int dimension) const;
+		void DFTSet(unsigned int intervalN, unsigned int dimension, const std::complex<double> &data);
+
+		//Bulk access
+		void DFTGetRange(unsigned int dimension, unsigned int first, unsigned int count, std::complex<double> *out) const;
+		void DFTGetSplit(unsigned int dimension, unsigned int first, unsigned int count, double *real, double *imag) const;
+		void DFTGetSplitFloat(unsigned int dimension, unsigned int first, unsigned int count, float *real, float *imag) const;
+
+		//Tiles kept. Lowering it drops the least recently used tiles. At least one is kept.
+		void SetCapacity(unsigned int tiles);
+		unsigned int GetCapacity() const{ return Capacity; }
+		unsigned long long NumDecoded() const;			//Tiles decoded so far
+		void Trim();									//Drop every tile decoded
+	};
+	typedef WaveView<float> WaveViewFloat;
+}
+#endif /* WaveView_H */
@@ -0,0 +1,122 @@
+#include "WaveWriter.h"
+#include "Exception.h"
+
+namespace Wave{
+	/**
+		Protected Methods
+	**/
+	//WriteHeader()
+	//Same layout as WaveFile::WriteFile()
+	void WaveWriter::WriteHeader(){
+		File.clear();
+		File.seekp(0, ios_base::beg);
+
+		//RIFF
+		File.write("RIFF", 4);
+		Word ChunkSize = GetBytesFromUnsigned(DataSize + DataSize % 2 + 36);		//Includes the pad byte
+		ChunkSize.PadBytes();
+		File.write(ChunkSize.GetPointer(), WORD_SIZE);
+		File.write("WAVE", 4);
+
+		//fmt
+		File.write("fmt ", 4);
+		ChunkSize = GetBytesFromUnsigned(16U);
+		ChunkSize.PadBytes();
+		File.write(ChunkSize.GetPointer(), WORD_SIZE);
+
+		File.put(0x01);			//PCM
+		File.put(0x0);
+
+		Word channels = GetBytesFromUnsigned(Channels);
+		File.write(channels.GetPointer(), 2);
+
+		Word sampleRate = GetBytesFromUnsigned(SampleRate);
+		sampleRate.PadBytes();
+		File.write(sampleRate.GetPointer(), WORD_SIZE);
+
+		//ByteRate         == SampleRate * NumChannels * BitsPerSample/8
+		Word byteRate = GetBytesFromUnsigned(SampleRate * Channels * SampleSize/8);
+		byteRate.PadBytes();
+		File.write(byteRate.GetPointer(), WORD_SIZE);
+
+		//BlockAlign       == NumChannels * BitsPerSample/8
+		Word blockAlign = GetBytesFromUnsigned(Channels * SampleSize/8);
+		File.write(blockAlign.GetPointer(), 2);
+
+		Word bits = GetBytesFromUnsigned(SampleSize);
+		File.write(bits.GetPointer(), 2);
+
+		//data
+		File.write("data", WORD_SIZE);
+		ChunkSize = GetBytesFromUnsigned(DataSize);
+		ChunkSize.PadBytes();
+		File.write(ChunkSize.GetPointer(), WORD_SIZE);
+	}
+
+	/**
+		Public Methods
+	**/
+	//Destructor
+	WaveWriter::~WaveWriter(){
+		try{
+			Close();
+		}
+		catch(...){
+			//Nothing sensible to do in a destructor
+		}
+	}
+
+	//Open()
+	void WaveWriter::Open(const char *file, unsigned int channels, unsigned int sampleRate, unsigned int sampleSize){
+		if (!channels || !sampleRate){
+			throw Exception(EXCEPTION_DATA_INVALID, "Channels and/or sample rate cannot be zero!");
+		}
+		if (!sampleSize || sampleSize % 8 != 0 || sampleSize > MAX_SAMPLE_SIZE){
+			throw Exception(EXCEPTION_DATA_INVALID, "Sample size must be a multiple of 8 bits, up to 32 bits.", WAVE_BITRATE_HIGH);
+		}
+		Close();
+		File.open(file, ios_base::binary | ios_base::out | ios_base::trunc);
+		if (File.fail()){
+			throw Exception(EXCEPTION_FILE_CANNOT_OPEN_OUTPUT, "Unable to open Wav File for writing.");
+		}
+		Channels = channels;
+		SampleRate = sampleRate;
+		SampleSize = (unsigned short) sampleSize;
+		DataSize = 0;
+		WriteHeader();
+	}
+
+	//Write()
+	void WaveWriter::Write(const double *data, unsigned int blocks){
+		if (!File.is_open()){
+			throw Exception(EXCEPTION_FILE_NOT_OPEN, "File is not open for writing.");
+		}
+		if (!blocks){
+			return;
+		}
+		unsigned int count = blocks*Channels;
+		unsigned int bytes = count*SampleSize/8;
+		if (Buffer.size() < bytes){
+			Buffer.resize(bytes);
+		}
+		EncodeSamples(data, count, SampleSize/8, &Buffer[0]);
+		File.write(&Buffer[0], bytes);
+		if (File.fail()){
+			throw Exception(EXCEPTION_FILE_CANNOT_OPEN_OUTPUT, "Unable to write to Wav File.");
+		}
+		DataSize += bytes;
+	}
+
+	//Close()
+	void WaveWriter::Close(){
+		if (!File.is_open()){
+			return;
+		}
+		//RIFF chunks are word aligned
+		if (DataSize % 2){
+			File.put(0x0);
+		}
+		WriteHeader();
+		File.close();
+	}
+}
@@ -0,0 +1,68 @@
+/*
+	WaveWriter
+
+	Writes a PCM Wave file incrementally. Unlike WaveFile::WriteFile(), the data does not have to be in memory:
+	samples are encoded and appended to the file as they are produced.
+
+	The header is written with a zero data size when the file is opened and is patched with the real sizes
+	when the writer is closed. The file is only a valid Wave file after Close() (or destruction).
+
+	In the case of errors, throws exceptions
+*/
+#pragma once
+#ifndef WaveWriter_H
+#define WaveWriter_H
+
+#include <fstream>
+#include <vector>
+using namespace std;
+#include "WaveMisc.h"
+#include "WaveWord.h"
+
+namespace Wave{
+	class WaveWriter{
+		fstream File;					//Output file
+		unsigned int Channels;			//Number of channels
+		unsigned int SampleRate;		//Blocks per second
+		unsigned short SampleSize;		//Bits per sample
+		unsigned int DataSize;			//Bytes of sample data written so far
+		vector<char> Buffer;			//Encoding buffer
+
+		//Not copyable
+		WaveWriter(const WaveWriter &);
+		WaveWriter &operator=(const WaveWriter &);
+
+	protected:
+		void WriteHeader();				//Write the RIFF, fmt and data headers at the start of the file for the current DataSize
+
+	public:
+		/*************************
+		**	    Constructor		**
+		**************************/
+		WaveWriter(): Channels(0), SampleRate(0), SampleSize(0), DataSize(0){}
+		WaveWriter(const char *file, unsigned int channels, unsigned int sampleRate, unsigned int sampleSize)
+			: Channels(0), SampleRate(0), SampleSize(0), DataSize(0){
+			Open(file, channels, sampleRate, sampleSize);
+		}
+		//Destructor. Closes the file if still open. Exceptions are swallowed.
+		~WaveWriter();
+
+		//Create the file and write a provisional header. SAMPLE SIZE IS IN BITS and must be a multiple of 8.
+		void Open(const char *file, unsigned int channels, unsigned int sampleRate, unsigned int sampleSize);
+		bool IsOpen() const{ return File.is_open(); }
+
+		//Append blocks of samples. data holds blocks*NumChannels() values interleaved by channel.
+		//Values are rounded and clipped to the sample size.
+		void Write(const double *data, unsigned int blocks);
+
+		//Patch the header and close the file
+		void Close();
+
+		//Getters
+		unsigned int NumChannels() const{ return Channels; }
+		unsigned int GetSampleRate() const{ return SampleRate; }
+		unsigned short GetSampleSize() const{ return SampleSize; }
+		unsigned int NumBlocks() const{ return (Channels && SampleSize) ? DataSize/(Channels*SampleSize/8) : 0; }		//Blocks written so far
+	};
+}
+#endif /* WaveWriter_H */